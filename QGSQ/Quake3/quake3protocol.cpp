@@ -0,0 +1,149 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "quake3protocol.h"
+#include "querymetrics.h"
+#include <QJsonArray>
+
+using namespace QGSQ::Quake3;
+
+QString Quake3Protocol::name() const
+{
+    return QStringLiteral("Quake 3");
+}
+
+quint16 Quake3Protocol::defaultPort() const
+{
+    return 27960;
+}
+
+QByteArray Quake3Protocol::buildRequest(int type, const QByteArray &challenge) const
+{
+    QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff");
+    request += (type == GetInfo) ? QByteArrayLiteral("getinfo") : QByteArrayLiteral("getstatus");
+    if (!challenge.isEmpty()) {
+        request += ' ';
+        request += challenge;
+    }
+    return request;
+}
+
+QGSQ::QueryProtocol::Packet Quake3Protocol::unpack(const QByteArray &datagram, QByteArray *payload) const
+{
+    if (Q_UNLIKELY(!datagram.startsWith(QByteArrayLiteral("\xff\xff\xff\xff")))) {
+        return InvalidPacket;
+    }
+
+    *payload = datagram.mid(4);
+    return SinglePacket;
+}
+
+QGSQ::QueryProtocol::Reply Quake3Protocol::matchReply(int type, const QByteArray &payload, QByteArray *challenge) const
+{
+    Q_UNUSED(challenge);
+
+    // the command is terminated by a line feed, some servers omit it for empty replies
+    const int end = payload.indexOf('\n');
+    const QByteArray command = (end < 0) ? payload : payload.left(end);
+
+    switch (type) {
+    case GetStatus:
+        return (command == "statusResponse") ? ExpectedReply : UnexpectedReply;
+    case GetInfo:
+        return (command == "infoResponse") ? ExpectedReply : UnexpectedReply;
+    default:
+        return UnexpectedReply;
+    }
+}
+
+QJsonObject Quake3Protocol::parse(int type, const QByteArray &payload) const
+{
+    const QList<QByteArray> lines = payload.split('\n');
+    if (Q_UNLIKELY(lines.size() < 2)) {
+        return QJsonObject();
+    }
+
+    if (type == GetInfo) {
+        return parseInfoString(lines.at(1));
+    }
+
+    if (type != GetStatus) {
+        return QJsonObject();
+    }
+
+    // every player line is: score ping "name"
+    QJsonArray players;
+    for (int i = 2; i < lines.size(); ++i) {
+        const QByteArray &line = lines.at(i);
+        const int firstSpace = line.indexOf(' ');
+        const int secondSpace = (firstSpace < 0) ? -1 : line.indexOf(' ', firstSpace + 1);
+        if (secondSpace < 0) {
+            continue;
+        }
+
+        QByteArray name = line.mid(secondSpace + 1);
+        if ((name.size() > 1) && name.startsWith('"') && name.endsWith('"')) {
+            name = name.mid(1, name.size() - 2);
+        }
+
+        QJsonObject player;
+        player.insert(QStringLiteral("name"), QString::fromUtf8(name));
+        player.insert(QStringLiteral("score"), line.left(firstSpace).toInt());
+        player.insert(QStringLiteral("ping"), line.mid(firstSpace + 1, secondSpace - firstSpace - 1).toInt());
+        players.append(player);
+    }
+
+    QJsonObject o;
+    o.insert(QStringLiteral("rules"), parseInfoString(lines.at(1)));
+    o.insert(QStringLiteral("players"), players);
+    return o;
+}
+
+int Quake3Protocol::latencyType(int type) const
+{
+    switch (type) {
+    case GetInfo:
+        return QueryMetrics::Info;
+    case GetStatus:
+        return QueryMetrics::Players;
+    default:
+        return -1;
+    }
+}
+
+QJsonObject Quake3Protocol::parseInfoString(const QByteArray &info)
+{
+    QJsonObject o;
+
+    const QList<QByteArray> parts = info.split('\\');
+    // the string starts with a backslash, so the first part is empty
+    for (int i = 1; (i + 1) < parts.size(); i += 2) {
+        if (!parts.at(i).isEmpty()) {
+            o.insert(QString::fromUtf8(parts.at(i)), QString::fromUtf8(parts.at(i + 1)));
+        }
+    }
+
+    return o;
+}
+
+const Quake3Protocol *Quake3Protocol::instance()
+{
+    static const Quake3Protocol protocol;
+    return &protocol;
+}
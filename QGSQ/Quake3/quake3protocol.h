@@ -0,0 +1,62 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_QUAKE3_QUAKE3PROTOCOL_H
+#define QGSQ_QUAKE3_QUAKE3PROTOCOL_H
+
+#include "qgsq_global.h"
+#include "queryprotocol.h"
+
+namespace QGSQ {
+namespace Quake3 {
+
+/*
+ * The Quake 3 out of band query protocol for QueryEngine, also spoken by
+ * most id Tech 3 based games. Replies always fit into a single datagram and
+ * no challenge is needed, an optional challenge is echoed by the server.
+ */
+class QGSQ_LIBRARY Quake3Protocol : public QGSQ::QueryProtocol
+{
+public:
+    enum Type : int {
+        GetStatus   = 1,
+        GetInfo     = 2
+    };
+
+    QString name() const override;
+    quint16 defaultPort() const override;
+    QByteArray buildRequest(int type, const QByteArray &challenge) const override;
+    Packet unpack(const QByteArray &datagram, QByteArray *payload) const override;
+    Reply matchReply(int type, const QByteArray &payload, QByteArray *challenge) const override;
+    QJsonObject parse(int type, const QByteArray &payload) const override;
+    int latencyType(int type) const override;
+
+    /*
+     * Parses an info string like \key\value\key\value into a JSON object,
+     * values are always strings.
+     */
+    static QJsonObject parseInfoString(const QByteArray &info);
+
+    static const Quake3Protocol *instance();
+};
+
+}
+}
+
+#endif // QGSQ_QUAKE3_QUAKE3PROTOCOL_H
@@ -0,0 +1,628 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_A2SLAYOUT_P_H
+#define QGSQ_VALVE_SOURCE_A2SLAYOUT_P_H
+
+#include "serverinfo_p.h"
+#include "player.h"
+#include "response.h"
+#include "stringpool.h"
+#include <QDebug>
+#include <QJsonObject>
+#include <QJsonArray>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Field tables of the A2S_INFO, A2S_PLAYER and A2S_RULES replies. Every
+ * layout lists its fields in wire order once, the parser, the JSON object
+ * builder, the encoders of the result writers and the debug printer are
+ * instantiated from the same table, so there are no per field branches to
+ * keep in sync. A field combines a key, a codec reading the wire value, the
+ * way the value is stored and read back, and a condition that decides if
+ * the field is part of the reply and of the output. The same tables drive
+ * the scanners of InfoFilter and PlayerTracker, which only keep the wire
+ * values of the keys they know.
+ */
+namespace A2S {
+
+/*
+ * Parser state. The lazy mask selects the string fields of ServerInfo that
+ * only get their location recorded, edf is the extra data flag of the
+ * Source info reply.
+ */
+struct Reader {
+    Reader(Response &_res, StringPool *_pool = nullptr, quint16 _lazy = 0) :
+        res(_res), pool(_pool), lazy(_lazy)
+    {}
+
+    Response &res;
+    StringPool *pool = nullptr;
+    quint16 lazy = 0;
+    quint8 edf = 0;
+};
+
+// string of a scanned reply, not null terminated
+struct Span {
+    const char *data = nullptr;
+    int size = 0;
+};
+
+/*
+ * Scanner state, with the error semantics of Response but working directly
+ * on the reply bytes. Strings are not decoded, they are returned as spans.
+ */
+class Scanner
+{
+public:
+    explicit Scanner(const QByteArray &data) : p(data.constData()), end(data.constData() + data.size()) {}
+
+    template<typename T> T get()
+    {
+        if (Q_UNLIKELY(error || ((end - p) < static_cast<int>(sizeof(T))))) {
+            error = true;
+            return 0;
+        }
+        const T value = qFromLittleEndian<T>(reinterpret_cast<const uchar *>(p));
+        p += sizeof(T);
+        return value;
+    }
+
+    char getCharacter() { return static_cast<char>(get<quint8>()); }
+
+    Span getSpan()
+    {
+        Span span;
+        const auto term = error ? nullptr : static_cast<const char *>(std::memchr(p, '\0', static_cast<size_t>(end - p)));
+        if (Q_UNLIKELY(!term)) {
+            error = true;
+            return span;
+        }
+        span.data = p;
+        span.size = static_cast<int>(term - p);
+        p = term + 1;
+        return span;
+    }
+
+    bool atEnd() const { return p >= end; }
+    bool hasError() const { return error; }
+
+    quint8 edf = 0;
+
+private:
+    const char *p = nullptr;
+    const char *end = nullptr;
+    bool error = false;
+};
+
+template<> inline float Scanner::get<float>()
+{
+    const quint32 bits = get<quint32>();
+    float ret;
+    std::memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+}
+
+// output keys, the array reference keeps the length known at compile time
+#define QGSQ_A2S_KEY(Tag, str) struct Tag { static decltype(str) key() { return str; } };
+QGSQ_A2S_KEY(AddressKey, "address")
+QGSQ_A2S_KEY(QueryPortKey, "queryPort")
+QGSQ_A2S_KEY(GoldSourceKey, "isGoldSource")
+QGSQ_A2S_KEY(ProtocolKey, "protocol")
+QGSQ_A2S_KEY(NameKey, "name")
+QGSQ_A2S_KEY(MapKey, "map")
+QGSQ_A2S_KEY(FolderKey, "folder")
+QGSQ_A2S_KEY(GameKey, "game")
+QGSQ_A2S_KEY(AppIdKey, "appId")
+QGSQ_A2S_KEY(PlayersKey, "players")
+QGSQ_A2S_KEY(MaxPlayersKey, "maxPlayers")
+QGSQ_A2S_KEY(BotsKey, "bots")
+QGSQ_A2S_KEY(ServerTypeKey, "serverType")
+QGSQ_A2S_KEY(EnvironmentKey, "environment")
+QGSQ_A2S_KEY(VisibilityKey, "visibility")
+QGSQ_A2S_KEY(VacKey, "vac")
+QGSQ_A2S_KEY(ModeKey, "mode")
+QGSQ_A2S_KEY(WitnessesKey, "witnesses")
+QGSQ_A2S_KEY(DurationKey, "duration")
+QGSQ_A2S_KEY(VersionKey, "version")
+QGSQ_A2S_KEY(GamePortKey, "gamePort")
+QGSQ_A2S_KEY(SteamIdKey, "steamId")
+QGSQ_A2S_KEY(SpecPortKey, "specPort")
+QGSQ_A2S_KEY(SpecNameKey, "specName")
+QGSQ_A2S_KEY(KeywordsKey, "keywords")
+QGSQ_A2S_KEY(GameIdKey, "gameId")
+QGSQ_A2S_KEY(StoreLinkKey, "storeLink")
+QGSQ_A2S_KEY(IsModKey, "isMod")
+QGSQ_A2S_KEY(ModLinkKey, "modLink")
+QGSQ_A2S_KEY(ModDownloadLinkKey, "modDownloadLink")
+QGSQ_A2S_KEY(ModVersionKey, "modVersion")
+QGSQ_A2S_KEY(ModSizeKey, "modSize")
+QGSQ_A2S_KEY(ModTypeKey, "modType")
+QGSQ_A2S_KEY(ModDllKey, "modDll")
+QGSQ_A2S_KEY(ScoreKey, "score")
+QGSQ_A2S_KEY(ValueKey, "value")
+#undef QGSQ_A2S_KEY
+
+inline const char *serverTypeString(ServerInfo::Type type)
+{
+    switch (type) {
+    case ServerInfo::Dedicated:
+        return "d";
+    case ServerInfo::NonDedicated:
+        return "l";
+    case ServerInfo::SourceTVRelay:
+        return "p";
+    default:
+        return nullptr;
+    }
+}
+
+inline const char *environmentString(ServerInfo::Environment env)
+{
+    switch (env) {
+    case ServerInfo::Linux:
+        return "l";
+    case ServerInfo::Windows:
+        return "w";
+    case ServerInfo::Mac:
+        return "m";
+    default:
+        return nullptr;
+    }
+}
+
+// unknown server types and environments are left out of the output
+template<typename T> inline bool present(const T &) { return true; }
+inline bool present(ServerInfo::Type type) { return serverTypeString(type); }
+inline bool present(ServerInfo::Environment env) { return environmentString(env); }
+
+/*
+ * Conditions. test() decides on parsing if the field is in the reply, it
+ * sees the fields read so far, shown() decides if the field is written.
+ */
+struct Always {
+    template<typename T, typename R> static bool test(const T *, const R &) { return true; }
+    template<typename O> static bool shown(const O *) { return true; }
+};
+
+// parsed but not part of the output
+struct Hidden {
+    template<typename T, typename R> static bool test(const T *, const R &) { return true; }
+    template<typename O> static bool shown(const O *) { return false; }
+};
+
+template<quint8 Bit> struct ExtraData {
+    template<typename T, typename R> static bool test(const T *, const R &r) { return r.edf & Bit; }
+    template<typename O> static bool shown(const O *) { return true; }
+};
+
+struct TheShip {
+    template<typename T, typename R> static bool test(const T *t, const R &) { return t->appId == 2400; }
+    static bool shown(const ServerInfo *si) { return si->appId() == 2400; }
+};
+
+struct Mod {
+    template<typename T, typename R> static bool test(const T *t, const R &) { return t->isMod; }
+    static bool shown(const ServerInfo *si) { return si->isMod(); }
+};
+
+/*
+ * Codecs. Arg is the type handed to the setter, Result the type returned
+ * by the getter, empty() the value used if the field is not in the reply,
+ * scan() returns the wire value for the scanners.
+ */
+template<typename Codec> struct Simple {
+    template<typename Set, typename T> static void assign(T *t, Reader &r) { Set::set(t, Codec::read(r)); }
+};
+
+template<typename T> struct Number : Simple<Number<T>> {
+    typedef T Arg;
+    typedef T Result;
+    static T read(Reader &r) { return r.res.get<T>(); }
+    static T scan(Scanner &s) { return s.get<T>(); }
+    static T empty() { return 0; }
+};
+
+struct Bool : Simple<Bool> {
+    typedef bool Arg;
+    typedef bool Result;
+    static bool read(Reader &r) { return r.res.get<quint8>() == 1; }
+    static bool scan(Scanner &s) { return s.get<quint8>() == 1; }
+    static bool empty() { return false; }
+};
+
+template<typename E, E On, E Off, E Empty = Off> struct Flag : Simple<Flag<E, On, Off, Empty>> {
+    typedef E Arg;
+    typedef E Result;
+    static E read(Reader &r) { return r.res.get<quint8>() ? On : Off; }
+    static quint8 scan(Scanner &s) { return s.get<quint8>(); }
+    static E empty() { return Empty; }
+};
+
+// single character codes, mapped by the setter
+template<typename E> struct Character : Simple<Character<E>> {
+    typedef char Arg;
+    typedef E Result;
+    static char read(Reader &r) { return r.res.getCharacter(); }
+    static char scan(Scanner &s) { return s.getCharacter(); }
+    static char empty() { return '\0'; }
+};
+
+struct ShipMode : Simple<ShipMode> {
+    typedef quint8 Arg;
+    typedef ServerInfo::TheShipMode Result;
+    static quint8 read(Reader &r) { return r.res.get<quint8>(); }
+    static quint8 scan(Scanner &s) { return s.get<quint8>(); }
+    static quint8 empty() { return ServerInfo::UnknownTheShipMode; }
+};
+
+struct String : Simple<String> {
+    typedef const QString &Arg;
+    typedef QString Result;
+    static QString read(Reader &r) { return r.res.getString(r.pool); }
+    static Span scan(Scanner &s) { return s.getSpan(); }
+    static QString empty() { return QString(); }
+};
+
+// strings of ServerInfo, recorded for lazy decoding if selected by the reader
+template<ServerInfoPrivate::LazyField F, bool Pooled = true, typename T = QString> struct LazyString {
+    typedef const T &Arg;
+    typedef T Result;
+    template<typename Set> static void assign(ServerInfoPrivate *d, Reader &r)
+    {
+        d->readString(r.res, F, Pooled ? r.pool : nullptr, (r.lazy & (1 << F)));
+    }
+    static Span scan(Scanner &s) { return s.getSpan(); }
+    static T empty() { return T(); }
+};
+
+// the GoldSource reply starts with ip:port, only the port is used
+struct AddressPort : Simple<AddressPort> {
+    typedef quint16 Arg;
+    typedef quint16 Result;
+    static quint16 read(Reader &r)
+    {
+        const char *str = nullptr;
+        int size = 0;
+        if (Q_UNLIKELY(!r.res.getRawString(&str, &size))) {
+            return 0;
+        }
+        const int sep = QByteArray::fromRawData(str, size).lastIndexOf(':');
+        return (sep > -1) ? QByteArray::fromRawData(str + sep + 1, size - sep - 1).toUShort() : 0;
+    }
+    static Span scan(Scanner &s) { return s.getSpan(); }
+    static quint16 empty() { return 0; }
+};
+
+/*
+ * Storage policies, set() stores a parsed value in the parse target, get()
+ * reads it back from the object that is written.
+ */
+template<typename Arg, void (ServerInfoPrivate::*S)(Arg)> struct Setter {
+    static void set(ServerInfoPrivate *d, Arg value) { (d->*S)(value); }
+};
+
+template<typename R, typename T, T R::*M> struct Assign {
+    static void set(R *record, const T &value) { record->*M = value; }
+};
+
+template<typename O, typename T, T (O::*G)() const> struct Getter {
+    static T get(const O *o) { return (o->*G)(); }
+};
+
+template<typename R, typename T, T R::*M> struct Read {
+    static const T &get(const R *record) { return record->*M; }
+};
+
+template<typename Key, typename Codec, typename Set, typename Get, typename When = Always>
+struct Field {
+    template<typename T> static bool read(T *t, Reader &r)
+    {
+        if (When::test(t, r)) {
+            Codec::template assign<Set>(t, r);
+        } else {
+            Set::set(t, Codec::empty());
+        }
+        return true;
+    }
+
+    template<typename T> static void reset(T *t) { Set::set(t, Codec::empty()); }
+
+    // the target picks the keys it keeps by overloading store()
+    template<typename T> static bool scan(T *t, Scanner &s)
+    {
+        if (When::test(t, s)) {
+            t->store(Key(), Codec::scan(s));
+        }
+        return true;
+    }
+
+    template<typename V, typename O> static void visit(V &v, const O *o)
+    {
+        if (When::shown(o)) {
+            v.field(Key::key(), Get::get(o));
+        }
+    }
+};
+
+template<typename Key, typename Codec,
+         void (ServerInfoPrivate::*Set)(typename Codec::Arg),
+         typename Codec::Result (ServerInfo::*Get)() const,
+         typename When = Always>
+struct InfoField : Field<Key, Codec, Setter<typename Codec::Arg, Set>, Getter<ServerInfo, typename Codec::Result, Get>, When> {};
+
+// values that are not in the reply but part of the output
+template<typename Key, typename Get> struct Output {
+    template<typename T> static bool read(T *, Reader &) { return true; }
+    template<typename T> static bool scan(T *, Scanner &) { return true; }
+    template<typename V, typename O> static void visit(V &v, const O *o) { v.field(Key::key(), Get::get(o)); }
+};
+
+// fields of the other layout, they are cleared when this one is parsed
+template<typename F> struct Unset {
+    template<typename T> static bool read(T *t, Reader &) { F::reset(t); return true; }
+    template<typename T> static bool scan(T *, Scanner &) { return true; }
+    template<typename V, typename O> static void visit(V &, const O *) {}
+};
+
+// skipped wire value
+template<typename T, typename When = Always> struct Padding {
+    template<typename R> static bool read(R *t, Reader &r)
+    {
+        if (When::test(t, r)) {
+            r.res.get<T>();
+        }
+        return true;
+    }
+    template<typename R> static bool scan(R *t, Scanner &s)
+    {
+        if (When::test(t, s)) {
+            s.get<T>();
+        }
+        return true;
+    }
+    template<typename V, typename O> static void visit(V &, const O *) {}
+};
+
+// the optional extra data flag, older servers end the reply without it
+struct ExtraDataFlag {
+    template<typename T> static bool read(T *, Reader &r) { r.edf = r.res.atEnd() ? 0 : r.res.get<quint8>(); return true; }
+    template<typename T> static bool scan(T *, Scanner &s) { s.edf = s.atEnd() ? 0 : s.get<quint8>(); return true; }
+    template<typename V, typename O> static void visit(V &, const O *) {}
+};
+
+// parsing stops at a checkpoint if the reply has been truncated before it
+struct Checkpoint {
+    template<typename T> static bool read(T *, Reader &r) { return !r.res.hasError(); }
+    template<typename T> static bool scan(T *, Scanner &s) { return !s.hasError(); }
+    template<typename V, typename O> static void visit(V &, const O *) {}
+};
+
+// scanning stops here unless the target asks for the rest of the reply
+struct OptionalPart {
+    template<typename T> static bool read(T *, Reader &) { return true; }
+    template<typename T> static bool scan(T *t, Scanner &s) { return !s.hasError() && t->scanOptional; }
+    template<typename V, typename O> static void visit(V &, const O *) {}
+};
+
+template<typename... Fields> struct Layout {
+    // returns false if a checkpoint failed, the fields after it are not touched
+    template<typename T> static bool read(T *t, Reader &r)
+    {
+        bool ok = true;
+        const bool steps[] = {true, (ok = ok && Fields::read(t, r))...};
+        Q_UNUSED(steps);
+        return ok;
+    }
+
+    // stops the same way, the caller checks the scanner for errors
+    template<typename T> static bool scan(T *t, Scanner &s)
+    {
+        bool ok = true;
+        const bool steps[] = {true, (ok = ok && Fields::scan(t, s))...};
+        Q_UNUSED(steps);
+        return ok;
+    }
+
+    template<typename V, typename O> static void visit(V &v, const O *o)
+    {
+        const int steps[] = {0, (Fields::visit(v, o), 0)...};
+        Q_UNUSED(steps);
+    }
+};
+
+typedef InfoField<ProtocolKey, Number<quint8>, &ServerInfoPrivate::setProtocol, &ServerInfo::protocol> ProtocolField;
+typedef InfoField<NameKey, LazyString<ServerInfoPrivate::LazyName, false>, &ServerInfoPrivate::setName, &ServerInfo::name> NameField;
+typedef InfoField<MapKey, LazyString<ServerInfoPrivate::LazyMap>, &ServerInfoPrivate::setMap, &ServerInfo::map> MapField;
+typedef InfoField<FolderKey, LazyString<ServerInfoPrivate::LazyFolder>, &ServerInfoPrivate::setFolder, &ServerInfo::folder> FolderField;
+typedef InfoField<GameKey, LazyString<ServerInfoPrivate::LazyGame>, &ServerInfoPrivate::setGame, &ServerInfo::game> GameField;
+typedef InfoField<AppIdKey, Number<quint16>, &ServerInfoPrivate::setAppId, &ServerInfo::appId> AppIdField;
+typedef InfoField<PlayersKey, Number<quint8>, &ServerInfoPrivate::setPlayers, &ServerInfo::players> PlayersField;
+typedef InfoField<MaxPlayersKey, Number<quint8>, &ServerInfoPrivate::setMaxPlayers, &ServerInfo::maxPlayers> MaxPlayersField;
+typedef InfoField<BotsKey, Number<quint8>, &ServerInfoPrivate::setBots, &ServerInfo::bots> BotsField;
+typedef InfoField<ServerTypeKey, Character<ServerInfo::Type>, &ServerInfoPrivate::setServerType, &ServerInfo::serverType> ServerTypeField;
+typedef InfoField<EnvironmentKey, Character<ServerInfo::Environment>, &ServerInfoPrivate::setEnvironment, &ServerInfo::environment> EnvironmentField;
+typedef InfoField<VisibilityKey, Flag<ServerInfo::Visibility, ServerInfo::Private, ServerInfo::Public>, &ServerInfoPrivate::setVisibility, &ServerInfo::visibility> VisibilityField;
+typedef InfoField<VacKey, Flag<ServerInfo::VAC, ServerInfo::Secured, ServerInfo::Unsecured>, &ServerInfoPrivate::setVac, &ServerInfo::vac> VacField;
+typedef InfoField<ModeKey, ShipMode, &ServerInfoPrivate::setTheShipMode, &ServerInfo::theShipMode, TheShip> ShipModeField;
+typedef InfoField<WitnessesKey, Number<quint8>, &ServerInfoPrivate::setTheShipWitnesses, &ServerInfo::theShipWitnesses, TheShip> ShipWitnessesField;
+typedef InfoField<DurationKey, Number<quint8>, &ServerInfoPrivate::setTheShipDuartion, &ServerInfo::theShipDuration, TheShip> ShipDurationField;
+typedef InfoField<VersionKey, LazyString<ServerInfoPrivate::LazyVersion>, &ServerInfoPrivate::setVersion, &ServerInfo::version> VersionField;
+typedef InfoField<GamePortKey, Number<quint16>, &ServerInfoPrivate::setGamePort, &ServerInfo::gamePort, ExtraData<0x80>> GamePortField;
+typedef InfoField<SteamIdKey, Number<quint64>, &ServerInfoPrivate::setSteamId, &ServerInfo::steamId, ExtraData<0x10>> SteamIdField;
+typedef InfoField<SpecPortKey, Number<quint16>, &ServerInfoPrivate::setSpecPort, &ServerInfo::specPort, ExtraData<0x40>> SpecPortField;
+typedef InfoField<SpecNameKey, LazyString<ServerInfoPrivate::LazySpecName>, &ServerInfoPrivate::setSpecName, &ServerInfo::specName, ExtraData<0x40>> SpecNameField;
+typedef InfoField<KeywordsKey, LazyString<ServerInfoPrivate::LazyKeywords, true, QStringList>, &ServerInfoPrivate::setKeywords, &ServerInfo::keywords, ExtraData<0x20>> KeywordsField;
+typedef InfoField<GameIdKey, Number<quint64>, &ServerInfoPrivate::setGameId, &ServerInfo::gameId, ExtraData<0x01>> GameIdField;
+typedef InfoField<GamePortKey, AddressPort, &ServerInfoPrivate::setGamePort, &ServerInfo::gamePort, Hidden> AddressField;
+typedef InfoField<IsModKey, Bool, &ServerInfoPrivate::setIsMod, &ServerInfo::isMod> IsModField;
+typedef InfoField<ModLinkKey, LazyString<ServerInfoPrivate::LazyModLink, false, QUrl>, &ServerInfoPrivate::setModLink, &ServerInfo::modLink, Mod> ModLinkField;
+typedef InfoField<ModDownloadLinkKey, LazyString<ServerInfoPrivate::LazyModDownloadLink, false, QUrl>, &ServerInfoPrivate::setModDownloadLink, &ServerInfo::modDownloadLink, Mod> ModDownloadLinkField;
+typedef InfoField<ModVersionKey, Number<quint32>, &ServerInfoPrivate::setModVersion, &ServerInfo::modVersion, Mod> ModVersionField;
+typedef InfoField<ModSizeKey, Number<quint32>, &ServerInfoPrivate::setModSize, &ServerInfo::modSize, Mod> ModSizeField;
+typedef InfoField<ModTypeKey, Flag<ServerInfo::ModType, ServerInfo::MultiplayerOnlyMod, ServerInfo::SingleAndMultiplayerMod>, &ServerInfoPrivate::setModType, &ServerInfo::modType, Mod> ModTypeField;
+typedef InfoField<ModDllKey, Flag<ServerInfo::ModDLLUsage, ServerInfo::UsesHalfLifeDll, ServerInfo::UsesOwnDll, ServerInfo::UsesHalfLifeDll>, &ServerInfoPrivate::setModDll, &ServerInfo::modDll, Mod> ModDllField;
+
+typedef Output<AddressKey, Getter<ServerInfo, QString, &ServerInfo::address>> AddressOutput;
+typedef Output<QueryPortKey, Getter<ServerInfo, quint16, &ServerInfo::queryPort>> QueryPortOutput;
+typedef Output<GoldSourceKey, Getter<ServerInfo, bool, &ServerInfo::isGoldSource>> GoldSourceOutput;
+typedef Output<StoreLinkKey, Getter<ServerInfo, QUrl, &ServerInfo::storeLink>> StoreLinkOutput;
+
+// A2S_INFO reply with the 'I' header, after the header
+typedef Layout<
+    AddressOutput, QueryPortOutput, GoldSourceOutput,
+    ProtocolField, NameField, MapField, FolderField, GameField,
+    Checkpoint,
+    AppIdField, PlayersField, MaxPlayersField, BotsField, ServerTypeField, EnvironmentField, VisibilityField, VacField,
+    OptionalPart,
+    ShipModeField, ShipWitnessesField, ShipDurationField,
+    VersionField,
+    ExtraDataFlag, GamePortField, SteamIdField, SpecPortField, SpecNameField, KeywordsField, GameIdField,
+    Checkpoint,
+    StoreLinkOutput,
+    Unset<IsModField>, Unset<ModLinkField>, Unset<ModDownloadLinkField>, Unset<ModVersionField>, Unset<ModSizeField>, Unset<ModTypeField>, Unset<ModDllField>
+> SourceInfo;
+
+// obsolete GoldSource A2S_INFO reply with the 'm' header, after the header
+typedef Layout<
+    AddressOutput, QueryPortOutput, GoldSourceOutput,
+    AddressField, NameField, MapField, FolderField, GameField,
+    Checkpoint,
+    PlayersField, MaxPlayersField, ProtocolField, ServerTypeField, EnvironmentField, VisibilityField,
+    IsModField, ModLinkField, ModDownloadLinkField, Padding<quint8, Mod>, ModVersionField, ModSizeField, ModTypeField, ModDllField,
+    VacField, BotsField,
+    Checkpoint,
+    Unset<AppIdField>, Unset<ShipModeField>, Unset<ShipWitnessesField>, Unset<ShipDurationField>,
+    Unset<SteamIdField>, Unset<SpecPortField>, Unset<SpecNameField>, Unset<KeywordsField>, Unset<GameIdField>
+> GoldSourceInfo;
+
+struct PlayerRecord {
+    QString name;
+    qint32 score = 0;
+    float duration = 0.0f;
+};
+
+template<typename Key, typename Codec, typename Codec::Result PlayerRecord::*Member, typename Codec::Result (Player::*Get)() const>
+struct PlayerField : Field<Key, Codec, Assign<PlayerRecord, typename Codec::Result, Member>, Getter<Player, typename Codec::Result, Get>> {};
+
+// one entry of the A2S_PLAYER reply, starting with the chunk index
+typedef Layout<
+    Padding<quint8>,
+    PlayerField<NameKey, String, &PlayerRecord::name, &Player::name>,
+    PlayerField<ScoreKey, Number<qint32>, &PlayerRecord::score, &Player::score>,
+    PlayerField<DurationKey, Number<float>, &PlayerRecord::duration, &Player::duration>
+> PlayerEntry;
+
+struct RuleRecord {
+    QString name;
+    QString value;
+};
+
+template<typename Key, QString RuleRecord::*Member>
+struct RuleField : Field<Key, String, Assign<RuleRecord, QString, Member>, Read<RuleRecord, QString, Member>> {};
+
+// one entry of the A2S_RULES reply
+typedef Layout<
+    RuleField<NameKey, &RuleRecord::name>,
+    RuleField<ValueKey, &RuleRecord::value>
+> RuleEntry;
+
+template<typename V> void visitServerInfo(V &v, const ServerInfo *si)
+{
+    if (si->isGoldSource()) {
+        GoldSourceInfo::visit(v, si);
+    } else {
+        SourceInfo::visit(v, si);
+    }
+}
+
+/*
+ * Printers instantiated from the layouts.
+ */
+class JsonPrinter
+{
+public:
+    explicit JsonPrinter(QJsonObject &_o) : o(_o) {}
+
+    template<int N> void field(const char (&k)[N], const QString &v) { insert(k, QJsonValue(v)); }
+    template<int N> void field(const char (&k)[N], const QByteArray &v) { insert(k, QJsonValue(QString::fromLatin1(v))); }
+    template<int N> void field(const char (&k)[N], const QStringList &v) { insert(k, QJsonArray::fromStringList(v)); }
+    template<int N> void field(const char (&k)[N], const QUrl &v) { insert(k, QJsonValue(v.toString())); }
+    template<int N> void field(const char (&k)[N], bool v) { insert(k, QJsonValue(v)); }
+    template<int N> void field(const char (&k)[N], float v) { insert(k, QJsonValue(static_cast<double>(v))); }
+    template<int N> void field(const char (&k)[N], qint32 v) { insert(k, QJsonValue(v)); }
+    template<int N> void field(const char (&k)[N], quint32 v) { insert(k, QJsonValue(static_cast<qint64>(v))); }
+    template<int N> void field(const char (&k)[N], quint64 v)
+    {
+        // 64 bit ids above 2^53 can not be represented by JSON numbers
+        if (v <= Q_UINT64_C(9007199254740992)) {
+            insert(k, QJsonValue(static_cast<qint64>(v)));
+        } else {
+            insert(k, QJsonValue(QString::number(v)));
+        }
+    }
+    template<int N> void field(const char (&k)[N], ServerInfo::Type v)
+    {
+        if (const char *str = serverTypeString(v)) {
+            insert(k, QJsonValue(QLatin1String(str)));
+        }
+    }
+    template<int N> void field(const char (&k)[N], ServerInfo::Environment v)
+    {
+        if (const char *str = environmentString(v)) {
+            insert(k, QJsonValue(QLatin1String(str)));
+        }
+    }
+    // quint8, quint16 and the remaining enums
+    template<int N, typename T> void field(const char (&k)[N], T v) { insert(k, QJsonValue(static_cast<int>(v))); }
+
+private:
+    template<int N> void insert(const char (&k)[N], const QJsonValue &v) { o.insert(QLatin1String(k, N - 1), v); }
+
+    QJsonObject &o;
+};
+
+class DebugPrinter
+{
+public:
+    explicit DebugPrinter(QDebug &_dbg) : dbg(_dbg) {}
+
+    template<int N, typename T> void field(const char (&k)[N], const T &v)
+    {
+        if (present(v)) {
+            dbg << ", " << k << ": " << v;
+        }
+    }
+    // quint8 would be printed as character
+    template<int N> void field(const char (&k)[N], quint8 v) { dbg << ", " << k << ": " << static_cast<uint>(v); }
+
+private:
+    QDebug &dbg;
+};
+
+}
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_A2SLAYOUT_P_H
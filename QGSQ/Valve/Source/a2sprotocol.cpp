@@ -0,0 +1,172 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "a2sprotocol.h"
+#include "serverquery_p.h"
+#include "serverinfo.h"
+#include "player.h"
+#include "querymetrics.h"
+#include <QJsonArray>
+#include <QtEndian>
+
+using namespace QGSQ::Valve::Source;
+
+QString A2SProtocol::name() const
+{
+    return QStringLiteral("Valve A2S");
+}
+
+quint16 A2SProtocol::defaultPort() const
+{
+    return 27015;
+}
+
+QByteArray A2SProtocol::buildRequest(int type, const QByteArray &challenge) const
+{
+    if (type == Info) {
+        // the challenge is only appended if the server asked for it
+        return QByteArrayLiteral("\xff\xff\xff\xffTSource Engine Query\0") + challenge;
+    }
+
+    // requesting with -1 as challenge returns the challenge
+    return QByteArrayLiteral("\xff\xff\xff\xff") + static_cast<char>(type) + (challenge.isEmpty() ? QByteArrayLiteral("\xff\xff\xff\xff") : challenge);
+}
+
+bool A2SProtocol::requestsChallenge(int type) const
+{
+    return (type != Info);
+}
+
+QGSQ::QueryProtocol::Packet A2SProtocol::unpack(const QByteArray &datagram, QByteArray *payload) const
+{
+    if (Q_UNLIKELY(datagram.size() < 4)) {
+        return InvalidPacket;
+    }
+
+    const auto leftData = QByteArray::fromRawData(datagram.constData(), 4);
+    if (leftData == QByteArrayLiteral("\xff\xff\xff\xff")) {
+        *payload = datagram.mid(4);
+        return SinglePacket;
+    } else if (leftData == QByteArrayLiteral("\xfe\xff\xff\xff")) {
+        return SplitPacket;
+    }
+
+    return InvalidPacket;
+}
+
+QGSQ::QueryReassembler *A2SProtocol::createReassembler() const
+{
+    return new SplitPacketAssembler;
+}
+
+quint32 A2SProtocol::splitId(const QByteArray &datagram) const
+{
+    // the id follows the split header in all split packet layouts
+    if (Q_UNLIKELY(datagram.size() < 8)) {
+        return 0;
+    }
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(datagram.constData() + 4));
+}
+
+QGSQ::QueryProtocol::Reply A2SProtocol::matchReply(int type, const QByteArray &payload, QByteArray *challenge) const
+{
+    if (Q_UNLIKELY(payload.isEmpty())) {
+        return UnexpectedReply;
+    }
+
+    const char header = payload.at(0);
+
+    if (header == 'A') {
+        if (Q_UNLIKELY(payload.size() != 5)) {
+            return UnexpectedReply;
+        }
+        *challenge = payload.mid(1, 4);
+        return ChallengeReply;
+    }
+
+    switch (type) {
+    case Info:
+        return ((header == 'I') || (header == 'm')) ? ExpectedReply : UnexpectedReply;
+    case Rules:
+        return (header == 'E') ? ExpectedReply : UnexpectedReply;
+    case Players:
+        return (header == 'D') ? ExpectedReply : UnexpectedReply;
+    default:
+        return UnexpectedReply;
+    }
+}
+
+QJsonObject A2SProtocol::parse(int type, const QByteArray &payload) const
+{
+    QJsonObject o;
+
+    switch (type) {
+    case Info:
+    {
+        ServerInfo si;
+        if (si.setRawData(payload) > 0) {
+            o = si.toJson();
+        }
+        break;
+    }
+    case Rules:
+    {
+        const auto rules = ServerQueryPrivate::extractRules(payload);
+        for (auto it = rules.constBegin(); it != rules.constEnd(); ++it) {
+            o.insert(it.key(), QJsonValue(it.value()));
+        }
+        break;
+    }
+    case Players:
+    {
+        const QList<Player*> players = ServerQueryPrivate::extractPlayers(payload);
+        QJsonArray lst;
+        for (const Player *p : players) {
+            lst.append(p->toJson());
+        }
+        qDeleteAll(players);
+        o.insert(QStringLiteral("players"), lst);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return o;
+}
+
+int A2SProtocol::latencyType(int type) const
+{
+    switch (type) {
+    case Info:
+        return QueryMetrics::Info;
+    case Rules:
+        return QueryMetrics::Rules;
+    case Players:
+        return QueryMetrics::Players;
+    default:
+        return -1;
+    }
+}
+
+const A2SProtocol *A2SProtocol::instance()
+{
+    static const A2SProtocol protocol;
+    return &protocol;
+}
@@ -0,0 +1,62 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_A2SPROTOCOL_H
+#define QGSQ_VALVE_SOURCE_A2SPROTOCOL_H
+
+#include "qgsq_global.h"
+#include "queryprotocol.h"
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * The Valve A2S protocol for QueryEngine, also used by ServerQuery. Rules
+ * and players are always requested with a challenge, newer servers protect
+ * A2S_INFO with one as well. Replies can be split over multiple datagrams.
+ */
+class QGSQ_LIBRARY A2SProtocol : public QGSQ::QueryProtocol
+{
+public:
+    enum Type : int {
+        Info    = 'T',
+        Rules   = 'V',
+        Players = 'U'
+    };
+
+    QString name() const override;
+    quint16 defaultPort() const override;
+    QByteArray buildRequest(int type, const QByteArray &challenge) const override;
+    bool requestsChallenge(int type) const override;
+    Packet unpack(const QByteArray &datagram, QByteArray *payload) const override;
+    QueryReassembler *createReassembler() const override;
+    quint32 splitId(const QByteArray &datagram) const override;
+    Reply matchReply(int type, const QByteArray &payload, QByteArray *challenge) const override;
+    QJsonObject parse(int type, const QByteArray &payload) const override;
+    int latencyType(int type) const override;
+
+    static const A2SProtocol *instance();
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_A2SPROTOCOL_H
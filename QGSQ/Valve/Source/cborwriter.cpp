@@ -0,0 +1,210 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "cborwriter_p.h"
+#include <QtEndian>
+#include <cstring>
+
+using namespace QGSQ::Valve::Source;
+
+CborWriter::CborWriter(QByteArray *buffer) :
+    d_ptr(new CborWriterPrivate(buffer, nullptr))
+{
+
+}
+
+CborWriter::CborWriter(QIODevice *device) :
+    d_ptr(new CborWriterPrivate(nullptr, device))
+{
+
+}
+
+CborWriter::~CborWriter()
+{
+    flush();
+}
+
+void CborWriter::beginArray(int count)
+{
+    Q_D(CborWriter);
+    d->beginArray(count);
+}
+
+void CborWriter::endArray()
+{
+    Q_D(CborWriter);
+    d->endArray();
+}
+
+void CborWriter::writeServerInfo(const ServerInfo *serverInfo)
+{
+    Q_D(CborWriter);
+    Encoding::serverInfo(*d, serverInfo);
+}
+
+void CborWriter::writeRules(const QHash<QString,QString> &rules)
+{
+    Q_D(CborWriter);
+    Encoding::rules(*d, rules);
+}
+
+void CborWriter::writePlayer(const Player *player)
+{
+    Q_D(CborWriter);
+    Encoding::player(*d, player);
+}
+
+void CborWriter::writePlayers(const QList<Player*> &players)
+{
+    Q_D(CborWriter);
+    Encoding::players(*d, players);
+}
+
+void CborWriter::writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players)
+{
+    Q_D(CborWriter);
+    Encoding::server(*d, serverInfo, rules, players);
+}
+
+void CborWriter::writeBatch(const QList<ServerInfo*> &serverInfos)
+{
+    Q_D(CborWriter);
+    Encoding::batch(*d, serverInfos);
+}
+
+bool CborWriter::flush()
+{
+    Q_D(CborWriter);
+    return d->flush();
+}
+
+void CborWriterPrivate::head(MajorType major, quint64 argument)
+{
+    const auto m = static_cast<uchar>(major << 5);
+    uchar h[9];
+    int size = 1;
+    if (argument < 24) {
+        h[0] = m | static_cast<uchar>(argument);
+    } else if (argument <= 0xff) {
+        h[0] = m | 24;
+        h[1] = static_cast<uchar>(argument);
+        size = 2;
+    } else if (argument <= 0xffff) {
+        h[0] = m | 25;
+        qToBigEndian<quint16>(static_cast<quint16>(argument), h + 1);
+        size = 3;
+    } else if (argument <= 0xffffffff) {
+        h[0] = m | 26;
+        qToBigEndian<quint32>(static_cast<quint32>(argument), h + 1);
+        size = 5;
+    } else {
+        h[0] = m | 27;
+        qToBigEndian<quint64>(argument, h + 1);
+        size = 9;
+    }
+    out->append(reinterpret_cast<const char*>(h), size);
+}
+
+void CborWriterPrivate::beginMap(int size)
+{
+    head(MapType, static_cast<quint64>(size));
+    indefinite.append(false);
+    ++depth;
+}
+
+void CborWriterPrivate::endMap()
+{
+    indefinite.removeLast();
+    --depth;
+    endValue();
+}
+
+void CborWriterPrivate::beginArray(int size)
+{
+    if (size < 0) {
+        out->append(static_cast<char>(0x9f));
+        indefinite.append(true);
+    } else {
+        head(ArrayType, static_cast<quint64>(size));
+        indefinite.append(false);
+    }
+    ++depth;
+}
+
+void CborWriterPrivate::endArray()
+{
+    if (indefinite.last()) {
+        out->append(static_cast<char>(0xff));
+    }
+    indefinite.removeLast();
+    --depth;
+    endValue();
+}
+
+void CborWriterPrivate::value(const QString &str)
+{
+    value(str.toUtf8());
+}
+
+void CborWriterPrivate::value(const QByteArray &utf8)
+{
+    head(TextStringType, static_cast<quint64>(utf8.size()));
+    out->append(utf8);
+    endValue();
+}
+
+void CborWriterPrivate::value(qint64 number)
+{
+    if (number >= 0) {
+        head(UnsignedIntegerType, static_cast<quint64>(number));
+    } else {
+        head(NegativeIntegerType, static_cast<quint64>(-(number + 1)));
+    }
+    endValue();
+}
+
+void CborWriterPrivate::value(quint64 number)
+{
+    head(UnsignedIntegerType, number);
+    endValue();
+}
+
+void CborWriterPrivate::value(bool b)
+{
+    out->append(static_cast<char>(b ? 0xf5 : 0xf4));
+    endValue();
+}
+
+void CborWriterPrivate::value(float number)
+{
+    quint32 bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    uchar f[5];
+    f[0] = 0xfa;
+    qToBigEndian<quint32>(bits, f + 1);
+    out->append(reinterpret_cast<const char*>(f), 5);
+    endValue();
+}
+
+void CborWriterPrivate::endValue()
+{
+    if (depth == 0) {
+        maybeFlush();
+    }
+}
@@ -0,0 +1,78 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_CBORWRITER_H
+#define QGSQ_VALVE_SOURCE_CBORWRITER_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QScopedPointer>
+
+class QIODevice;
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class CborWriterPrivate;
+class ServerInfo;
+class Player;
+
+/*
+ * Encodes server information, rules and players as CBOR (RFC 7049) directly
+ * into a byte array or an IO device. Maps use the same keys as the JSON
+ * output, 64 bit ids are always encoded as unsigned integers. Arrays started
+ * with a negative count use the indefinite length encoding.
+ */
+class QGSQ_LIBRARY CborWriter
+{
+public:
+    explicit CborWriter(QByteArray *buffer);
+
+    explicit CborWriter(QIODevice *device);
+
+    ~CborWriter();
+
+    void beginArray(int count = -1);
+    void endArray();
+
+    void writeServerInfo(const ServerInfo *serverInfo);
+    void writeRules(const QHash<QString,QString> &rules);
+    void writePlayer(const Player *player);
+    void writePlayers(const QList<Player*> &players);
+    void writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players);
+    void writeBatch(const QList<ServerInfo*> &serverInfos);
+
+    bool flush();
+
+protected:
+    const QScopedPointer<CborWriterPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(CborWriter)
+    Q_DECLARE_PRIVATE(CborWriter)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_CBORWRITER_H
@@ -0,0 +1,76 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_CBORWRITER_P_H
+#define QGSQ_VALVE_SOURCE_CBORWRITER_P_H
+
+#include "cborwriter.h"
+#include "resultencoding_p.h"
+#include <QVarLengthArray>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class CborWriterPrivate : public EncodingBuffer
+{
+public:
+    CborWriterPrivate(QByteArray *_buffer, QIODevice *_device) :
+        EncodingBuffer(_buffer, _device)
+    {}
+
+    static const bool Native64BitIntegers = true;
+
+    enum MajorType : quint8 {
+        UnsignedIntegerType = 0,
+        NegativeIntegerType = 1,
+        TextStringType      = 3,
+        ArrayType           = 4,
+        MapType             = 5
+    };
+
+    template<int N> inline void key(const char (&k)[N])
+    {
+        head(TextStringType, N - 1);
+        out->append(k, N - 1);
+    }
+
+    void dynamicKey(const QString &k) { value(k); }
+    void head(MajorType major, quint64 argument);
+    void beginMap(int size);
+    void endMap();
+    void beginArray(int size);
+    void endArray();
+    void value(const QString &str);
+    void value(const QByteArray &utf8);
+    void value(qint64 number);
+    void value(quint64 number);
+    void value(int number) { value(static_cast<qint64>(number)); }
+    void value(bool b);
+    void value(float number);
+    void endValue();
+
+    QVarLengthArray<bool, 8> indefinite;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_CBORWRITER_P_H
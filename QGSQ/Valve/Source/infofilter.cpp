@@ -0,0 +1,443 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "infofilter_p.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <QHash>
+#include <QLoggingCategory>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(SIF, "qgsq.valve.source.infofilter")
+
+using namespace QGSQ::Valve::Source;
+
+namespace {
+
+bool spanEquals(const RawInfoFields::Span &span, const QByteArray &text)
+{
+    return (span.size == text.size()) && (qstrnicmp(span.data, text.constData(), static_cast<uint>(span.size)) == 0);
+}
+
+bool spanContains(const RawInfoFields::Span &span, const QByteArray &text)
+{
+    const int last = span.size - text.size();
+    for (int i = 0; i <= last; ++i) {
+        if (qstrnicmp(span.data + i, text.constData(), static_cast<uint>(text.size())) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool hasKeyword(const RawInfoFields::Span &keywords, const QByteArray &keyword)
+{
+    const char *p = keywords.data;
+    const char *end = keywords.data + keywords.size;
+    while (p < end) {
+        const char *sep = static_cast<const char *>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+        const char *tokenEnd = sep ? sep : end;
+        RawInfoFields::Span token;
+        token.data = p;
+        token.size = static_cast<int>(tokenEnd - p);
+        if (spanEquals(token, keyword)) {
+            return true;
+        }
+        p = tokenEnd + 1;
+    }
+    return false;
+}
+
+}
+
+InfoFilter::InfoFilter() : d_ptr(new InfoFilterPrivate)
+{
+
+}
+
+InfoFilter::InfoFilter(const QString &expression) : d_ptr(new InfoFilterPrivate)
+{
+    setExpression(expression);
+}
+
+InfoFilter::~InfoFilter()
+{
+
+}
+
+bool InfoFilter::setExpression(const QString &expression)
+{
+    Q_D(InfoFilter);
+    d->conditions.clear();
+    d->errorString.clear();
+    d->needsKeywords = false;
+
+    static const QRegularExpression termRe(QStringLiteral("^(!?)\\s*([A-Za-z_]+)\\s*(?:(==|!=|<=|>=|<|>|=|contains)\\s*(.*?))?$"), QRegularExpression::CaseInsensitiveOption);
+
+    const QStringList terms = expression.split(QStringLiteral("&&"), QString::SkipEmptyParts);
+    for (const QString &rawTerm : terms) {
+        const QString term = rawTerm.trimmed();
+        if (term.isEmpty()) {
+            continue;
+        }
+
+        const QRegularExpressionMatch m = termRe.match(term);
+        InfoFilterPrivate::Field field;
+        if (!m.hasMatch() || !InfoFilterPrivate::fieldFromName(m.captured(2), &field)) {
+            d->errorString = QStringLiteral("Invalid filter condition: ") + term;
+            d->conditions.clear();
+            return false;
+        }
+
+        const bool negated = !m.captured(1).isEmpty();
+        const QString opString = m.captured(3).toLower();
+        if (opString.isEmpty()) {
+            // plain field names test flags, like "vac" or "!private"
+            if (InfoFilterPrivate::isText(field)) {
+                d->errorString = QStringLiteral("Missing comparison in filter condition: ") + term;
+                d->conditions.clear();
+                return false;
+            }
+            d->addCondition(field, negated ? InfoFilterPrivate::Equal : InfoFilterPrivate::NotEqual, QStringLiteral("0"));
+            continue;
+        }
+
+        if (negated) {
+            d->errorString = QStringLiteral("Negation is only supported for flags: ") + term;
+            d->conditions.clear();
+            return false;
+        }
+
+        InfoFilterPrivate::Op op = InfoFilterPrivate::Equal;
+        if (opString == QLatin1String("!=")) {
+            op = InfoFilterPrivate::NotEqual;
+        } else if (opString == QLatin1String("<")) {
+            op = InfoFilterPrivate::Less;
+        } else if (opString == QLatin1String("<=")) {
+            op = InfoFilterPrivate::LessEqual;
+        } else if (opString == QLatin1String(">")) {
+            op = InfoFilterPrivate::Greater;
+        } else if (opString == QLatin1String(">=")) {
+            op = InfoFilterPrivate::GreaterEqual;
+        } else if (opString == QLatin1String("contains")) {
+            op = InfoFilterPrivate::Contains;
+        }
+
+        QString value = m.captured(4).trimmed();
+        if ((value.size() >= 2) && value.startsWith(QLatin1Char('"')) && value.endsWith(QLatin1Char('"'))) {
+            value = value.mid(1, value.size() - 2);
+        }
+
+        if (!d->addCondition(field, op, value)) {
+            d->errorString += QStringLiteral(": ") + term;
+            d->conditions.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InfoFilter::setMasterFilter(const QString &filter)
+{
+    Q_D(InfoFilter);
+    d->conditions.clear();
+    d->errorString.clear();
+    d->needsKeywords = false;
+
+    QStringList parts = filter.split(QLatin1Char('\\'));
+    if (!parts.isEmpty() && parts.first().isEmpty()) {
+        parts.removeFirst();
+    }
+    if (parts.size() % 2) {
+        d->errorString = QStringLiteral("Master server filter has a key without value.");
+        return false;
+    }
+
+    for (int i = 0; i < parts.size(); i += 2) {
+        const QString key = parts.at(i).toLower();
+        const QString &value = parts.at(i + 1);
+        const bool set = (value != QLatin1String("0"));
+        bool ok = true;
+
+        if (key == QLatin1String("appid")) {
+            ok = d->addCondition(InfoFilterPrivate::AppId, InfoFilterPrivate::Equal, value);
+        } else if (key == QLatin1String("napp")) {
+            ok = d->addCondition(InfoFilterPrivate::AppId, InfoFilterPrivate::NotEqual, value);
+        } else if (key == QLatin1String("gamedir")) {
+            ok = d->addCondition(InfoFilterPrivate::Folder, InfoFilterPrivate::Equal, value);
+        } else if (key == QLatin1String("map")) {
+            ok = d->addCondition(InfoFilterPrivate::Map, InfoFilterPrivate::Equal, value);
+        } else if (key == QLatin1String("gametype")) {
+            const QStringList keywords = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+            for (const QString &kw : keywords) {
+                d->addCondition(InfoFilterPrivate::Keyword, InfoFilterPrivate::Contains, kw);
+            }
+        } else if (key == QLatin1String("password")) {
+            d->addCondition(InfoFilterPrivate::Private, InfoFilterPrivate::Equal, set ? QStringLiteral("1") : QStringLiteral("0"));
+        } else if (key == QLatin1String("empty")) {
+            // servers that are not empty
+            if (set) {
+                d->addCondition(InfoFilterPrivate::Players, InfoFilterPrivate::Greater, QStringLiteral("0"));
+            }
+        } else if (key == QLatin1String("noplayers")) {
+            if (set) {
+                d->addCondition(InfoFilterPrivate::Players, InfoFilterPrivate::Equal, QStringLiteral("0"));
+            }
+        } else if (key == QLatin1String("full")) {
+            // servers that are not full
+            if (set) {
+                d->addCondition(InfoFilterPrivate::Full, InfoFilterPrivate::Equal, QStringLiteral("0"));
+            }
+        } else if ((key == QLatin1String("dedicated")) || (key == QLatin1String("secure")) || (key == QLatin1String("linux")) || (key == QLatin1String("proxy"))) {
+            if (set) {
+                InfoFilterPrivate::Field field;
+                InfoFilterPrivate::fieldFromName(key, &field);
+                d->addCondition(field, InfoFilterPrivate::NotEqual, QStringLiteral("0"));
+            }
+        } else {
+            d->errorString = QStringLiteral("Unsupported master server filter key: ") + key;
+            ok = false;
+        }
+
+        if (!ok) {
+            d->conditions.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InfoFilter::isEmpty() const
+{
+    Q_D(const InfoFilter);
+    return d->conditions.isEmpty();
+}
+
+QString InfoFilter::errorString() const
+{
+    Q_D(const InfoFilter);
+    return d->errorString;
+}
+
+bool InfoFilter::matches(const QByteArray &data) const
+{
+    Q_D(const InfoFilter);
+
+    RawInfoFields fields;
+    bool match = InfoFilterPrivate::scan(data, &fields, d->needsKeywords);
+    if (Q_UNLIKELY(!match)) {
+        qCDebug(SIF, "Failed to scan A2S_INFO reply of %i bytes.", data.size());
+    }
+
+    for (int i = 0; match && (i < d->conditions.size()); ++i) {
+        match = d->evaluate(d->conditions.at(i), fields);
+    }
+
+    if (match) {
+        d->accepted.fetchAndAddRelaxed(1);
+    } else {
+        d->rejected.fetchAndAddRelaxed(1);
+    }
+
+    return match;
+}
+
+quint64 InfoFilter::accepted() const
+{
+    Q_D(const InfoFilter);
+    return d->accepted.load();
+}
+
+quint64 InfoFilter::rejected() const
+{
+    Q_D(const InfoFilter);
+    return d->rejected.load();
+}
+
+bool InfoFilterPrivate::scan(const QByteArray &data, RawInfoFields *fields, bool withKeywords)
+{
+    A2S::Scanner s(data);
+    const char header = s.getCharacter();
+    fields->scanOptional = withKeywords;
+
+    if (header == 'I') {
+        A2S::SourceInfo::scan(fields, s);
+    } else if (header == 'm') {
+        fields->goldSource = true;
+        A2S::GoldSourceInfo::scan(fields, s);
+    } else {
+        return false;
+    }
+
+    return !s.hasError();
+}
+
+bool InfoFilterPrivate::fieldFromName(const QString &name, Field *field)
+{
+    static const QHash<QString,Field> fields({
+        {QStringLiteral("appid"), AppId},
+        {QStringLiteral("protocol"), Protocol},
+        {QStringLiteral("players"), Players},
+        {QStringLiteral("maxplayers"), MaxPlayers},
+        {QStringLiteral("bots"), Bots},
+        {QStringLiteral("private"), Private},
+        {QStringLiteral("password"), Private},
+        {QStringLiteral("vac"), Vac},
+        {QStringLiteral("secure"), Vac},
+        {QStringLiteral("dedicated"), Dedicated},
+        {QStringLiteral("linux"), Linux},
+        {QStringLiteral("proxy"), Proxy},
+        {QStringLiteral("full"), Full},
+        {QStringLiteral("goldsource"), GoldSource},
+        {QStringLiteral("map"), Map},
+        {QStringLiteral("folder"), Folder},
+        {QStringLiteral("gamedir"), Folder},
+        {QStringLiteral("game"), Game},
+        {QStringLiteral("keywords"), Keyword},
+        {QStringLiteral("keyword"), Keyword},
+        {QStringLiteral("gametype"), Keyword}
+    });
+
+    const auto it = fields.constFind(name.toLower());
+    if (it == fields.constEnd()) {
+        return false;
+    }
+    *field = it.value();
+    return true;
+}
+
+bool InfoFilterPrivate::addCondition(Field field, Op op, const QString &value)
+{
+    Condition c;
+    c.field = field;
+    c.op = op;
+
+    if (isText(field)) {
+        if ((op != Equal) && (op != NotEqual) && (op != Contains)) {
+            errorString = QStringLiteral("Strings can only be compared for equality");
+            return false;
+        }
+        if ((field == Keyword) && (op == Equal)) {
+            c.op = Contains;
+        }
+        c.text = value.toUtf8();
+        needsKeywords |= (field == Keyword);
+    } else {
+        if (op == Contains) {
+            errorString = QStringLiteral("Numbers can not be searched");
+            return false;
+        }
+        bool ok = false;
+        c.number = value.toLongLong(&ok);
+        if (!ok) {
+            if (value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
+                c.number = 1;
+            } else if (value.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
+                c.number = 0;
+            } else {
+                errorString = QStringLiteral("Invalid number");
+                return false;
+            }
+        }
+    }
+
+    conditions.append(c);
+    return true;
+}
+
+bool InfoFilterPrivate::evaluate(const Condition &c, const RawInfoFields &f) const
+{
+    switch (c.field) {
+    case Map:
+    case Folder:
+    case Game:
+    {
+        const RawInfoFields::Span &span = (c.field == Map) ? f.map : ((c.field == Folder) ? f.folder : f.game);
+        if (c.op == Contains) {
+            return spanContains(span, c.text);
+        }
+        return spanEquals(span, c.text) == (c.op == Equal);
+    }
+    case Keyword:
+        return hasKeyword(f.keywords, c.text) == (c.op == Contains);
+    default:
+        break;
+    }
+
+    qint64 value = 0;
+    switch (c.field) {
+    case AppId:
+        value = f.appId;
+        break;
+    case Protocol:
+        value = f.protocol;
+        break;
+    case Players:
+        value = f.players;
+        break;
+    case MaxPlayers:
+        value = f.maxPlayers;
+        break;
+    case Bots:
+        value = f.bots;
+        break;
+    case Private:
+        value = f.visibility ? 1 : 0;
+        break;
+    case Vac:
+        value = f.vac ? 1 : 0;
+        break;
+    case Dedicated:
+        value = ((f.serverType == 'd') || (f.serverType == 'D')) ? 1 : 0;
+        break;
+    case Linux:
+        value = ((f.environment == 'l') || (f.environment == 'L')) ? 1 : 0;
+        break;
+    case Proxy:
+        value = ((f.serverType == 'p') || (f.serverType == 'P')) ? 1 : 0;
+        break;
+    case Full:
+        value = (f.players >= f.maxPlayers) ? 1 : 0;
+        break;
+    case GoldSource:
+        value = f.goldSource ? 1 : 0;
+        break;
+    default:
+        break;
+    }
+
+    switch (c.op) {
+    case Equal:
+        return value == c.number;
+    case NotEqual:
+        return value != c.number;
+    case Less:
+        return value < c.number;
+    case LessEqual:
+        return value <= c.number;
+    case Greater:
+        return value > c.number;
+    case GreaterEqual:
+        return value >= c.number;
+    default:
+        return false;
+    }
+}
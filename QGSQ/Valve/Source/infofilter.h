@@ -0,0 +1,78 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_INFOFILTER_H
+#define QGSQ_VALVE_SOURCE_INFOFILTER_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QByteArray>
+#include <QScopedPointer>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class InfoFilterPrivate;
+
+/*
+ * Filter that is evaluated directly on raw A2S_INFO replies, before any
+ * ServerInfo is created. Only the fixed fields are scanned, strings are
+ * compared as raw bytes and the extra data is only walked if keywords are
+ * filtered. Filters are either expressions of conditions joined by &&, like
+ * "appId == 730 && players > 0 && !private", or Valve master server filters
+ * like "\appid\730\empty\1\password\0". Strings are compared case
+ * insensitive, "map contains dust" matches a part of a string field and
+ * "keywords contains secure" a complete keyword. Malformed replies never
+ * match.
+ * Setting a filter is not thread safe, matches() can be called concurrently.
+ */
+class QGSQ_LIBRARY InfoFilter
+{
+public:
+    InfoFilter();
+
+    explicit InfoFilter(const QString &expression);
+
+    ~InfoFilter();
+
+    bool setExpression(const QString &expression);
+    bool setMasterFilter(const QString &filter);
+
+    bool isEmpty() const;
+    QString errorString() const;
+
+    bool matches(const QByteArray &data) const;
+
+    quint64 accepted() const;
+    quint64 rejected() const;
+
+protected:
+    const QScopedPointer<InfoFilterPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(InfoFilter)
+    Q_DECLARE_PRIVATE(InfoFilter)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_INFOFILTER_H
@@ -0,0 +1,132 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_INFOFILTER_P_H
+#define QGSQ_VALVE_SOURCE_INFOFILTER_P_H
+
+#include "infofilter.h"
+#include "a2slayout_p.h"
+#include <QVector>
+#include <QAtomicInteger>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Fields of a raw A2S_INFO reply, filled by scanning the reply with the A2S
+ * layouts. Strings point into the reply and are not null terminated.
+ */
+struct RawInfoFields
+{
+    typedef A2S::Span Span;
+
+    void store(A2S::MapKey, const Span &value) { map = value; }
+    void store(A2S::FolderKey, const Span &value) { folder = value; }
+    void store(A2S::GameKey, const Span &value) { game = value; }
+    void store(A2S::KeywordsKey, const Span &value) { keywords = value; }
+    void store(A2S::AppIdKey, quint16 value) { appId = value; }
+    void store(A2S::ProtocolKey, quint8 value) { protocol = value; }
+    void store(A2S::PlayersKey, quint8 value) { players = value; }
+    void store(A2S::MaxPlayersKey, quint8 value) { maxPlayers = value; }
+    void store(A2S::BotsKey, quint8 value) { bots = value; }
+    void store(A2S::ServerTypeKey, char value) { serverType = value; }
+    void store(A2S::EnvironmentKey, char value) { environment = value; }
+    void store(A2S::VisibilityKey, quint8 value) { visibility = value; }
+    void store(A2S::VacKey, quint8 value) { vac = value; }
+    void store(A2S::IsModKey, bool value) { isMod = value; }
+    // the filter has no conditions on the other fields
+    template<typename Key, typename T> void store(Key, const T &) {}
+
+    Span map;
+    Span folder;
+    Span game;
+    Span keywords;
+    quint16 appId = 0;
+    quint8 protocol = 0;
+    quint8 players = 0;
+    quint8 maxPlayers = 0;
+    quint8 bots = 0;
+    char serverType = '\0';
+    char environment = '\0';
+    quint8 visibility = 0;
+    quint8 vac = 0;
+    bool isMod = false;
+    bool goldSource = false;
+    // the version and extra data are only scanned for keywords
+    bool scanOptional = true;
+};
+
+class InfoFilterPrivate
+{
+public:
+    enum Field : quint8 {
+        AppId,
+        Protocol,
+        Players,
+        MaxPlayers,
+        Bots,
+        Private,
+        Vac,
+        Dedicated,
+        Linux,
+        Proxy,
+        Full,
+        GoldSource,
+        Map,
+        Folder,
+        Game,
+        Keyword
+    };
+
+    enum Op : quint8 {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Contains
+    };
+
+    struct Condition {
+        QByteArray text;
+        qint64 number = 0;
+        Field field = AppId;
+        Op op = Equal;
+    };
+
+    static bool scan(const QByteArray &data, RawInfoFields *fields, bool withKeywords);
+    static bool fieldFromName(const QString &name, Field *field);
+    static bool isText(Field field) { return field >= Map; }
+    bool addCondition(Field field, Op op, const QString &value);
+    bool evaluate(const Condition &c, const RawInfoFields &f) const;
+
+    QVector<Condition> conditions;
+    QString errorString;
+    mutable QAtomicInteger<quint64> accepted;
+    mutable QAtomicInteger<quint64> rejected;
+    bool needsKeywords = false;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_INFOFILTER_P_H
@@ -0,0 +1,260 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonwriter_p.h"
+#include <cmath>
+
+Q_LOGGING_CATEGORY(VSRE, "qgsq.valve.source.encoding")
+
+using namespace QGSQ::Valve::Source;
+
+JsonWriter::JsonWriter(QByteArray *buffer, Format format) :
+    d_ptr(new JsonWriterPrivate(buffer, nullptr, format))
+{
+
+}
+
+JsonWriter::JsonWriter(QIODevice *device, Format format) :
+    d_ptr(new JsonWriterPrivate(nullptr, device, format))
+{
+
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+JsonWriter::Format JsonWriter::format() const
+{
+    Q_D(const JsonWriter);
+    return d->format;
+}
+
+void JsonWriter::beginArray()
+{
+    Q_D(JsonWriter);
+    d->beginArray(-1);
+}
+
+void JsonWriter::endArray()
+{
+    Q_D(JsonWriter);
+    d->endArray();
+}
+
+void JsonWriter::writeServerInfo(const ServerInfo *serverInfo)
+{
+    Q_D(JsonWriter);
+    Encoding::serverInfo(*d, serverInfo);
+}
+
+void JsonWriter::writeRules(const QHash<QString,QString> &rules)
+{
+    Q_D(JsonWriter);
+    Encoding::rules(*d, rules);
+}
+
+void JsonWriter::writePlayer(const Player *player)
+{
+    Q_D(JsonWriter);
+    Encoding::player(*d, player);
+}
+
+void JsonWriter::writePlayers(const QList<Player*> &players)
+{
+    Q_D(JsonWriter);
+    Encoding::players(*d, players);
+}
+
+void JsonWriter::writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players)
+{
+    Q_D(JsonWriter);
+    Encoding::server(*d, serverInfo, rules, players);
+}
+
+void JsonWriter::writeBatch(const QList<ServerInfo*> &serverInfos)
+{
+    Q_D(JsonWriter);
+    Encoding::batch(*d, serverInfos);
+}
+
+bool JsonWriter::flush()
+{
+    Q_D(JsonWriter);
+    return d->flush();
+}
+
+void JsonWriterPrivate::dynamicKey(const QString &k)
+{
+    value(k);
+    out->append(':');
+    afterKey = true;
+}
+
+void JsonWriterPrivate::separator()
+{
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+
+    if (!first.isEmpty()) {
+        if (first.last()) {
+            first.last() = false;
+        } else {
+            out->append(',');
+        }
+    }
+}
+
+void JsonWriterPrivate::beginMap(int size)
+{
+    Q_UNUSED(size);
+    separator();
+    out->append('{');
+    first.append(true);
+}
+
+void JsonWriterPrivate::endMap()
+{
+    first.removeLast();
+    out->append('}');
+    endValue();
+}
+
+void JsonWriterPrivate::beginArray(int size)
+{
+    Q_UNUSED(size);
+    separator();
+    out->append('[');
+    first.append(true);
+}
+
+void JsonWriterPrivate::endArray()
+{
+    first.removeLast();
+    out->append(']');
+    endValue();
+}
+
+void JsonWriterPrivate::value(const QString &str)
+{
+    value(str.toUtf8());
+}
+
+void JsonWriterPrivate::value(const QByteArray &utf8)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    separator();
+    out->append('"');
+
+    const char *run = utf8.constData();
+    const char *end = run + utf8.size();
+    for (const char *p = run; p != end; ++p) {
+        const auto c = static_cast<uchar>(*p);
+        if (Q_LIKELY((c >= 0x20) && (c != '"') && (c != '\\'))) {
+            continue;
+        }
+        out->append(run, static_cast<int>(p - run));
+        run = p + 1;
+        switch (c) {
+        case '"':
+            out->append("\\\"", 2);
+            break;
+        case '\\':
+            out->append("\\\\", 2);
+            break;
+        case '\n':
+            out->append("\\n", 2);
+            break;
+        case '\r':
+            out->append("\\r", 2);
+            break;
+        case '\t':
+            out->append("\\t", 2);
+            break;
+        case '\b':
+            out->append("\\b", 2);
+            break;
+        case '\f':
+            out->append("\\f", 2);
+            break;
+        default:
+        {
+            const char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+            out->append(esc, 6);
+            break;
+        }
+        }
+    }
+    out->append(run, static_cast<int>(end - run));
+
+    out->append('"');
+    endValue();
+}
+
+void JsonWriterPrivate::value(qint64 number)
+{
+    separator();
+    out->append(QByteArray::number(number));
+    endValue();
+}
+
+void JsonWriterPrivate::value(quint64 number)
+{
+    separator();
+    out->append(QByteArray::number(number));
+    endValue();
+}
+
+void JsonWriterPrivate::value(bool b)
+{
+    separator();
+    if (b) {
+        out->append("true", 4);
+    } else {
+        out->append("false", 5);
+    }
+    endValue();
+}
+
+void JsonWriterPrivate::value(float number)
+{
+    separator();
+    const auto d = static_cast<double>(number);
+    if (Q_LIKELY(std::isfinite(d))) {
+        // 9 significant digits are enough to restore every float
+        out->append(QByteArray::number(d, 'g', 9));
+    } else {
+        out->append("null", 4);
+    }
+    endValue();
+}
+
+void JsonWriterPrivate::endValue()
+{
+    if (first.isEmpty()) {
+        if (format == JsonWriter::NDJson) {
+            out->append('\n');
+        }
+        maybeFlush();
+    }
+}
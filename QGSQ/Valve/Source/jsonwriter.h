@@ -0,0 +1,86 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_JSONWRITER_H
+#define QGSQ_VALVE_SOURCE_JSONWRITER_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QScopedPointer>
+
+class QIODevice;
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class JsonWriterPrivate;
+class ServerInfo;
+class Player;
+
+/*
+ * Writes server information, rules and players as JSON directly into a byte
+ * array or an IO device without building QJsonObject trees. The produced
+ * objects use the same keys as ServerInfo::toJson() and Player::toJson(),
+ * without the old misspelled "modTye" key, writeServer() adds the rules and players as "rules" and "playerList" to the
+ * server information. In NDJson format every top level value is terminated by a new line.
+ */
+class QGSQ_LIBRARY JsonWriter
+{
+public:
+    enum Format : quint8 {
+        Compact = 0,
+        NDJson  = 1
+    };
+
+    explicit JsonWriter(QByteArray *buffer, Format format = Compact);
+
+    explicit JsonWriter(QIODevice *device, Format format = Compact);
+
+    ~JsonWriter();
+
+    Format format() const;
+
+    void beginArray();
+    void endArray();
+
+    void writeServerInfo(const ServerInfo *serverInfo);
+    void writeRules(const QHash<QString,QString> &rules);
+    void writePlayer(const Player *player);
+    void writePlayers(const QList<Player*> &players);
+    void writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players);
+    void writeBatch(const QList<ServerInfo*> &serverInfos);
+
+    bool flush();
+
+protected:
+    const QScopedPointer<JsonWriterPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(JsonWriter)
+    Q_DECLARE_PRIVATE(JsonWriter)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_JSONWRITER_H
@@ -0,0 +1,73 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_JSONWRITER_P_H
+#define QGSQ_VALVE_SOURCE_JSONWRITER_P_H
+
+#include "jsonwriter.h"
+#include "resultencoding_p.h"
+#include <QVarLengthArray>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class JsonWriterPrivate : public EncodingBuffer
+{
+public:
+    JsonWriterPrivate(QByteArray *_buffer, QIODevice *_device, JsonWriter::Format _format) :
+        EncodingBuffer(_buffer, _device), format(_format)
+    {}
+
+    static const bool Native64BitIntegers = false;
+
+    template<int N> inline void key(const char (&k)[N])
+    {
+        separator();
+        out->append('"');
+        out->append(k, N - 1);
+        out->append("\":", 2);
+        afterKey = true;
+    }
+
+    void dynamicKey(const QString &k);
+    void separator();
+    void beginMap(int size);
+    void endMap();
+    void beginArray(int size);
+    void endArray();
+    void value(const QString &str);
+    void value(const QByteArray &utf8);
+    void value(qint64 number);
+    void value(quint64 number);
+    void value(int number) { value(static_cast<qint64>(number)); }
+    void value(bool b);
+    void value(float number);
+    void endValue();
+
+    QVarLengthArray<bool, 8> first;
+    JsonWriter::Format format = JsonWriter::Compact;
+    bool afterKey = false;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_JSONWRITER_P_H
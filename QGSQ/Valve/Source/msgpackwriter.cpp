@@ -0,0 +1,269 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "msgpackwriter_p.h"
+#include <QtEndian>
+#include <cstring>
+
+using namespace QGSQ::Valve::Source;
+
+MsgPackWriter::MsgPackWriter(QByteArray *buffer) :
+    d_ptr(new MsgPackWriterPrivate(buffer, nullptr))
+{
+
+}
+
+MsgPackWriter::MsgPackWriter(QIODevice *device) :
+    d_ptr(new MsgPackWriterPrivate(nullptr, device))
+{
+
+}
+
+MsgPackWriter::~MsgPackWriter()
+{
+    flush();
+}
+
+void MsgPackWriter::beginArray(int count)
+{
+    Q_D(MsgPackWriter);
+    d->beginArray(count);
+}
+
+void MsgPackWriter::endArray()
+{
+    Q_D(MsgPackWriter);
+    d->endArray();
+}
+
+void MsgPackWriter::writeServerInfo(const ServerInfo *serverInfo)
+{
+    Q_D(MsgPackWriter);
+    Encoding::serverInfo(*d, serverInfo);
+}
+
+void MsgPackWriter::writeRules(const QHash<QString,QString> &rules)
+{
+    Q_D(MsgPackWriter);
+    Encoding::rules(*d, rules);
+}
+
+void MsgPackWriter::writePlayer(const Player *player)
+{
+    Q_D(MsgPackWriter);
+    Encoding::player(*d, player);
+}
+
+void MsgPackWriter::writePlayers(const QList<Player*> &players)
+{
+    Q_D(MsgPackWriter);
+    Encoding::players(*d, players);
+}
+
+void MsgPackWriter::writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players)
+{
+    Q_D(MsgPackWriter);
+    Encoding::server(*d, serverInfo, rules, players);
+}
+
+void MsgPackWriter::writeBatch(const QList<ServerInfo*> &serverInfos)
+{
+    Q_D(MsgPackWriter);
+    Encoding::batch(*d, serverInfos);
+}
+
+bool MsgPackWriter::flush()
+{
+    Q_D(MsgPackWriter);
+    return d->flush();
+}
+
+void MsgPackWriterPrivate::stringHead(int size)
+{
+    uchar h[5];
+    int hs = 1;
+    if (size < 32) {
+        h[0] = 0xa0 | static_cast<uchar>(size);
+    } else if (size <= 0xff) {
+        h[0] = 0xd9;
+        h[1] = static_cast<uchar>(size);
+        hs = 2;
+    } else if (size <= 0xffff) {
+        h[0] = 0xda;
+        qToBigEndian<quint16>(static_cast<quint16>(size), h + 1);
+        hs = 3;
+    } else {
+        h[0] = 0xdb;
+        qToBigEndian<quint32>(static_cast<quint32>(size), h + 1);
+        hs = 5;
+    }
+    out->append(reinterpret_cast<const char*>(h), hs);
+}
+
+int MsgPackWriterPrivate::containerHead(uchar *h, quint8 fix, quint8 marker16, int size)
+{
+    if (size < 16) {
+        h[0] = fix | static_cast<uchar>(size);
+        return 1;
+    } else if (size <= 0xffff) {
+        h[0] = marker16;
+        qToBigEndian<quint16>(static_cast<quint16>(size), h + 1);
+        return 3;
+    } else {
+        h[0] = marker16 + 1;
+        qToBigEndian<quint32>(static_cast<quint32>(size), h + 1);
+        return 5;
+    }
+}
+
+void MsgPackWriterPrivate::beginMap(int size)
+{
+    uchar h[5];
+    out->append(reinterpret_cast<const char*>(h), containerHead(h, 0x80, 0xde, qMax(size, 0)));
+    ++depth;
+}
+
+void MsgPackWriterPrivate::endMap()
+{
+    --depth;
+    endValue();
+}
+
+void MsgPackWriterPrivate::beginArray(int size)
+{
+    if (size < 0) {
+        // the header is inserted by endArray() when the element count is known,
+        // nothing is flushed while a container is open
+        counted.append({out->size(), depth + 1, 0});
+    } else {
+        uchar h[5];
+        out->append(reinterpret_cast<const char*>(h), containerHead(h, 0x90, 0xdc, size));
+    }
+    ++depth;
+}
+
+void MsgPackWriterPrivate::endArray()
+{
+    if (!counted.isEmpty() && (counted.last().depth == depth)) {
+        const CountedArray array = counted.last();
+        counted.removeLast();
+        uchar h[5];
+        out->insert(array.position, reinterpret_cast<const char*>(h), containerHead(h, 0x90, 0xdc, array.count));
+    }
+    --depth;
+    endValue();
+}
+
+void MsgPackWriterPrivate::value(const QString &str)
+{
+    value(str.toUtf8());
+}
+
+void MsgPackWriterPrivate::value(const QByteArray &utf8)
+{
+    stringHead(utf8.size());
+    out->append(utf8);
+    endValue();
+}
+
+void MsgPackWriterPrivate::value(qint64 number)
+{
+    if (number >= 0) {
+        value(static_cast<quint64>(number));
+        return;
+    }
+
+    uchar v[9];
+    int size = 1;
+    if (number >= -32) {
+        v[0] = static_cast<uchar>(static_cast<qint8>(number));
+    } else if (number >= -128) {
+        v[0] = 0xd0;
+        v[1] = static_cast<uchar>(static_cast<qint8>(number));
+        size = 2;
+    } else if (number >= -32768) {
+        v[0] = 0xd1;
+        qToBigEndian<qint16>(static_cast<qint16>(number), v + 1);
+        size = 3;
+    } else if (number >= Q_INT64_C(-2147483648)) {
+        v[0] = 0xd2;
+        qToBigEndian<qint32>(static_cast<qint32>(number), v + 1);
+        size = 5;
+    } else {
+        v[0] = 0xd3;
+        qToBigEndian<qint64>(number, v + 1);
+        size = 9;
+    }
+    out->append(reinterpret_cast<const char*>(v), size);
+    endValue();
+}
+
+void MsgPackWriterPrivate::value(quint64 number)
+{
+    uchar v[9];
+    int size = 1;
+    if (number < 128) {
+        v[0] = static_cast<uchar>(number);
+    } else if (number <= 0xff) {
+        v[0] = 0xcc;
+        v[1] = static_cast<uchar>(number);
+        size = 2;
+    } else if (number <= 0xffff) {
+        v[0] = 0xcd;
+        qToBigEndian<quint16>(static_cast<quint16>(number), v + 1);
+        size = 3;
+    } else if (number <= 0xffffffff) {
+        v[0] = 0xce;
+        qToBigEndian<quint32>(static_cast<quint32>(number), v + 1);
+        size = 5;
+    } else {
+        v[0] = 0xcf;
+        qToBigEndian<quint64>(number, v + 1);
+        size = 9;
+    }
+    out->append(reinterpret_cast<const char*>(v), size);
+    endValue();
+}
+
+void MsgPackWriterPrivate::value(bool b)
+{
+    out->append(static_cast<char>(b ? 0xc3 : 0xc2));
+    endValue();
+}
+
+void MsgPackWriterPrivate::value(float number)
+{
+    quint32 bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    uchar f[5];
+    f[0] = 0xca;
+    qToBigEndian<quint32>(bits, f + 1);
+    out->append(reinterpret_cast<const char*>(f), 5);
+    endValue();
+}
+
+void MsgPackWriterPrivate::endValue()
+{
+    if (!counted.isEmpty() && (counted.last().depth == depth)) {
+        ++counted.last().count;
+    }
+    if (depth == 0) {
+        maybeFlush();
+    }
+}
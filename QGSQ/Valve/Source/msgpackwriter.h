@@ -0,0 +1,79 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_MSGPACKWRITER_H
+#define QGSQ_VALVE_SOURCE_MSGPACKWRITER_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QScopedPointer>
+
+class QIODevice;
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class MsgPackWriterPrivate;
+class ServerInfo;
+class Player;
+
+/*
+ * Encodes server information, rules and players as MessagePack directly
+ * into a byte array or an IO device. Maps use the same keys as the JSON
+ * output, 64 bit ids are always encoded as unsigned integers. As MessagePack
+ * has no indefinite length containers, arrays started with a negative count
+ * are kept in memory until endArray() writes their element count.
+ */
+class QGSQ_LIBRARY MsgPackWriter
+{
+public:
+    explicit MsgPackWriter(QByteArray *buffer);
+
+    explicit MsgPackWriter(QIODevice *device);
+
+    ~MsgPackWriter();
+
+    void beginArray(int count = -1);
+    void endArray();
+
+    void writeServerInfo(const ServerInfo *serverInfo);
+    void writeRules(const QHash<QString,QString> &rules);
+    void writePlayer(const Player *player);
+    void writePlayers(const QList<Player*> &players);
+    void writeServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players);
+    void writeBatch(const QList<ServerInfo*> &serverInfos);
+
+    bool flush();
+
+protected:
+    const QScopedPointer<MsgPackWriterPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(MsgPackWriter)
+    Q_DECLARE_PRIVATE(MsgPackWriter)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_MSGPACKWRITER_H
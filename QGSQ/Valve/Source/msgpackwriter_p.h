@@ -0,0 +1,75 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_MSGPACKWRITER_P_H
+#define QGSQ_VALVE_SOURCE_MSGPACKWRITER_P_H
+
+#include "msgpackwriter.h"
+#include "resultencoding_p.h"
+#include <QVarLengthArray>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class MsgPackWriterPrivate : public EncodingBuffer
+{
+public:
+    MsgPackWriterPrivate(QByteArray *_buffer, QIODevice *_device) :
+        EncodingBuffer(_buffer, _device)
+    {}
+
+    static const bool Native64BitIntegers = true;
+
+    template<int N> inline void key(const char (&k)[N])
+    {
+        stringHead(N - 1);
+        out->append(k, N - 1);
+    }
+
+    void dynamicKey(const QString &k) { value(k); }
+    void stringHead(int size);
+    static int containerHead(uchar *h, quint8 fix, quint8 marker16, int size);
+    void beginMap(int size);
+    void endMap();
+    void beginArray(int size);
+    void endArray();
+    void value(const QString &str);
+    void value(const QByteArray &utf8);
+    void value(qint64 number);
+    void value(quint64 number);
+    void value(int number) { value(static_cast<qint64>(number)); }
+    void value(bool b);
+    void value(float number);
+    void endValue();
+
+    // arrays started without element count
+    struct CountedArray {
+        int position;
+        int depth;
+        int count;
+    };
+    QVarLengthArray<CountedArray, 4> counted;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_MSGPACKWRITER_P_H
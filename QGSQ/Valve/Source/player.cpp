@@ -18,6 +18,7 @@
  */
 
 #include "player_p.h"
+#include "a2slayout_p.h"
 #include <QDebug>
 #include <QJsonDocument>
 
@@ -72,10 +73,8 @@ void Player::setData(const QString &name, qint32 score, float duration)
 QJsonObject Player::toJson() const
 {
     QJsonObject o;
-    Q_D(const Player);
-    o.insert(QStringLiteral("name"), QJsonValue(d->name));
-    o.insert(QStringLiteral("score"), QJsonValue(d->score));
-    o.insert(QStringLiteral("duration"), QJsonValue(d->duration));
+    A2S::JsonPrinter printer(o);
+    A2S::PlayerEntry::visit(printer, this);
     return o;
 }
 
@@ -119,9 +118,8 @@ QDebug operator<<(QDebug dbg, const QGSQ::Valve::Source::Player *player)
         return dbg << QGSQ::Valve::Source::Player::staticMetaObject.className() << "(0x0)";
     }
     dbg.nospace() << player->metaObject()->className() << '(' << (const void*)player;
-    dbg << ", Name: " << player->name();
-    dbg << ", Score: " << player->score();
-    dbg << ", Duration: " << player->duration();
+    QGSQ::Valve::Source::A2S::DebugPrinter printer(dbg);
+    QGSQ::Valve::Source::A2S::PlayerEntry::visit(printer, player);
     dbg << ')';
     return dbg.maybeSpace();
 }
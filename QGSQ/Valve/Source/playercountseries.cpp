@@ -0,0 +1,217 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "playercountseries_p.h"
+#include "infofilter_p.h"
+#include "serverinfo.h"
+#include "serverquery.h"
+#include <QDateTime>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(SPCS, "qgsq.valve.source.playercountseries")
+
+using namespace QGSQ::Valve::Source;
+
+PlayerCountSeries::PlayerCountSeries(QObject *parent) :
+    PlayerCountSeries(1440, 1440, 720, 365, parent)
+{
+
+}
+
+PlayerCountSeries::PlayerCountSeries(int rawCapacity, int minutes, int hours, int days, QObject *parent) :
+    QObject(parent), d_ptr(new PlayerCountSeriesPrivate)
+{
+    Q_D(PlayerCountSeries);
+    d->levels[Raw].setCapacity(rawCapacity);
+    d->levels[Minute].setCapacity(minutes);
+    d->levels[Hour].setCapacity(hours);
+    d->levels[Day].setCapacity(days);
+}
+
+PlayerCountSeries::~PlayerCountSeries()
+{
+
+}
+
+void PlayerCountSeries::track(ServerQuery *query)
+{
+    if (Q_UNLIKELY(!query)) {
+        return;
+    }
+
+    connect(query, &ServerQuery::gotRawInfo, this, [this](const QByteArray &data){
+        if (!data.isEmpty()) {
+            addRawInfo(data);
+        }
+    });
+}
+
+void PlayerCountSeries::addSample(qint64 timestamp, quint8 players, quint8 maxPlayers, quint8 bots)
+{
+    Q_D(PlayerCountSeries);
+    QWriteLocker locker(&d->lock);
+
+    if (Q_UNLIKELY(timestamp < d->newest)) {
+        qCDebug(SPCS, "Dropping sample at %lli, it is older than the newest sample at %lli.", timestamp, d->newest);
+        return;
+    }
+    d->newest = timestamp;
+
+    d->levels[Raw].push(timestamp).add(players, maxPlayers, bots);
+
+    for (int level = Minute; level < QGSQ_SERIES_LEVELS; ++level) {
+        SeriesRing &ring = d->levels[level];
+        const qint64 width = PlayerCountSeriesPrivate::bucketWidth(static_cast<Resolution>(level));
+        const qint64 start = timestamp - (timestamp % width);
+        if (ring.isEmpty() || (ring.last().start != start)) {
+            ring.push(start);
+        }
+        ring.last().add(players, maxPlayers, bots);
+    }
+}
+
+void PlayerCountSeries::addSample(const ServerInfo *serverInfo)
+{
+    if (Q_LIKELY(serverInfo)) {
+        addSample(QDateTime::currentMSecsSinceEpoch(), serverInfo->players(), serverInfo->maxPlayers(), serverInfo->bots());
+    }
+}
+
+bool PlayerCountSeries::addRawInfo(const QByteArray &rawInfo)
+{
+    // only the fixed fields are needed, no ServerInfo has to be created
+    RawInfoFields fields;
+    if (Q_UNLIKELY(!InfoFilterPrivate::scan(rawInfo, &fields, false))) {
+        qCWarning(SPCS, "Ignoring invalid A2S_INFO reply of %i bytes.", rawInfo.size());
+        return false;
+    }
+    addSample(QDateTime::currentMSecsSinceEpoch(), fields.players, fields.maxPlayers, fields.bots);
+    return true;
+}
+
+int PlayerCountSeries::size(Resolution resolution) const
+{
+    Q_D(const PlayerCountSeries);
+    QReadLocker locker(&d->lock);
+    return d->levels[resolution].size();
+}
+
+int PlayerCountSeries::capacity(Resolution resolution) const
+{
+    Q_D(const PlayerCountSeries);
+    QReadLocker locker(&d->lock);
+    return d->levels[resolution].capacity();
+}
+
+qint64 PlayerCountSeries::oldest(Resolution resolution) const
+{
+    Q_D(const PlayerCountSeries);
+    QReadLocker locker(&d->lock);
+    const SeriesRing &ring = d->levels[resolution];
+    return ring.isEmpty() ? -1 : ring.at(0).start;
+}
+
+qint64 PlayerCountSeries::newest() const
+{
+    Q_D(const PlayerCountSeries);
+    QReadLocker locker(&d->lock);
+    return d->newest;
+}
+
+QVector<PlayerCountSeries::Point> PlayerCountSeries::points(Resolution resolution, qint64 from, qint64 to) const
+{
+    Q_D(const PlayerCountSeries);
+    QVector<Point> lst;
+
+    QReadLocker locker(&d->lock);
+
+    const SeriesRing &ring = d->levels[resolution];
+    const qint64 width = PlayerCountSeriesPrivate::bucketWidth(resolution);
+    // the bucket containing from is part of the range
+    const qint64 first = (width > 0) ? (from - (from % width)) : from;
+
+    int i = ring.lowerBound(first);
+    lst.reserve(ring.size() - i);
+    for (; i < ring.size(); ++i) {
+        const SeriesBucket &b = ring.at(i);
+        if ((to >= 0) && (b.start > to)) {
+            break;
+        }
+        Point p;
+        p.timestamp = b.start;
+        p.samples = b.samples;
+        p.playersAvg = b.samples ? static_cast<float>(b.playersSum) / static_cast<float>(b.samples) : 0.0f;
+        p.botsAvg = b.samples ? static_cast<float>(b.botsSum) / static_cast<float>(b.samples) : 0.0f;
+        p.playersMin = b.playersMin;
+        p.playersMax = b.playersMax;
+        p.botsMin = b.botsMin;
+        p.botsMax = b.botsMax;
+        p.maxPlayers = b.maxPlayers;
+        lst.append(p);
+    }
+
+    return lst;
+}
+
+PlayerCountSeries::Resolution PlayerCountSeries::resolutionFor(qint64 from) const
+{
+    Q_D(const PlayerCountSeries);
+    QReadLocker locker(&d->lock);
+
+    // the finest level that still reaches back far enough
+    for (int level = Raw; level < Day; ++level) {
+        const SeriesRing &ring = d->levels[level];
+        if (!ring.isEmpty() && ((ring.size() < ring.capacity()) || (ring.at(0).start <= from))) {
+            return static_cast<Resolution>(level);
+        }
+    }
+    return Day;
+}
+
+QVector<PlayerCountSeries::Point> PlayerCountSeries::history(qint64 msecs) const
+{
+    const qint64 from = QDateTime::currentMSecsSinceEpoch() - msecs;
+    return points(resolutionFor(from), from);
+}
+
+void PlayerCountSeries::clear()
+{
+    Q_D(PlayerCountSeries);
+    QWriteLocker locker(&d->lock);
+    for (SeriesRing &ring : d->levels) {
+        ring.clear();
+    }
+    d->newest = -1;
+}
+
+qint64 PlayerCountSeriesPrivate::bucketWidth(PlayerCountSeries::Resolution resolution)
+{
+    switch (resolution) {
+    case PlayerCountSeries::Minute:
+        return Q_INT64_C(60000);
+    case PlayerCountSeries::Hour:
+        return Q_INT64_C(3600000);
+    case PlayerCountSeries::Day:
+        return Q_INT64_C(86400000);
+    default:
+        return 0;
+    }
+}
+
+#include "moc_playercountseries.cpp"
@@ -0,0 +1,104 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_H
+#define QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_H
+
+#include "qgsq_global.h"
+#include <QObject>
+#include <QVector>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class PlayerCountSeriesPrivate;
+class ServerInfo;
+class ServerQuery;
+
+/*
+ * Fixed memory time series of the player, slot and bot counts of one server.
+ * Raw samples are kept in a ring buffer, on every sample they are also rolled
+ * up into minute, hour and day buckets with min, max and average, each level
+ * in its own ring buffer. By default the rollups cover one day of minutes,
+ * 30 days of hours and a year of days. Samples have to arrive in order, older
+ * samples than the newest one are dropped. All methods are thread safe.
+ */
+class QGSQ_LIBRARY PlayerCountSeries : public QObject
+{
+    Q_OBJECT
+public:
+    enum Resolution : quint8 {
+        Raw     = 0,
+        Minute  = 1,
+        Hour    = 2,
+        Day     = 3
+    };
+    Q_ENUM(Resolution)
+
+    struct Point {
+        qint64 timestamp = 0;
+        float playersAvg = 0.0f;
+        float botsAvg = 0.0f;
+        quint32 samples = 0;
+        quint8 playersMin = 0;
+        quint8 playersMax = 0;
+        quint8 botsMin = 0;
+        quint8 botsMax = 0;
+        quint8 maxPlayers = 0;
+    };
+
+    explicit PlayerCountSeries(QObject *parent = nullptr);
+
+    PlayerCountSeries(int rawCapacity, int minutes, int hours, int days, QObject *parent = nullptr);
+
+    ~PlayerCountSeries();
+
+    void track(ServerQuery *query);
+
+    void addSample(qint64 timestamp, quint8 players, quint8 maxPlayers, quint8 bots);
+    void addSample(const ServerInfo *serverInfo);
+    bool addRawInfo(const QByteArray &rawInfo);
+
+    int size(Resolution resolution) const;
+    int capacity(Resolution resolution) const;
+    qint64 oldest(Resolution resolution) const;
+    qint64 newest() const;
+
+    QVector<Point> points(Resolution resolution, qint64 from, qint64 to = -1) const;
+    Resolution resolutionFor(qint64 from) const;
+    QVector<Point> history(qint64 msecs) const;
+
+    void clear();
+
+protected:
+    const QScopedPointer<PlayerCountSeriesPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(PlayerCountSeries)
+    Q_DECLARE_PRIVATE(PlayerCountSeries)
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::PlayerCountSeries::Point, Q_PRIMITIVE_TYPE);
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_H
@@ -0,0 +1,145 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_P_H
+#define QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_P_H
+
+#include "playercountseries.h"
+#include <QReadWriteLock>
+
+#define QGSQ_SERIES_LEVELS 4
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Aggregated samples of one time bucket. Raw samples are stored as buckets
+ * with a single sample, so all levels share one type.
+ */
+struct SeriesBucket
+{
+    qint64 start = 0;
+    quint32 samples = 0;
+    quint32 playersSum = 0;
+    quint32 botsSum = 0;
+    quint8 playersMin = 0;
+    quint8 playersMax = 0;
+    quint8 botsMin = 0;
+    quint8 botsMax = 0;
+    quint8 maxPlayers = 0;
+
+    void add(quint8 players, quint8 _maxPlayers, quint8 bots)
+    {
+        if (samples == 0) {
+            playersMin = playersMax = players;
+            botsMin = botsMax = bots;
+        } else {
+            playersMin = qMin(playersMin, players);
+            playersMax = qMax(playersMax, players);
+            botsMin = qMin(botsMin, bots);
+            botsMax = qMax(botsMax, bots);
+        }
+        maxPlayers = qMax(maxPlayers, _maxPlayers);
+        playersSum += players;
+        botsSum += bots;
+        ++samples;
+    }
+};
+
+/*
+ * Ring buffer with a capacity fixed at construction, index 0 is the oldest
+ * element. Once full, pushing overwrites the oldest element.
+ */
+class SeriesRing
+{
+public:
+    void setCapacity(int capacity)
+    {
+        data.resize(qMax(1, capacity));
+        head = 0;
+        count = 0;
+    }
+
+    int capacity() const { return data.size(); }
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    const SeriesBucket &at(int i) const { return data.at((head + i) % data.size()); }
+    SeriesBucket &last() { return data[(head + count - 1) % data.size()]; }
+    const SeriesBucket &last() const { return data.at((head + count - 1) % data.size()); }
+
+    SeriesBucket &push(qint64 start)
+    {
+        if (count < data.size()) {
+            ++count;
+        } else {
+            head = (head + 1) % data.size();
+        }
+        SeriesBucket &b = last();
+        b = SeriesBucket();
+        b.start = start;
+        return b;
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    // index of the first bucket starting at or after timestamp
+    int lowerBound(qint64 timestamp) const
+    {
+        int lo = 0;
+        int hi = count;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (at(mid).start < timestamp) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+private:
+    QVector<SeriesBucket> data;
+    int head = 0;
+    int count = 0;
+};
+
+class PlayerCountSeriesPrivate
+{
+public:
+    static qint64 bucketWidth(PlayerCountSeries::Resolution resolution);
+
+    mutable QReadWriteLock lock;
+    SeriesRing levels[QGSQ_SERIES_LEVELS];
+    qint64 newest = -1;
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::SeriesBucket, Q_PRIMITIVE_TYPE);
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERCOUNTSERIES_P_H
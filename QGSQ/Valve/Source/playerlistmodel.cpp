@@ -0,0 +1,297 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "playerlistmodel_p.h"
+#include "player.h"
+#include "serverquery.h"
+#include <algorithm>
+
+using namespace QGSQ::Valve::Source;
+
+PlayerListModel::PlayerListModel(QObject *parent) : QAbstractListModel(parent), d_ptr(new PlayerListModelPrivate)
+{
+    Q_D(PlayerListModel);
+    d->q_ptr = this;
+    d->tracker = new PlayerTracker(this);
+    connect(d->tracker, &PlayerTracker::playerLeft, this, [d](const PlayerTracker::Session &session){
+        d->left.append(session.id);
+    });
+    connect(d->tracker, &PlayerTracker::playerJoined, this, [d](const PlayerTracker::Session &session){
+        d->joined.append(session);
+    });
+}
+
+PlayerListModel::~PlayerListModel()
+{
+
+}
+
+int PlayerListModel::rowCount(const QModelIndex &parent) const
+{
+    Q_D(const PlayerListModel);
+    return parent.isValid() ? 0 : d->rows.size();
+}
+
+QVariant PlayerListModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const PlayerListModel);
+    if (Q_UNLIKELY(!index.isValid() || (index.row() >= d->rows.size()))) {
+        return QVariant();
+    }
+
+    const PlayerListModelPrivate::Row &r = d->rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return r.player->name();
+    case ScoreRole:
+        return r.player->score();
+    case DurationRole:
+        return r.player->duration();
+    case SessionIdRole:
+        return r.id;
+    case JoinedRole:
+        return r.joined;
+    case PlayerRole:
+        return QVariant::fromValue<QObject*>(r.player);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int,QByteArray> PlayerListModel::roleNames() const
+{
+    static const QHash<int,QByteArray> names({
+        {NameRole, QByteArrayLiteral("name")},
+        {ScoreRole, QByteArrayLiteral("score")},
+        {DurationRole, QByteArrayLiteral("duration")},
+        {SessionIdRole, QByteArrayLiteral("sessionId")},
+        {JoinedRole, QByteArrayLiteral("joined")},
+        {PlayerRole, QByteArrayLiteral("player")}
+    });
+    return names;
+}
+
+int PlayerListModel::count() const
+{
+    Q_D(const PlayerListModel);
+    return d->rows.size();
+}
+
+int PlayerListModel::poolSize() const
+{
+    Q_D(const PlayerListModel);
+    return d->poolSize;
+}
+
+void PlayerListModel::setPoolSize(int poolSize)
+{
+    Q_D(PlayerListModel);
+    poolSize = qMax(0, poolSize);
+    if (d->poolSize != poolSize) {
+        d->poolSize = poolSize;
+        while (d->pool.size() > poolSize) {
+            delete d->pool.takeLast();
+        }
+        Q_EMIT poolSizeChanged(poolSize);
+    }
+}
+
+Player *PlayerListModel::player(int row) const
+{
+    Q_D(const PlayerListModel);
+    return ((row >= 0) && (row < d->rows.size())) ? d->rows.at(row).player : nullptr;
+}
+
+PlayerTracker *PlayerListModel::tracker() const
+{
+    Q_D(const PlayerListModel);
+    return d->tracker;
+}
+
+void PlayerListModel::track(ServerQuery *query)
+{
+    if (Q_UNLIKELY(!query)) {
+        return;
+    }
+
+    connect(query, &ServerQuery::gotRawPlayers, this, [this](const QByteArray &data){
+        if (!data.isEmpty()) {
+            update(data);
+        }
+    });
+}
+
+bool PlayerListModel::update(const QByteArray &rawPlayers)
+{
+    Q_D(PlayerListModel);
+    d->left.resize(0);
+    d->joined.resize(0);
+    if (!d->tracker->update(rawPlayers)) {
+        return false;
+    }
+    d->apply();
+    return true;
+}
+
+void PlayerListModel::update(const QList<Player*> &players)
+{
+    Q_D(PlayerListModel);
+    d->left.resize(0);
+    d->joined.resize(0);
+    d->tracker->update(players);
+    d->apply();
+}
+
+void PlayerListModel::clear()
+{
+    Q_D(PlayerListModel);
+    const bool hadRows = !d->rows.isEmpty();
+    if (hadRows) {
+        beginResetModel();
+        for (const PlayerListModelPrivate::Row &r : d->rows) {
+            d->recycle(r.player);
+        }
+        d->rows.clear();
+        d->rowById.clear();
+    }
+    d->tracker->blockSignals(true);
+    d->tracker->reset();
+    d->tracker->blockSignals(false);
+    if (hadRows) {
+        endResetModel();
+        Q_EMIT countChanged(0);
+    }
+}
+
+Player *PlayerListModelPrivate::acquire()
+{
+    Q_Q(PlayerListModel);
+    return pool.isEmpty() ? new Player(q) : pool.takeLast();
+}
+
+void PlayerListModelPrivate::recycle(Player *player)
+{
+    if (pool.size() < poolSize) {
+        pool.append(player);
+    } else {
+        delete player;
+    }
+}
+
+void PlayerListModelPrivate::apply()
+{
+    Q_Q(PlayerListModel);
+    const int previousCount = rows.size();
+
+    // left players, adjacent rows are removed together, from the back so rows stay valid
+    if (!left.isEmpty()) {
+        QVector<int> removed;
+        removed.reserve(left.size());
+        for (quint32 id : left) {
+            const int r = rowById.value(id, -1);
+            if (r >= 0) {
+                rowById.remove(id);
+                removed.append(r);
+            }
+        }
+        std::sort(removed.begin(), removed.end());
+        int i = removed.size() - 1;
+        while (i >= 0) {
+            const int last = removed.at(i);
+            int first = last;
+            while ((i > 0) && (removed.at(i - 1) == first - 1)) {
+                --i;
+                first = removed.at(i);
+            }
+            --i;
+            q->beginRemoveRows(QModelIndex(), first, last);
+            for (int r = first; r <= last; ++r) {
+                recycle(rows.at(r).player);
+            }
+            rows.remove(first, last - first + 1);
+            q->endRemoveRows();
+        }
+        if (!removed.isEmpty()) {
+            reindex(removed.first());
+        }
+    }
+
+    // connected players are updated in place, all changed rows are reported in one range
+    int firstChanged = -1;
+    int lastChanged = -1;
+    bool scores = false;
+    bool durations = false;
+    const QVector<PlayerTracker::Session> sessions = tracker->sessions();
+    for (const PlayerTracker::Session &s : sessions) {
+        const int r = rowById.value(s.id, -1);
+        if (r < 0) {
+            continue;
+        }
+        Player *p = rows.at(r).player;
+        const bool scoreChanged = (p->score() != s.score);
+        const bool durationChanged = (p->duration() != s.duration);
+        if (!scoreChanged && !durationChanged) {
+            continue;
+        }
+        p->setData(s.name, s.score, s.duration);
+        scores |= scoreChanged;
+        durations |= durationChanged;
+        firstChanged = (firstChanged < 0) ? r : qMin(firstChanged, r);
+        lastChanged = qMax(lastChanged, r);
+    }
+    if (firstChanged >= 0) {
+        QVector<int> roles;
+        if (scores) {
+            roles.append(PlayerListModel::ScoreRole);
+        }
+        if (durations) {
+            roles.append(PlayerListModel::DurationRole);
+        }
+        Q_EMIT q->dataChanged(q->index(firstChanged), q->index(lastChanged), roles);
+    }
+
+    if (!joined.isEmpty()) {
+        const int first = rows.size();
+        q->beginInsertRows(QModelIndex(), first, first + joined.size() - 1);
+        for (const PlayerTracker::Session &s : joined) {
+            PlayerListModelPrivate::Row r;
+            r.player = acquire();
+            r.player->setData(s.name, s.score, s.duration);
+            r.joined = s.joined;
+            r.id = s.id;
+            rows.append(r);
+        }
+        reindex(first);
+        q->endInsertRows();
+    }
+
+    if (rows.size() != previousCount) {
+        Q_EMIT q->countChanged(rows.size());
+    }
+}
+
+void PlayerListModelPrivate::reindex(int from)
+{
+    for (int i = from; i < rows.size(); ++i) {
+        rowById.insert(rows.at(i).id, i);
+    }
+}
+
+#include "moc_playerlistmodel.cpp"
@@ -0,0 +1,97 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_H
+#define QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_H
+
+#include "qgsq_global.h"
+#include <QAbstractListModel>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class PlayerListModelPrivate;
+class PlayerTracker;
+class ServerQuery;
+class Player;
+
+/*
+ * Scoreboard model of the players of one server. Consecutive A2S_PLAYER
+ * replies are matched with a PlayerTracker, so rows of connected players are
+ * updated in place through Player::setData(), only joined and left players
+ * are inserted and removed. Player objects of removed rows are kept in a
+ * pool and reused for joining players.
+ */
+class QGSQ_LIBRARY PlayerListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int poolSize READ poolSize WRITE setPoolSize NOTIFY poolSizeChanged)
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        ScoreRole,
+        DurationRole,
+        SessionIdRole,
+        JoinedRole,
+        PlayerRole
+    };
+    Q_ENUM(Roles)
+
+    explicit PlayerListModel(QObject *parent = nullptr);
+
+    ~PlayerListModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int,QByteArray> roleNames() const override;
+
+    int count() const;
+
+    int poolSize() const;
+    void setPoolSize(int poolSize);
+
+    Q_INVOKABLE QGSQ::Valve::Source::Player *player(int row) const;
+    PlayerTracker *tracker() const;
+
+    void track(ServerQuery *query);
+
+    bool update(const QByteArray &rawPlayers);
+    void update(const QList<Player*> &players);
+
+    Q_INVOKABLE void clear();
+
+Q_SIGNALS:
+    void countChanged(int count);
+    void poolSizeChanged(int poolSize);
+
+protected:
+    const QScopedPointer<PlayerListModelPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(PlayerListModel)
+    Q_DECLARE_PRIVATE(PlayerListModel)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_H
@@ -0,0 +1,63 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_P_H
+#define QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_P_H
+
+#include "playerlistmodel.h"
+#include "playertracker.h"
+#include <QHash>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class PlayerListModelPrivate
+{
+public:
+    struct Row {
+        Player *player = nullptr;
+        qint64 joined = 0;
+        quint32 id = 0;
+    };
+
+    Player *acquire();
+    void recycle(Player *player);
+    void apply();
+    void reindex(int from);
+
+    Q_DECLARE_PUBLIC(PlayerListModel)
+    PlayerListModel *q_ptr = nullptr;
+    PlayerTracker *tracker = nullptr;
+    QVector<Row> rows;
+    QHash<quint32,int> rowById;
+    QVector<Player*> pool;
+    // collected while the tracker processes a reply
+    QVector<quint32> left;
+    QVector<PlayerTracker::Session> joined;
+    int poolSize = 64;
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::PlayerListModelPrivate::Row, Q_PRIMITIVE_TYPE);
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERLISTMODEL_P_H
@@ -0,0 +1,310 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "playertracker_p.h"
+#include "serverquery.h"
+#include "player.h"
+#include <QDateTime>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(SPT, "qgsq.valve.source.playertracker")
+
+using namespace QGSQ::Valve::Source;
+
+PlayerTracker::PlayerTracker(QObject *parent) : QObject(parent), d_ptr(new PlayerTrackerPrivate)
+{
+    Q_D(PlayerTracker);
+    d->q_ptr = this;
+}
+
+PlayerTracker::~PlayerTracker()
+{
+
+}
+
+void PlayerTracker::track(ServerQuery *query)
+{
+    if (Q_UNLIKELY(!query)) {
+        return;
+    }
+
+    connect(query, &ServerQuery::gotRawPlayers, this, [this](const QByteArray &data){
+        if (!data.isEmpty()) {
+            update(data);
+        }
+    });
+}
+
+bool PlayerTracker::update(const QByteArray &rawPlayers)
+{
+    Q_D(PlayerTracker);
+    if (Q_UNLIKELY(!d->parse(rawPlayers))) {
+        qCWarning(SPT, "Ignoring invalid A2S_PLAYER reply of %i bytes.", rawPlayers.size());
+        return false;
+    }
+    d->apply();
+    return true;
+}
+
+void PlayerTracker::update(const QList<Player*> &players)
+{
+    Q_D(PlayerTracker);
+
+    QVector<QByteArray> names;
+    names.reserve(players.size());
+    d->reply.resize(0);
+    for (const Player *p : players) {
+        if (Q_UNLIKELY(!p)) {
+            continue;
+        }
+        names.append(p->name().toUtf8());
+        PlayerTrackerPrivate::RawPlayer rp;
+        rp.name = names.last().constData();
+        rp.nameSize = names.last().size();
+        rp.score = p->score();
+        rp.duration = p->duration();
+        d->reply.append(rp);
+    }
+
+    d->apply();
+}
+
+int PlayerTracker::players() const
+{
+    Q_D(const PlayerTracker);
+    return d->tracked.size();
+}
+
+QVector<PlayerTracker::Session> PlayerTracker::sessions() const
+{
+    Q_D(const PlayerTracker);
+    QVector<Session> lst;
+    lst.reserve(d->tracked.size());
+    for (const PlayerTrackerPrivate::Tracked &t : d->tracked) {
+        lst.append(t.session);
+    }
+    return lst;
+}
+
+PlayerTracker::Session PlayerTracker::session(quint32 id) const
+{
+    Q_D(const PlayerTracker);
+    for (const PlayerTrackerPrivate::Tracked &t : d->tracked) {
+        if (t.session.id == id) {
+            return t.session;
+        }
+    }
+    return Session();
+}
+
+quint64 PlayerTracker::totalJoins() const
+{
+    Q_D(const PlayerTracker);
+    return d->totalJoins;
+}
+
+quint64 PlayerTracker::totalLeaves() const
+{
+    Q_D(const PlayerTracker);
+    return d->totalLeaves;
+}
+
+qint64 PlayerTracker::totalPlayTime() const
+{
+    Q_D(const PlayerTracker);
+    return d->totalPlayTime;
+}
+
+float PlayerTracker::durationTolerance() const
+{
+    Q_D(const PlayerTracker);
+    return d->tolerance;
+}
+
+void PlayerTracker::setDurationTolerance(float seconds)
+{
+    Q_D(PlayerTracker);
+    d->tolerance = qMax(0.0f, seconds);
+}
+
+void PlayerTracker::reset()
+{
+    Q_D(PlayerTracker);
+    const bool changed = !d->tracked.isEmpty();
+    d->tracked.clear();
+    d->byName.clear();
+    d->clock.invalidate();
+    d->totalJoins = 0;
+    d->totalLeaves = 0;
+    d->totalPlayTime = 0;
+    if (changed) {
+        Q_EMIT playersChanged(0);
+    }
+}
+
+bool PlayerTrackerPrivate::parse(const QByteArray &data)
+{
+    reply.resize(0);
+
+    A2S::Scanner s(data);
+    const char header = s.getCharacter();
+    const auto count = s.get<quint8>();
+    if (Q_UNLIKELY(s.hasError() || (header != 'D'))) {
+        return false;
+    }
+
+    reply.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        RawPlayer rp;
+        A2S::PlayerEntry::scan(&rp, s);
+        if (Q_UNLIKELY(s.hasError())) {
+            return false;
+        }
+        reply.append(rp);
+    }
+
+    return true;
+}
+
+void PlayerTrackerPrivate::apply()
+{
+    Q_Q(PlayerTracker);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    float elapsed = 0.0f;
+    if (clock.isValid()) {
+        elapsed = static_cast<float>(clock.restart()) / 1000.0f;
+    } else {
+        clock.start();
+    }
+    const int previousCount = tracked.size();
+
+    for (Tracked &t : tracked) {
+        t.matched = false;
+        t.delta = 0;
+    }
+    joined.resize(0);
+
+    // match every player to the session of the same name whose duration advanced the most plausible way
+    bool scoresChanged = false;
+    for (int i = 0; i < reply.size(); ++i) {
+        const RawPlayer &p = reply.at(i);
+        const QByteArray key = QByteArray::fromRawData(p.name, p.nameSize);
+        int best = -1;
+        float bestDiff = 0.0f;
+        for (auto it = byName.constFind(key); (it != byName.constEnd()) && (it.key() == key); ++it) {
+            const Tracked &t = tracked.at(it.value());
+            if (t.matched || ((p.duration + tolerance) < t.session.duration)) {
+                continue;
+            }
+            const float diff = qAbs(p.duration - (t.session.duration + elapsed));
+            if ((best < 0) || (diff < bestDiff)) {
+                best = it.value();
+                bestDiff = diff;
+            }
+        }
+
+        if (best < 0) {
+            joined.append(i);
+            continue;
+        }
+
+        Tracked &t = tracked[best];
+        t.matched = true;
+        t.session.duration = p.duration;
+        t.session.lastSeen = now;
+        if (t.session.score != p.score) {
+            t.delta = p.score - t.session.score;
+            t.session.score = p.score;
+            ++t.session.scoreChanges;
+            scoresChanged = true;
+        }
+    }
+
+    QVector<PlayerTracker::Session> left;
+    int kept = 0;
+    for (int i = 0; i < tracked.size(); ++i) {
+        if (!tracked.at(i).matched) {
+            const PlayerTracker::Session &s = tracked.at(i).session;
+            ++totalLeaves;
+            totalPlayTime += static_cast<qint64>(s.duration * 1000.0f);
+            left.append(s);
+            continue;
+        }
+        if (kept != i) {
+            tracked[kept] = tracked.at(i);
+        }
+        ++kept;
+    }
+    tracked.resize(kept);
+
+    const int firstJoined = tracked.size();
+    for (int i : joined) {
+        const RawPlayer &p = reply.at(i);
+        Tracked t;
+        t.rawName = QByteArray(p.name, p.nameSize);
+        t.session.name = QString::fromUtf8(p.name, p.nameSize);
+        t.session.joined = now - static_cast<qint64>(p.duration * 1000.0f);
+        t.session.lastSeen = now;
+        t.session.duration = p.duration;
+        t.session.score = p.score;
+        t.session.initialScore = p.score;
+        t.session.id = nextId++;
+        t.matched = true;
+        tracked.append(t);
+        ++totalJoins;
+    }
+
+    // slots may query the tracker, so events are only sent once the state is complete
+    if (!left.isEmpty() || !joined.isEmpty()) {
+        rebuildIndex();
+    }
+
+    for (const PlayerTracker::Session &s : left) {
+        Q_EMIT q->playerLeft(s);
+    }
+
+    for (int i = firstJoined; i < tracked.size(); ++i) {
+        Q_EMIT q->playerJoined(tracked.at(i).session);
+    }
+
+    if (scoresChanged) {
+        for (int i = 0; i < qMin(firstJoined, tracked.size()); ++i) {
+            const Tracked &t = tracked.at(i);
+            if (t.delta != 0) {
+                Q_EMIT q->scoreChanged(t.session.id, t.session.score, t.delta);
+            }
+        }
+    }
+
+    if (tracked.size() != previousCount) {
+        Q_EMIT q->playersChanged(tracked.size());
+    }
+}
+
+void PlayerTrackerPrivate::rebuildIndex()
+{
+    byName.clear();
+    byName.reserve(tracked.size());
+    for (int i = 0; i < tracked.size(); ++i) {
+        byName.insert(tracked.at(i).rawName, i);
+    }
+}
+
+#include "moc_playertracker.cpp"
@@ -0,0 +1,104 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERTRACKER_H
+#define QGSQ_VALVE_SOURCE_PLAYERTRACKER_H
+
+#include "qgsq_global.h"
+#include <QObject>
+#include <QVector>
+#include <QList>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class PlayerTrackerPrivate;
+class ServerQuery;
+class Player;
+
+/*
+ * Follows the players of one server across consecutive A2S_PLAYER replies.
+ * Players are matched by name, duplicate names are told apart by their
+ * connection duration, which has to grow monotonically; a player whose
+ * duration went backwards reconnected. Raw replies are scanned in place,
+ * names are only decoded when a player joins, so steady state updates do
+ * not allocate. Every session gets an id that stays the same while the
+ * player is connected.
+ */
+class QGSQ_LIBRARY PlayerTracker : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int players READ players NOTIFY playersChanged)
+public:
+    struct Session {
+        QString name;
+        qint64 joined = 0;
+        qint64 lastSeen = 0;
+        float duration = 0.0f;
+        qint32 score = 0;
+        qint32 initialScore = 0;
+        quint32 scoreChanges = 0;
+        quint32 id = 0;
+    };
+
+    explicit PlayerTracker(QObject *parent = nullptr);
+
+    ~PlayerTracker();
+
+    void track(ServerQuery *query);
+
+    bool update(const QByteArray &rawPlayers);
+    void update(const QList<Player*> &players);
+
+    int players() const;
+    QVector<Session> sessions() const;
+    Session session(quint32 id) const;
+
+    quint64 totalJoins() const;
+    quint64 totalLeaves() const;
+    qint64 totalPlayTime() const;
+
+    float durationTolerance() const;
+    void setDurationTolerance(float seconds);
+
+    void reset();
+
+Q_SIGNALS:
+    void playerJoined(const QGSQ::Valve::Source::PlayerTracker::Session &session);
+    void playerLeft(const QGSQ::Valve::Source::PlayerTracker::Session &session);
+    void scoreChanged(quint32 id, qint32 score, qint32 delta);
+    void playersChanged(int players);
+
+protected:
+    const QScopedPointer<PlayerTrackerPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(PlayerTracker)
+    Q_DECLARE_PRIVATE(PlayerTracker)
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::PlayerTracker::Session, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(QGSQ::Valve::Source::PlayerTracker::Session)
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERTRACKER_H
@@ -0,0 +1,79 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_PLAYERTRACKER_P_H
+#define QGSQ_VALVE_SOURCE_PLAYERTRACKER_P_H
+
+#include "playertracker.h"
+#include "a2slayout_p.h"
+#include <QMultiHash>
+#include <QElapsedTimer>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class PlayerTrackerPrivate
+{
+public:
+    // player entry of a reply, scanned with the A2S layout, the name points into the reply
+    struct RawPlayer {
+        void store(A2S::NameKey, const A2S::Span &value) { name = value.data; nameSize = value.size; }
+        void store(A2S::ScoreKey, qint32 value) { score = value; }
+        void store(A2S::DurationKey, float value) { duration = value; }
+
+        const char *name = nullptr;
+        int nameSize = 0;
+        qint32 score = 0;
+        float duration = 0.0f;
+    };
+
+    struct Tracked {
+        PlayerTracker::Session session;
+        QByteArray rawName;
+        qint32 delta = 0;
+        bool matched = false;
+    };
+
+    bool parse(const QByteArray &data);
+    void apply();
+    void rebuildIndex();
+
+    Q_DECLARE_PUBLIC(PlayerTracker)
+    PlayerTracker *q_ptr = nullptr;
+    QVector<Tracked> tracked;
+    QMultiHash<QByteArray,int> byName;
+    QVector<RawPlayer> reply;
+    QVector<int> joined;
+    QElapsedTimer clock;
+    quint64 totalJoins = 0;
+    quint64 totalLeaves = 0;
+    qint64 totalPlayTime = 0;
+    float tolerance = 5.0f;
+    quint32 nextId = 1;
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::PlayerTrackerPrivate::RawPlayer, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::PlayerTrackerPrivate::Tracked, Q_MOVABLE_TYPE);
+
+#endif // QGSQ_VALVE_SOURCE_PLAYERTRACKER_P_H
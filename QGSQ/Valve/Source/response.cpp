@@ -18,7 +18,7 @@
  */
 
 #include "response.h"
-#include <QDataStream>
+#include "stringpool.h"
 
 Q_LOGGING_CATEGORY(VSR, "qgsq.valve.source.response")
 
@@ -38,6 +38,8 @@ bool Response::checkHeader(const QByteArray &header)
     const auto h = read(header.size());
     if (h == header) {
         ok = true;
+    } else {
+        setError(header.size());
     }
 
     return ok;
@@ -45,10 +47,11 @@ bool Response::checkHeader(const QByteArray &header)
 
 char Response::getCharacter()
 {
-    char ch;
+    char ch = '\0';
 
-    if (Q_UNLIKELY(!getChar(&ch))) {
-        qCWarning(VSR, "Failed to get character from position %lli.", pos());
+    if (Q_UNLIKELY(m_error || !getChar(&ch))) {
+        setError(1);
+        ch = '\0';
     }
 
     return ch;
@@ -58,14 +61,67 @@ QString Response::getString()
 {
     QString str;
 
-    const auto nullTermPos = static_cast<qint64>(buffer().indexOf('\0', pos()));
-    if ((nullTermPos > -1) && (nullTermPos != pos())) {
-        str = QString::fromUtf8(read(nullTermPos - pos() + 1));
+    const char *raw = nullptr;
+    int size = 0;
+    if (Q_LIKELY(getRawString(&raw, &size)) && (size > 0)) {
+        str = QString::fromUtf8(raw, size);
     }
 
     return str;
 }
 
+QString Response::getString(StringPool *pool)
+{
+    if (!pool) {
+        return getString();
+    }
+
+    const char *raw = nullptr;
+    int size = 0;
+    if (Q_UNLIKELY(!getRawString(&raw, &size))) {
+        return QString();
+    }
+
+    return pool->intern(raw, size);
+}
+
+QStringList Response::getStringList(char separator, StringPool *pool)
+{
+    const char *raw = nullptr;
+    int size = 0;
+    if (Q_UNLIKELY(!getRawString(&raw, &size))) {
+        return QStringList();
+    }
+
+    if (pool) {
+        return pool->internList(raw, size, separator);
+    }
+
+    return QString::fromUtf8(raw, size).split(QLatin1Char(separator), QString::SkipEmptyParts);
+}
+
+bool Response::getRawString(const char **str, int *size)
+{
+    if (Q_UNLIKELY(m_error)) {
+        return false;
+    }
+
+    const QByteArray &data = buffer();
+    const auto start = static_cast<int>(pos());
+    const auto nullTermPos = data.indexOf('\0', start);
+    if (Q_UNLIKELY(nullTermPos < 0)) {
+        setError(data.size() - start + 1);
+        return false;
+    }
+
+    *str = data.constData() + start;
+    *size = nullTermPos - start;
+    // also skip the terminator of empty strings
+    seek(nullTermPos + 1);
+
+    return true;
+}
+
 QUrl Response::getUrl()
 {
     QUrl url;
@@ -80,4 +136,13 @@ bool Response::event(QEvent *event)
     return QBuffer::event(event);
 }
 
+void Response::setError(int size)
+{
+    // only the first error is logged, malformed data would flood the log otherwise
+    if (!m_error) {
+        m_error = true;
+        qCWarning(VSR, "Failed to read %i byte(s) from position %lli of %lli.", size, pos(), this->size());
+    }
+}
+
 #include "moc_response.cpp"
@@ -22,7 +22,10 @@
 
 #include <QBuffer>
 #include <QUrl>
+#include <QStringList>
 #include <QLoggingCategory>
+#include <QtEndian>
+#include <cstring>
 
 Q_DECLARE_LOGGING_CATEGORY(VSR)
 
@@ -30,6 +33,14 @@ namespace QGSQ {
 namespace Valve {
 namespace Source {
 
+class StringPool;
+
+/*
+ * Reads the little endian values and null terminated strings of a response.
+ * Reading beyond the end of the data or a string without terminator sets
+ * the error flag, all following reads return 0, '\0' or empty strings, so
+ * parsers can check hasError() once after a group of reads.
+ */
 class Response : public QBuffer
 {
     Q_OBJECT
@@ -39,21 +50,40 @@ public:
     bool checkHeader(const QByteArray &header = QByteArrayLiteral("\xff\xff\xff\xff"));
     char getCharacter();
     QString getString();
+    QString getString(StringPool *pool);
+    QStringList getStringList(char separator, StringPool *pool = nullptr);
     QUrl getUrl();
+    // points into the buffer, without the terminator
+    bool getRawString(const char **str, int *size);
 
     template<typename T> T get()
     {
-        T ret;
-        if (read(reinterpret_cast<char *>(&ret), sizeof(T)) != sizeof(T)) {
-            qCWarning(VSR, "Failed to get %lu byte(s) from position %lli.", sizeof(T), pos());
-            ret = 0;
+        uchar buf[sizeof(T)];
+        if (Q_UNLIKELY(m_error || (read(reinterpret_cast<char *>(buf), sizeof(T)) != sizeof(T)))) {
+            setError(static_cast<int>(sizeof(T)));
+            return 0;
         }
-        return ret;
+        return qFromLittleEndian<T>(buf);
     }
 
+    bool hasError() const { return m_error; }
+
     bool event(QEvent *event) override;
+
+private:
+    void setError(int size);
+
+    bool m_error = false;
 };
 
+template<> inline float Response::get<float>()
+{
+    const quint32 bits = get<quint32>();
+    float ret;
+    std::memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+}
+
 }
 }
 }
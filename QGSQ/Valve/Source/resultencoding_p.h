@@ -0,0 +1,257 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_RESULTENCODING_P_H
+#define QGSQ_VALVE_SOURCE_RESULTENCODING_P_H
+
+#include "a2slayout_p.h"
+#include <QByteArray>
+#include <QIODevice>
+#include <QHash>
+#include <QList>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(VSRE)
+
+#define QGSQ_ENCODING_FLUSH_SIZE 65536
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Output buffer shared by the JSON, CBOR and MessagePack writers. Data is
+ * either appended to a user supplied byte array or buffered and written to
+ * a device whenever a top level value is complete and the buffer is full.
+ */
+class EncodingBuffer
+{
+public:
+    EncodingBuffer(QByteArray *_buffer, QIODevice *_device) :
+        out(_buffer ? _buffer : &ownBuffer), device(_device)
+    {
+        if (device) {
+            ownBuffer.reserve(QGSQ_ENCODING_FLUSH_SIZE + 4096);
+        }
+    }
+
+    virtual ~EncodingBuffer() {}
+
+    void maybeFlush()
+    {
+        if (device && (out->size() >= QGSQ_ENCODING_FLUSH_SIZE)) {
+            flush();
+        }
+    }
+
+    bool flush()
+    {
+        if (!device || out->isEmpty()) {
+            return true;
+        }
+
+        const bool ok = (device->write(*out) == out->size());
+        if (Q_UNLIKELY(!ok)) {
+            qCCritical(VSRE, "Failed to write encoded data to device: %s", qUtf8Printable(device->errorString()));
+        }
+        out->resize(0);
+
+        return ok;
+    }
+
+    QByteArray ownBuffer;
+    QByteArray *out = nullptr;
+    QIODevice *device = nullptr;
+    int depth = 0;
+
+private:
+    Q_DISABLE_COPY(EncodingBuffer)
+};
+
+/*
+ * Server information, rules and players as written by all writers, the
+ * members of server information and players come from the A2S layouts. An
+ * encoder has to provide beginMap(int), endMap(), beginArray(int),
+ * endArray(), key(const char (&)[N]), dynamicKey(const QString&), value()
+ * overloads for QString, QByteArray, qint64, quint64, int, bool and float and
+ * the static Native64BitIntegers flag. Container sizes are always exact, so
+ * that length prefixed formats can use them.
+ */
+namespace Encoding {
+
+// 64 bit ids above 2^53 can not be represented by JSON numbers, encoders without
+// native 64 bit integers get them as strings
+template<typename E> void largeId(E &e, quint64 id)
+{
+    if (E::Native64BitIntegers || (id <= Q_UINT64_C(9007199254740992))) {
+        e.value(id);
+    } else {
+        e.value(QByteArray::number(id));
+    }
+}
+
+/*
+ * Writes the fields of a layout as map members.
+ */
+template<typename E> class Members
+{
+public:
+    explicit Members(E &_e) : e(_e) {}
+
+    template<int N> void field(const char (&k)[N], const QString &v) { e.key(k); e.value(v); }
+    template<int N> void field(const char (&k)[N], const QByteArray &v) { e.key(k); e.value(v); }
+    template<int N> void field(const char (&k)[N], const QUrl &v) { e.key(k); e.value(v.toString()); }
+    template<int N> void field(const char (&k)[N], bool v) { e.key(k); e.value(v); }
+    template<int N> void field(const char (&k)[N], float v) { e.key(k); e.value(v); }
+    template<int N> void field(const char (&k)[N], qint32 v) { e.key(k); e.value(static_cast<int>(v)); }
+    template<int N> void field(const char (&k)[N], quint32 v) { e.key(k); e.value(static_cast<qint64>(v)); }
+    template<int N> void field(const char (&k)[N], quint64 v) { e.key(k); largeId(e, v); }
+    template<int N> void field(const char (&k)[N], const QStringList &v)
+    {
+        e.key(k);
+        e.beginArray(v.size());
+        for (const QString &str : v) {
+            e.value(str);
+        }
+        e.endArray();
+    }
+    template<int N> void field(const char (&k)[N], ServerInfo::Type v)
+    {
+        if (const char *str = A2S::serverTypeString(v)) {
+            e.key(k);
+            e.value(QByteArray::fromRawData(str, 1));
+        }
+    }
+    template<int N> void field(const char (&k)[N], ServerInfo::Environment v)
+    {
+        if (const char *str = A2S::environmentString(v)) {
+            e.key(k);
+            e.value(QByteArray::fromRawData(str, 1));
+        }
+    }
+    // quint8, quint16 and the remaining enums
+    template<int N, typename T> void field(const char (&k)[N], T v) { e.key(k); e.value(static_cast<int>(v)); }
+
+private:
+    E &e;
+};
+
+// exact member count for length prefixed formats
+class MemberCounter
+{
+public:
+    template<int N, typename T> void field(const char (&)[N], const T &v)
+    {
+        if (A2S::present(v)) {
+            ++count;
+        }
+    }
+
+    int count = 0;
+};
+
+inline int serverInfoMemberCount(const ServerInfo *si)
+{
+    MemberCounter counter;
+    A2S::visitServerInfo(counter, si);
+    return counter.count;
+}
+
+template<typename E> void serverInfoMembers(E &e, const ServerInfo *si)
+{
+    Members<E> members(e);
+    A2S::visitServerInfo(members, si);
+}
+
+template<typename E> void serverInfo(E &e, const ServerInfo *si)
+{
+    if (Q_UNLIKELY(!si)) {
+        e.beginMap(0);
+        e.endMap();
+        return;
+    }
+    e.beginMap(serverInfoMemberCount(si));
+    serverInfoMembers(e, si);
+    e.endMap();
+}
+
+template<typename E> void rules(E &e, const QHash<QString,QString> &rules)
+{
+    e.beginMap(rules.size());
+    for (auto it = rules.constBegin(); it != rules.constEnd(); ++it) {
+        e.dynamicKey(it.key());
+        e.value(it.value());
+    }
+    e.endMap();
+}
+
+template<typename E> void player(E &e, const Player *player)
+{
+    if (Q_UNLIKELY(!player)) {
+        e.beginMap(0);
+        e.endMap();
+        return;
+    }
+    MemberCounter counter;
+    A2S::PlayerEntry::visit(counter, player);
+    e.beginMap(counter.count);
+    Members<E> members(e);
+    A2S::PlayerEntry::visit(members, player);
+    e.endMap();
+}
+
+template<typename E> void players(E &e, const QList<Player*> &players)
+{
+    e.beginArray(players.size());
+    for (const Player *p : players) {
+        player(e, p);
+    }
+    e.endArray();
+}
+
+template<typename E> void server(E &e, const ServerInfo *si, const QHash<QString,QString> &_rules, const QList<Player*> &_players)
+{
+    e.beginMap((si ? serverInfoMemberCount(si) : 0) + 2);
+    if (Q_LIKELY(si)) {
+        serverInfoMembers(e, si);
+    }
+    e.key("rules");
+    rules(e, _rules);
+    // "players" is the player count of the server information
+    e.key("playerList");
+    players(e, _players);
+    e.endMap();
+}
+
+template<typename E> void batch(E &e, const QList<ServerInfo*> &serverInfos)
+{
+    e.beginArray(serverInfos.size());
+    for (const ServerInfo *si : serverInfos) {
+        serverInfo(e, si);
+    }
+    e.endArray();
+}
+
+}
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_RESULTENCODING_P_H
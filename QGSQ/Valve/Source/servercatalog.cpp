@@ -0,0 +1,419 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "servercatalog_p.h"
+#include <QDateTime>
+#include <algorithm>
+
+using namespace QGSQ::Valve::Source;
+
+ServerCatalog::ServerCatalog() : d_ptr(new ServerCatalogPrivate)
+{
+
+}
+
+ServerCatalog::~ServerCatalog()
+{
+
+}
+
+ServerCatalog::Entry ServerCatalog::toEntry(const ServerInfo *serverInfo)
+{
+    Entry e;
+    if (Q_UNLIKELY(!serverInfo)) {
+        return e;
+    }
+
+    e.address = serverInfo->address();
+    e.name = serverInfo->name();
+    e.map = serverInfo->map();
+    e.folder = serverInfo->folder();
+    e.game = serverInfo->game();
+    e.version = serverInfo->version();
+    e.keywords = serverInfo->keywords();
+    e.updated = QDateTime::currentMSecsSinceEpoch();
+    e.queryPort = serverInfo->queryPort();
+    e.gamePort = serverInfo->gamePort();
+    e.appId = serverInfo->appId();
+    e.players = serverInfo->players();
+    e.maxPlayers = serverInfo->maxPlayers();
+    e.bots = serverInfo->bots();
+    e.serverType = serverInfo->serverType();
+    e.environment = serverInfo->environment();
+    e.visibility = serverInfo->visibility();
+    e.vac = serverInfo->vac();
+    return e;
+}
+
+void ServerCatalog::update(const ServerInfo *serverInfo)
+{
+    if (Q_LIKELY(serverInfo)) {
+        update(toEntry(serverInfo));
+    }
+}
+
+void ServerCatalog::update(const Entry &entry)
+{
+    Q_D(ServerCatalog);
+    const QString key = ServerCatalogPrivate::key(entry.address, entry.queryPort);
+
+    QWriteLocker locker(&d->lock);
+
+    int slot = d->slotByKey.value(key, -1);
+    if (slot >= 0) {
+        d->removeFromIndexes(slot, d->entries.at(slot));
+        d->entries[slot] = entry;
+    } else if (!d->freeSlots.isEmpty()) {
+        slot = d->freeSlots.takeLast();
+        d->entries[slot] = entry;
+        d->used[slot] = true;
+        d->slotByKey.insert(key, slot);
+    } else {
+        slot = d->entries.size();
+        d->entries.append(entry);
+        d->used.append(true);
+        d->slotByKey.insert(key, slot);
+    }
+    d->addToIndexes(slot, entry);
+}
+
+bool ServerCatalog::remove(const QString &address, quint16 queryPort)
+{
+    Q_D(ServerCatalog);
+    QWriteLocker locker(&d->lock);
+
+    const auto it = d->slotByKey.find(ServerCatalogPrivate::key(address, queryPort));
+    if (it == d->slotByKey.end()) {
+        return false;
+    }
+    const int slot = it.value();
+    d->slotByKey.erase(it);
+
+    d->removeFromIndexes(slot, d->entries.at(slot));
+    d->entries[slot] = Entry();
+    d->used[slot] = false;
+    d->freeSlots.append(slot);
+    return true;
+}
+
+bool ServerCatalog::contains(const QString &address, quint16 queryPort) const
+{
+    Q_D(const ServerCatalog);
+    QReadLocker locker(&d->lock);
+    return d->slotByKey.contains(ServerCatalogPrivate::key(address, queryPort));
+}
+
+ServerCatalog::Entry ServerCatalog::entry(const QString &address, quint16 queryPort) const
+{
+    Q_D(const ServerCatalog);
+    QReadLocker locker(&d->lock);
+    const int slot = d->slotByKey.value(ServerCatalogPrivate::key(address, queryPort), -1);
+    return (slot >= 0) ? d->entries.at(slot) : Entry();
+}
+
+int ServerCatalog::size() const
+{
+    Q_D(const ServerCatalog);
+    QReadLocker locker(&d->lock);
+    return d->slotByKey.size();
+}
+
+void ServerCatalog::clear()
+{
+    Q_D(ServerCatalog);
+    QWriteLocker locker(&d->lock);
+    d->entries.clear();
+    d->used.clear();
+    d->freeSlots.clear();
+    d->slotByKey.clear();
+    d->byAppId.clear();
+    d->byMap.clear();
+    d->byFolder.clear();
+    d->byKeyword.clear();
+    for (QSet<int> &set : d->byPlayers) {
+        set.clear();
+    }
+    for (int i = 0; i < 2; ++i) {
+        d->byVac[i].clear();
+        d->byVisibility[i].clear();
+    }
+}
+
+ServerCatalog::Page ServerCatalog::query(const Query &query) const
+{
+    Q_D(const ServerCatalog);
+    Page page;
+
+    QReadLocker locker(&d->lock);
+
+    QVector<int> matches = d->match(query);
+    page.total = matches.size();
+
+    const int offset = qMax(0, query.offset);
+    if (offset >= matches.size()) {
+        return page;
+    }
+    const int end = (query.limit < 0) ? matches.size() : static_cast<int>(qMin<qint64>(matches.size(), static_cast<qint64>(offset) + query.limit));
+
+    // only the requested page has to be in order
+    const SortKey sortKey = query.sortKey;
+    if (query.sortOrder == Qt::AscendingOrder) {
+        std::partial_sort(matches.begin(), matches.begin() + end, matches.end(), [d, sortKey](int a, int b){
+            return d->lessThan(a, b, sortKey);
+        });
+    } else {
+        std::partial_sort(matches.begin(), matches.begin() + end, matches.end(), [d, sortKey](int a, int b){
+            return d->lessThan(b, a, sortKey);
+        });
+    }
+
+    page.entries.reserve(end - offset);
+    for (int i = offset; i < end; ++i) {
+        page.entries.append(d->entries.at(matches.at(i)));
+    }
+
+    return page;
+}
+
+int ServerCatalog::count(const Query &query) const
+{
+    Q_D(const ServerCatalog);
+    QReadLocker locker(&d->lock);
+    return d->match(query).size();
+}
+
+QString ServerCatalogPrivate::key(const QString &address, quint16 queryPort)
+{
+    return address + QLatin1Char(':') + QString::number(queryPort);
+}
+
+int ServerCatalogPrivate::playerBucket(quint8 players)
+{
+    int bucket = 0;
+    while (players) {
+        ++bucket;
+        players >>= 1;
+    }
+    return bucket;
+}
+
+void ServerCatalogPrivate::addToIndexes(int slot, const ServerCatalog::Entry &e)
+{
+    byAppId[e.appId].insert(slot);
+    byMap[e.map.toLower()].insert(slot);
+    byFolder[e.folder.toLower()].insert(slot);
+    for (const QString &kw : e.keywords) {
+        byKeyword[kw.toLower()].insert(slot);
+    }
+    byPlayers[playerBucket(e.players)].insert(slot);
+    byVac[e.vac == ServerInfo::Secured ? 1 : 0].insert(slot);
+    byVisibility[e.visibility == ServerInfo::Private ? 1 : 0].insert(slot);
+}
+
+namespace {
+
+template<typename K>
+void removeFromIndex(QHash<K,QSet<int>> &index, const K &key, int slot)
+{
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it.value().remove(slot);
+        // keeps the index small when maps or keywords go out of use
+        if (it.value().isEmpty()) {
+            index.erase(it);
+        }
+    }
+}
+
+}
+
+void ServerCatalogPrivate::removeFromIndexes(int slot, const ServerCatalog::Entry &e)
+{
+    removeFromIndex(byAppId, e.appId, slot);
+    removeFromIndex(byMap, e.map.toLower(), slot);
+    removeFromIndex(byFolder, e.folder.toLower(), slot);
+    for (const QString &kw : e.keywords) {
+        removeFromIndex(byKeyword, kw.toLower(), slot);
+    }
+    byPlayers[playerBucket(e.players)].remove(slot);
+    byVac[e.vac == ServerInfo::Secured ? 1 : 0].remove(slot);
+    byVisibility[e.visibility == ServerInfo::Private ? 1 : 0].remove(slot);
+}
+
+QVector<int> ServerCatalogPrivate::match(const ServerCatalog::Query &query) const
+{
+    QVector<int> result;
+
+    const QSet<int> *smallest = nullptr;
+    bool nothing = false;
+    auto consider = [&smallest, &nothing](const QSet<int> *set) {
+        if (!set || set->isEmpty()) {
+            nothing = true;
+        } else if (!smallest || (set->size() < smallest->size())) {
+            smallest = set;
+        }
+    };
+
+    if (query.appId >= 0) {
+        const auto it = byAppId.constFind(static_cast<quint16>(query.appId));
+        consider(it != byAppId.constEnd() ? &it.value() : nullptr);
+    }
+    if (!query.map.isEmpty()) {
+        const auto it = byMap.constFind(query.map.toLower());
+        consider(it != byMap.constEnd() ? &it.value() : nullptr);
+    }
+    if (!query.folder.isEmpty()) {
+        const auto it = byFolder.constFind(query.folder.toLower());
+        consider(it != byFolder.constEnd() ? &it.value() : nullptr);
+    }
+    for (const QString &kw : query.keywords) {
+        const auto it = byKeyword.constFind(kw.toLower());
+        consider(it != byKeyword.constEnd() ? &it.value() : nullptr);
+    }
+    if (query.vac >= 0) {
+        consider(&byVac[query.vac ? 1 : 0]);
+    }
+    if (query.visibility >= 0) {
+        consider(&byVisibility[query.visibility ? 1 : 0]);
+    }
+
+    if (nothing) {
+        return result;
+    }
+
+    // player count ranges span several buckets, they are used if they are more selective than everything else
+    int firstBucket = 0;
+    int lastBucket = QGSQ_CATALOG_PLAYER_BUCKETS - 1;
+    if (query.minPlayers > 0) {
+        firstBucket = playerBucket(static_cast<quint8>(qMin(query.minPlayers, 255)));
+    }
+    if (query.maxPlayers >= 0) {
+        lastBucket = playerBucket(static_cast<quint8>(qMin(query.maxPlayers, 255)));
+    }
+    if (firstBucket > lastBucket) {
+        return result;
+    }
+    int bucketTotal = 0;
+    for (int b = firstBucket; b <= lastBucket; ++b) {
+        bucketTotal += byPlayers[b].size();
+    }
+
+    const bool useBuckets = ((firstBucket > 0) || (lastBucket < QGSQ_CATALOG_PLAYER_BUCKETS - 1)) && (!smallest || (bucketTotal < smallest->size()));
+    if (useBuckets) {
+        result.reserve(bucketTotal);
+        for (int b = firstBucket; b <= lastBucket; ++b) {
+            for (int slot : byPlayers[b]) {
+                if (matches(entries.at(slot), query)) {
+                    result.append(slot);
+                }
+            }
+        }
+    } else if (smallest) {
+        result.reserve(smallest->size());
+        for (int slot : *smallest) {
+            if (matches(entries.at(slot), query)) {
+                result.append(slot);
+            }
+        }
+    } else {
+        result.reserve(slotByKey.size());
+        for (int slot = 0; slot < entries.size(); ++slot) {
+            if (used.at(slot) && matches(entries.at(slot), query)) {
+                result.append(slot);
+            }
+        }
+    }
+
+    return result;
+}
+
+bool ServerCatalogPrivate::matches(const ServerCatalog::Entry &e, const ServerCatalog::Query &query) const
+{
+    if ((query.appId >= 0) && (e.appId != query.appId)) {
+        return false;
+    }
+    if ((query.minPlayers >= 0) && (e.players < query.minPlayers)) {
+        return false;
+    }
+    if ((query.maxPlayers >= 0) && (e.players > query.maxPlayers)) {
+        return false;
+    }
+    if ((query.vac >= 0) && ((e.vac == ServerInfo::Secured) != (query.vac != 0))) {
+        return false;
+    }
+    if ((query.visibility >= 0) && ((e.visibility == ServerInfo::Private) != (query.visibility != 0))) {
+        return false;
+    }
+    if (query.notFull && (e.players >= e.maxPlayers)) {
+        return false;
+    }
+    if (query.noBots && (e.bots > 0)) {
+        return false;
+    }
+    if (!query.map.isEmpty() && (e.map.compare(query.map, Qt::CaseInsensitive) != 0)) {
+        return false;
+    }
+    if (!query.folder.isEmpty() && (e.folder.compare(query.folder, Qt::CaseInsensitive) != 0)) {
+        return false;
+    }
+    for (const QString &kw : query.keywords) {
+        if (!e.keywords.contains(kw, Qt::CaseInsensitive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ServerCatalogPrivate::lessThan(int a, int b, ServerCatalog::SortKey sortKey) const
+{
+    const ServerCatalog::Entry &ea = entries.at(a);
+    const ServerCatalog::Entry &eb = entries.at(b);
+
+    int cmp = 0;
+    switch (sortKey) {
+    case ServerCatalog::SortByName:
+        cmp = ea.name.compare(eb.name, Qt::CaseInsensitive);
+        break;
+    case ServerCatalog::SortByMap:
+        cmp = ea.map.compare(eb.map, Qt::CaseInsensitive);
+        break;
+    case ServerCatalog::SortByPlayers:
+        cmp = static_cast<int>(ea.players) - static_cast<int>(eb.players);
+        break;
+    case ServerCatalog::SortByAppId:
+        cmp = static_cast<int>(ea.appId) - static_cast<int>(eb.appId);
+        break;
+    case ServerCatalog::SortByUpdated:
+        cmp = (ea.updated < eb.updated) ? -1 : ((ea.updated > eb.updated) ? 1 : 0);
+        break;
+    default:
+        break;
+    }
+
+    if (cmp != 0) {
+        return cmp < 0;
+    }
+
+    // stable pages
+    const int addressCmp = ea.address.compare(eb.address);
+    if (addressCmp != 0) {
+        return addressCmp < 0;
+    }
+    return ea.queryPort < eb.queryPort;
+}
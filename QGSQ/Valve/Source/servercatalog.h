@@ -0,0 +1,137 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERCATALOG_H
+#define QGSQ_VALVE_SOURCE_SERVERCATALOG_H
+
+#include "qgsq_global.h"
+#include "serverinfo.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QScopedPointer>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerCatalogPrivate;
+
+/*
+ * In-memory catalog of server information for server browsers. Entries are
+ * plain values keyed by address and query port and are updated in place
+ * whenever a new reply arrives. Secondary indexes by app id, map, game
+ * folder, keyword, player count, VAC and visibility are maintained
+ * incrementally, a query starts from the smallest matching index, checks
+ * the remaining conditions on the candidates only and sorts just the
+ * requested page. All methods are thread safe, queries run concurrently.
+ */
+class QGSQ_LIBRARY ServerCatalog
+{
+public:
+    struct Entry {
+        QString address;
+        QString name;
+        QString map;
+        QString folder;
+        QString game;
+        QString version;
+        QStringList keywords;
+        qint64 updated = 0;
+        quint16 queryPort = 0;
+        quint16 gamePort = 0;
+        quint16 appId = 0;
+        quint8 players = 0;
+        quint8 maxPlayers = 0;
+        quint8 bots = 0;
+        ServerInfo::Type serverType = ServerInfo::Unspecified;
+        ServerInfo::Environment environment = ServerInfo::Unknown;
+        ServerInfo::Visibility visibility = ServerInfo::Public;
+        ServerInfo::VAC vac = ServerInfo::Unsecured;
+    };
+
+    enum SortKey : quint8 {
+        SortByName      = 0,
+        SortByMap       = 1,
+        SortByPlayers   = 2,
+        SortByAppId     = 3,
+        SortByAddress   = 4,
+        SortByUpdated   = 5
+    };
+
+    /*
+     * Conditions of a query, unset conditions match every server. All
+     * keywords have to be present. Results are sorted by sortKey, ties are
+     * broken by address and port, so pages are stable.
+     */
+    struct Query {
+        QString map;
+        QString folder;
+        QStringList keywords;
+        int appId = -1;
+        int minPlayers = -1;
+        int maxPlayers = -1;
+        int vac = -1;
+        int visibility = -1;
+        bool notFull = false;
+        bool noBots = false;
+        SortKey sortKey = SortByName;
+        Qt::SortOrder sortOrder = Qt::AscendingOrder;
+        int offset = 0;
+        int limit = 50;
+    };
+
+    struct Page {
+        QVector<Entry> entries;
+        int total = 0;
+    };
+
+    ServerCatalog();
+
+    ~ServerCatalog();
+
+    static Entry toEntry(const ServerInfo *serverInfo);
+
+    void update(const ServerInfo *serverInfo);
+    void update(const Entry &entry);
+    bool remove(const QString &address, quint16 queryPort);
+    bool contains(const QString &address, quint16 queryPort) const;
+    Entry entry(const QString &address, quint16 queryPort) const;
+
+    int size() const;
+    void clear();
+
+    Page query(const Query &query) const;
+    int count(const Query &query) const;
+
+protected:
+    const QScopedPointer<ServerCatalogPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(ServerCatalog)
+    Q_DECLARE_PRIVATE(ServerCatalog)
+};
+
+}
+}
+}
+
+Q_DECLARE_TYPEINFO(QGSQ::Valve::Source::ServerCatalog::Entry, Q_MOVABLE_TYPE);
+
+#endif // QGSQ_VALVE_SOURCE_SERVERCATALOG_H
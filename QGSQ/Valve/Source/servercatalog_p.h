@@ -0,0 +1,65 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERCATALOG_P_H
+#define QGSQ_VALVE_SOURCE_SERVERCATALOG_P_H
+
+#include "servercatalog.h"
+#include <QHash>
+#include <QSet>
+#include <QReadWriteLock>
+
+#define QGSQ_CATALOG_PLAYER_BUCKETS 9
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerCatalogPrivate
+{
+public:
+    static QString key(const QString &address, quint16 queryPort);
+    // 0, 1, 2-3, 4-7 ... 128-255 players
+    static int playerBucket(quint8 players);
+
+    void addToIndexes(int slot, const ServerCatalog::Entry &e);
+    void removeFromIndexes(int slot, const ServerCatalog::Entry &e);
+    QVector<int> match(const ServerCatalog::Query &query) const;
+    bool matches(const ServerCatalog::Entry &e, const ServerCatalog::Query &query) const;
+    bool lessThan(int a, int b, ServerCatalog::SortKey sortKey) const;
+
+    mutable QReadWriteLock lock;
+    QVector<ServerCatalog::Entry> entries;
+    QVector<bool> used;
+    QVector<int> freeSlots;
+    QHash<QString,int> slotByKey;
+    QHash<quint16,QSet<int>> byAppId;
+    QHash<QString,QSet<int>> byMap;
+    QHash<QString,QSet<int>> byFolder;
+    QHash<QString,QSet<int>> byKeyword;
+    QSet<int> byPlayers[QGSQ_CATALOG_PLAYER_BUCKETS];
+    QSet<int> byVac[2];
+    QSet<int> byVisibility[2];
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SERVERCATALOG_P_H
@@ -18,13 +18,15 @@
  */
 
 #include "serverinfo_p.h"
+#include "a2slayout_p.h"
 #include "response.h"
 #include "serverquery.h"
+#include "stringpool.h"
 
 #include <QLoggingCategory>
 #include <QDataStream>
-#include <QJsonArray>
 #include <QJsonDocument>
+#include <QMetaMethod>
 
 Q_LOGGING_CATEGORY(SI, "qgsq.valve.source.serverinfo")
 
@@ -80,24 +82,28 @@ quint8 ServerInfo::protocol() const
 QString ServerInfo::name() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyName);
     return d->name;
 }
 
 QString ServerInfo::map() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyMap);
     return d->map;
 }
 
 QString ServerInfo::folder() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyFolder);
     return d->folder;
 }
 
 QString ServerInfo::game() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyGame);
     return d->game;
 }
 
@@ -170,6 +176,7 @@ quint8 ServerInfo::theShipDuration() const
 QString ServerInfo::version() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyVersion);
     return d->version;
 }
 
@@ -194,12 +201,14 @@ quint16 ServerInfo::specPort() const
 QString ServerInfo::specName() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazySpecName);
     return d->specName;
 }
 
 QStringList ServerInfo::keywords() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyKeywords);
     return d->keywords;
 }
 
@@ -231,12 +240,14 @@ bool ServerInfo::isMod() const
 QUrl ServerInfo::modLink() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyModLink);
     return d->modLink;
 }
 
 QUrl ServerInfo::modDownloadLink() const
 {
     Q_D(const ServerInfo);
+    d->decode(ServerInfoPrivate::LazyModDownloadLink);
     return d->modDownloadLink;
 }
 
@@ -269,89 +280,38 @@ QJsonObject ServerInfo::toJson() const
     QJsonObject o;
 
     Q_D(const ServerInfo);
-    o.insert(QStringLiteral("address"), QJsonValue(d->address));
-    o.insert(QStringLiteral("queryPort"), QJsonValue(static_cast<int>(d->queryPort)));
-    o.insert(QStringLiteral("isGoldSource"), QJsonValue(d->goldSource));
-    o.insert(QStringLiteral("protocol"), QJsonValue(static_cast<int>(d->protocol)));
-    o.insert(QStringLiteral("name"), QJsonValue(d->name));
-    o.insert(QStringLiteral("map"), QJsonValue(d->map));
-    o.insert(QStringLiteral("folder"), QJsonValue(d->folder));
-    o.insert(QStringLiteral("game"), QJsonValue(d->game));
-    if (!d->goldSource) {
-        o.insert(QStringLiteral("appId"), QJsonValue(static_cast<int>(d->appId)));
-    }
-    o.insert(QStringLiteral("players"), QJsonValue(static_cast<int>(d->players)));
-    o.insert(QStringLiteral("maxPlayers"), QJsonValue(static_cast<int>(d->maxPlayers)));
-    o.insert(QStringLiteral("bots"), QJsonValue(static_cast<int>(d->bots)));
-    switch (d->serverType) {
-    case Dedicated:
-        o.insert(QStringLiteral("serverType"), QJsonValue(QStringLiteral("d")));
-        break;
-    case NonDedicated:
-        o.insert(QStringLiteral("serverType"), QJsonValue(QStringLiteral("l")));
-        break;
-    case SourceTVRelay:
-        o.insert(QStringLiteral("serverType"), QJsonValue(QStringLiteral("p")));
-        break;
-    default:
-        break;
-    }
-    switch (d->environment) {
-    case Linux:
-        o.insert(QStringLiteral("environment"), QJsonValue(QStringLiteral("l")));
-        break;
-    case Windows:
-        o.insert(QStringLiteral("environment"), QJsonValue(QStringLiteral("w")));
-        break;
-    case Mac:
-        o.insert(QStringLiteral("environment"), QJsonValue(QStringLiteral("m")));
-        break;
-    default:
-        break;
-    }
-
-    o.insert(QStringLiteral("visibility"), QJsonValue(static_cast<int>(d->visibility)));
-    o.insert(QStringLiteral("vac"), QJsonValue(static_cast<int>(d->vac)));
-
-    if (d->appId == 2400) {
-        o.insert(QStringLiteral("mode"), QJsonValue(static_cast<int>(d->theShipMode)));
-        o.insert(QStringLiteral("witnesses"), QJsonValue(static_cast<int>(d->theShipWitnesses)));
-        o.insert(QStringLiteral("duration"), QJsonValue(static_cast<int>(d->theShipDuration)));
+    d->decodeAll();
+    A2S::JsonPrinter printer(o);
+    A2S::visitServerInfo(printer, this);
+    // the mod type used to be written with the misspelled key, existing consumers still read it
+    const auto modType = o.constFind(QStringLiteral("modType"));
+    if (modType != o.constEnd()) {
+        o.insert(QStringLiteral("modTye"), modType.value());
     }
+    return o;
+}
 
-    if (!d->goldSource) {
-        o.insert(QStringLiteral("version"), QJsonValue(d->version));
-        o.insert(QStringLiteral("gamePort"), QJsonValue(static_cast<int>(d->gamePort)));
-        if (d->steamId <= Q_UINT64_C(9007199254740992)) {
-            o.insert(QStringLiteral("steamId"), QJsonValue(static_cast<qint64>(d->steamId)));
-        } else {
-            o.insert(QStringLiteral("steamId"), QJsonValue(QString::number(d->steamId)));
-        }
+bool ServerInfo::lazyDecoding() const
+{
+    Q_D(const ServerInfo);
+    return d->lazyDecoding;
+}
 
-        o.insert(QStringLiteral("specPort"), QJsonValue(static_cast<int>(d->specPort)));
-        o.insert(QStringLiteral("specName"), QJsonValue(d->specName));
-        o.insert(QStringLiteral("keywords"), QJsonArray::fromStringList(d->keywords));
-        if (d->gameId <= Q_UINT64_C(9007199254740992)) {
-            o.insert(QStringLiteral("gameId"), QJsonValue(static_cast<qint64>(d->gameId)));
-        } else {
-            o.insert(QStringLiteral("gameId"), QJsonValue(QString::number(d->gameId)));
-        }
-        o.insert(QStringLiteral("storeLink"), QJsonValue(storeLink().toString()));
-    } else {
-        o.insert(QStringLiteral("isMod"), QJsonValue(d->isMod));
-        if (d->isMod) {
-            o.insert(QStringLiteral("modLink"), QJsonValue(d->modLink.toString()));
-            o.insert(QStringLiteral("modDownloadLink"), QJsonValue(d->modDownloadLink.toString()));
-            o.insert(QStringLiteral("modVersion"), QJsonValue(static_cast<qint64>(d->modVersion)));
-            o.insert(QStringLiteral("modSize"), QJsonValue(static_cast<qint64>(d->modSize)));
-            o.insert(QStringLiteral("modTye"), QJsonValue(d->modType == ServerInfo::MultiplayerOnlyMod ? 1 : 0));
-            o.insert(QStringLiteral("modDll"), QJsonValue(d->modDll == ServerInfo::UsesOwnDll ? 1 : 0));
-        }
+void ServerInfo::setLazyDecoding(bool lazy)
+{
+    Q_D(ServerInfo);
+    d->lazyDecoding = lazy;
+    if (!lazy) {
+        d->decodeAll();
     }
-    return o;
 }
 
 int ServerInfo::setRawData(const QByteArray &data)
+{
+    return setRawData(data, nullptr);
+}
+
+int ServerInfo::setRawData(const QByteArray &data, StringPool *pool)
 {
     int pos = 0;
     if (Q_LIKELY(!data.isEmpty())) {
@@ -360,120 +320,40 @@ int ServerInfo::setRawData(const QByteArray &data)
         const char header = res.getCharacter();
         if ((header == 'I') || (header == 'm')) {
             Q_D(ServerInfo);
-            d->setGoldSource(header == 'm');
 
-            if (!d->goldSource) {
-                d->setProtocol(res.get<quint8>());
-                d->setName(res.getString());
-                d->setMap(res.getString());
-                d->setFolder(res.getString());
-                d->setGame(res.getString());
-                d->setAppId(res.get<quint16>());
-                d->setPlayers(res.get<quint8>());
-                d->setMaxPlayers(res.get<quint8>());
-                d->setBots(res.get<quint8>());
-                d->setServerType(res.getCharacter());
-                d->setEnvironment(res.getCharacter());
-                d->setVisibility(res.get<quint8>() ? ServerInfo::Private : ServerInfo::Public);
-                d->setVac(res.get<quint8>() ? ServerInfo::Secured : ServerInfo::Unsecured);
-                if (d->appId == 2400) {
-                    d->setTheShipMode(res.get<quint8>());
-                    d->setTheShipWitnesses(res.get<quint8>());
-                    d->setTheShipDuartion(res.get<quint8>());
-                } else {
-                    d->setTheShipWitnesses(ServerInfo::UnknownTheShipMode);
-                    d->setTheShipWitnesses(0);
-                    d->setTheShipDuartion(0);
-                }
-                d->setVersion(res.getString());
-
-                const auto edf = res.get<quint8>();
-                if (edf & 0x80) {
-                    d->setGamePort(res.get<quint16>());
-                } else {
-                    d->setGamePort(0);
-                }
-
-                if (edf & 0x10) {
-                    d->setSteamId(res.get<quint64>());
-                } else {
-                    d->setSteamId(0);
-                }
-
-                if (edf & 0x40) {
-                    d->setSpecPort(res.get<quint16>());
-                    d->setSpecName(res.getString());
-                } else {
-                    d->setSpecPort(0);
-                    d->setSpecName(QString());
-                }
-
-                if (edf & 0x20) {
-                    const QString kws = res.getString();
-                    if (!kws.isEmpty()) {
-                        d->setKeywords(kws.split(kws.at(0), QString::SkipEmptyParts));
-                    } else {
-                        d->setKeywords(QStringList());
+            // strings are only left encoded if nobody has to be notified about changes
+            quint16 lazy = 0;
+            if (d->lazyDecoding) {
+                static const QMetaMethod notifiers[ServerInfoPrivate::LazyFieldCount] = {
+                    QMetaMethod::fromSignal(&ServerInfo::nameChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::mapChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::folderChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::gameChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::versionChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::specNameChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::keywordsChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::modLinkChanged),
+                    QMetaMethod::fromSignal(&ServerInfo::modDownloadLinkChanged)
+                };
+                for (int i = 0; i < ServerInfoPrivate::LazyFieldCount; ++i) {
+                    if (!isSignalConnected(notifiers[i])) {
+                        lazy |= (1 << i);
                     }
-                } else {
-                    d->setKeywords(QStringList());
                 }
+            }
 
-                if (edf & 0x01) {
-                    d->setGameId(res.get<quint64>());
-                } else {
-                    d->setGameId(0);
-                }
+            // pending strings of the previous reply are replaced, they refer to the old data
+            d->pending = 0;
+            d->raw = lazy ? ba : QByteArray();
+            d->pool = lazy ? pool : nullptr;
 
-                // only available in the gold source response
-                d->setIsMod(false);
-                d->setModLink(QUrl());
-                d->setModDownloadLink(QUrl());
-                d->setModVersion(0);
-                d->setModSize(0);
-                d->setModType(ServerInfo::SingleAndMultiplayerMod);
-                d->setModDll(ServerInfo::UsesHalfLifeDll);
-            } else {
-                const QString addressAndPort = res.getString();
-                const auto portSepIdx = addressAndPort.lastIndexOf(QLatin1Char(':'));
-                if (portSepIdx > -1) {
-                    d->setGamePort(addressAndPort.midRef(portSepIdx + 1).toUShort());
-                } else {
-                    d->setGamePort(0);
-                }
-                d->setName(res.getString());
-                d->setMap(res.getString());
-                d->setFolder(res.getString());
-                d->setGame(res.getString());
-                d->setPlayers(res.get<quint8>());
-                d->setMaxPlayers(res.get<quint8>());
-                d->setProtocol(res.get<quint8>());
-                d->setServerType(res.getCharacter());
-                d->setEnvironment(res.getCharacter());
-                d->setVisibility(res.get<quint8>() ? ServerInfo::Private : ServerInfo::Public);
-                d->setIsMod(res.get<quint8>() == 1);
-                if (d->isMod) {
-                    d->setModLink(res.getUrl());
-                    d->setModDownloadLink(res.getUrl());
-                    res.get<quint8>();
-                    d->setModVersion(res.get<quint32>());
-                    d->setModSize(res.get<quint32>());
-                    d->setModType(res.get<quint8>() ? ServerInfo::MultiplayerOnlyMod : ServerInfo::SingleAndMultiplayerMod);
-                    d->setModDll(res.get<quint8>() ? ServerInfo::UsesHalfLifeDll : ServerInfo::UsesOwnDll);
-                }
-                d->setVac(res.get<quint8>() ? ServerInfo::Secured : ServerInfo::Unsecured);
-                d->setBots(res.get<quint8>());
-
-                // only available in the new response format
-                d->setAppId(0);
-                d->setTheShipWitnesses(ServerInfo::UnknownTheShipMode);
-                d->setTheShipWitnesses(0);
-                d->setTheShipDuartion(0);
-                d->setSteamId(0);
-                d->setSpecPort(0);
-                d->setSpecName(QString());
-                d->setKeywords(QStringList());
-                d->setGameId(0);
+            d->setGoldSource(header == 'm');
+
+            A2S::Reader reader(res, pool, lazy);
+            const bool complete = d->goldSource ? A2S::GoldSourceInfo::read(d, reader) : A2S::SourceInfo::read(d, reader);
+            if (Q_UNLIKELY(!complete)) {
+                qCCritical(SI, "Truncated A2S_INFO response.");
+                return 0;
             }
             pos = res.pos();
         } else {
@@ -556,10 +436,15 @@ bool ServerInfo::event(QEvent *event)
 }
 
 ServerInfo *ServerInfo::fromRawData(const QByteArray &data, const QString &address, quint16 queryPort, QObject *parent)
+{
+    return fromRawData(data, address, queryPort, parent, nullptr);
+}
+
+ServerInfo *ServerInfo::fromRawData(const QByteArray &data, const QString &address, quint16 queryPort, QObject *parent, StringPool *pool)
 {
     ServerInfo *si = new ServerInfo(address, queryPort, parent);
 
-    si->setRawData(data);
+    si->setRawData(data, pool);
 
     return si;
 }
@@ -928,6 +813,80 @@ void ServerInfoPrivate::setModDll(ServerInfo::ModDLLUsage _dll)
     }
 }
 
+void ServerInfoPrivate::readString(Response &res, LazyField field, StringPool *pool, bool lazy)
+{
+    const char *str = nullptr;
+    int size = 0;
+    if (Q_UNLIKELY(!res.getRawString(&str, &size))) {
+        return;
+    }
+
+    if (lazy) {
+        pending |= (1 << field);
+        rawStrings[field].offset = static_cast<int>(str - raw.constData());
+        rawStrings[field].size = size;
+    } else {
+        pending &= ~(1 << field);
+        assignString(field, str, size, pool);
+    }
+}
+
+void ServerInfoPrivate::assignString(LazyField field, const char *str, int size, StringPool *pool)
+{
+    switch (field) {
+    case LazyName:
+        setName(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazyMap:
+        setMap(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazyFolder:
+        setFolder(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazyGame:
+        setGame(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazyVersion:
+        setVersion(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazySpecName:
+        setSpecName(pool ? pool->intern(str, size) : QString::fromUtf8(str, size));
+        break;
+    case LazyKeywords:
+        setKeywords(pool ? pool->internList(str, size, ',') : QString::fromUtf8(str, size).split(QLatin1Char(','), QString::SkipEmptyParts));
+        break;
+    case LazyModLink:
+        setModLink(QUrl(QString::fromUtf8(str, size)));
+        break;
+    case LazyModDownloadLink:
+        setModDownloadLink(QUrl(QString::fromUtf8(str, size)));
+        break;
+    default:
+        break;
+    }
+}
+
+void ServerInfoPrivate::decodePending(quint16 fields)
+{
+    // decoding on access must not emit change signals from a getter
+    Q_Q(ServerInfo);
+    const QSignalBlocker blocker(q);
+    fields &= pending;
+    for (int i = 0; fields && (i < LazyFieldCount); ++i) {
+        const quint16 bit = static_cast<quint16>(1 << i);
+        if (fields & bit) {
+            fields &= ~bit;
+            pending &= ~bit;
+            assignString(static_cast<LazyField>(i), raw.constData() + rawStrings[i].offset, rawStrings[i].size, pool);
+        }
+    }
+
+    if (!pending) {
+        raw.clear();
+        pool = nullptr;
+    }
+}
+
 QDebug operator<<(QDebug dbg, const QGSQ::Valve::Source::ServerInfo *serverInfo)
 {
     QDebugStateSaver saver(dbg);
@@ -936,64 +895,8 @@ QDebug operator<<(QDebug dbg, const QGSQ::Valve::Source::ServerInfo *serverInfo)
         return dbg << QGSQ::Valve::Source::ServerInfo::staticMetaObject.className() << "(0x0)";
     }
     dbg.nospace() << serverInfo->metaObject()->className() << '(' << (const void *)serverInfo;
-    dbg << ", GoldSource: " << serverInfo->isGoldSource();
-    dbg << ", Protocol version: " << serverInfo->protocol();
-    dbg << ", Name: " << serverInfo->name();
-    dbg << ", Map: " << serverInfo->map();
-    dbg << ", Folder: " << serverInfo->folder();
-    dbg << ", Game: " << serverInfo->game();
-    if (!serverInfo->isGoldSource()) {
-        dbg << ", AppID: " << serverInfo->appId();
-    }
-    dbg << ", Players: " << serverInfo->players();
-    dbg << ", Max. Players: " << serverInfo->maxPlayers();
-    dbg << ", Bots: " << serverInfo->bots();
-    dbg << ", Type: " << serverInfo->serverType();
-    dbg << ", Environment: " << serverInfo->environment();
-    dbg << ", Visibility: " << serverInfo->visibility();
-    dbg << ", VAC: " << serverInfo->vac();
-    if (serverInfo->appId() == 2400) {
-        dbg << ", Mode: " << serverInfo->theShipMode();
-        dbg << ", Witnesses: " << serverInfo->theShipWitnesses();
-        dbg << ", Duration: " << serverInfo->theShipDuration();
-    }
-    if (!serverInfo->isGoldSource()) {
-        dbg << ", Version: " << serverInfo->version();
-        if (serverInfo->gamePort()) {
-            dbg << ", Game Port: " << serverInfo->gamePort();
-        }
-        if (serverInfo->steamId()) {
-            dbg << ", SteamID: " << serverInfo->steamId();
-        }
-        if (serverInfo->specPort()) {
-            dbg << ", Spectator Port: " << serverInfo->specPort();
-        }
-        if (!serverInfo->specName().isEmpty()) {
-            dbg << ", Spectator Server Name: " << serverInfo->specName();
-        }
-        if (!serverInfo->keywords().isEmpty()) {
-            dbg << ", Keywords: " << serverInfo->keywords();
-        }
-        if (serverInfo->gameId()) {
-            dbg << ", GameID: " << serverInfo->gameId();
-        }
-        if (serverInfo->storeLink().isValid()) {
-            dbg << ", Store Link: " << serverInfo->storeLink();
-        }
-    } else {
-        if (serverInfo->gamePort()) {
-            dbg << ", Game Port: " << serverInfo->gamePort();
-        }
-        dbg << ", IsMod: " << serverInfo->isMod();
-        if (serverInfo->isMod()) {
-            dbg << ", ModLink: " << serverInfo->modLink();
-            dbg << ", ModDownloadLink: " << serverInfo->modDownloadLink();
-            dbg << ", ModVersion: " << serverInfo->modVersion();
-            dbg << ", ModSize: " << serverInfo->modSize();
-            dbg << ", ModType: " << serverInfo->modType();
-            dbg << ", ModDLL: " << serverInfo->modDll();
-        }
-    }
+    QGSQ::Valve::Source::A2S::DebugPrinter printer(dbg);
+    QGSQ::Valve::Source::A2S::visitServerInfo(printer, serverInfo);
     dbg << ')';
     return dbg.maybeSpace();
 }
@@ -31,6 +31,7 @@ namespace Valve {
 namespace Source {
 
 class ServerInfoPrivate;
+class StringPool;
 
 class QGSQ_LIBRARY ServerInfo : public QObject
 {
@@ -197,7 +198,18 @@ public:
 
     QJsonObject toJson() const;
 
+    /*
+     * With lazy decoding enabled, setRawData() only records where the
+     * strings are located in the reply and decodes them on first access.
+     * Strings whose change signal is connected are still decoded at once.
+     * A string pool given to setRawData() is used for the deferred strings
+     * as well, so it has to outlive their decoding.
+     */
+    bool lazyDecoding() const;
+    void setLazyDecoding(bool lazy);
+
     int setRawData(const QByteArray &data);
+    int setRawData(const QByteArray &data, StringPool *pool);
 
     Q_INVOKABLE bool update(int timeout = 4000);
 
@@ -210,6 +222,7 @@ public:
     bool event(QEvent *event) override;
 
     static ServerInfo *fromRawData(const QByteArray &data, const QString &address, quint16 queryPort, QObject *parent = nullptr);
+    static ServerInfo *fromRawData(const QByteArray &data, const QString &address, quint16 queryPort, QObject *parent, StringPool *pool);
 
     static ServerInfo *get(const QString &address, quint16 queryPort, int timeout = 4000, QObject *parent = nullptr);
 
@@ -254,6 +267,7 @@ protected:
     ServerInfo(ServerInfoPrivate &dd, QObject *parent = nullptr);
 
 private:
+    friend class SnapshotRecord;
     Q_DISABLE_COPY(ServerInfo)
     Q_DECLARE_PRIVATE(ServerInfo)
 };
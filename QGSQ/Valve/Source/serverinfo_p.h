@@ -26,9 +26,30 @@ namespace QGSQ {
 namespace Valve {
 namespace Source {
 
+class Response;
+
 class ServerInfoPrivate
 {
 public:
+    // string fields that can be decoded on first access
+    enum LazyField : quint8 {
+        LazyName                = 0,
+        LazyMap                 = 1,
+        LazyFolder              = 2,
+        LazyGame                = 3,
+        LazyVersion             = 4,
+        LazySpecName            = 5,
+        LazyKeywords            = 6,
+        LazyModLink             = 7,
+        LazyModDownloadLink     = 8,
+        LazyFieldCount          = 9
+    };
+
+    struct RawString {
+        int offset = 0;
+        int size = 0;
+    };
+
     ServerInfoPrivate() {}
 
     virtual ~ServerInfoPrivate() {}
@@ -70,6 +91,22 @@ public:
     void setModType(ServerInfo::ModType _type);
     void setModDll(ServerInfo::ModDLLUsage _dll);
 
+    void readString(Response &res, LazyField field, StringPool *pool, bool lazy);
+    void assignString(LazyField field, const char *str, int size, StringPool *pool);
+    void decodePending(quint16 fields);
+    inline void decode(LazyField field) const
+    {
+        if (Q_UNLIKELY(pending & (1 << field))) {
+            const_cast<ServerInfoPrivate*>(this)->decodePending(1 << field);
+        }
+    }
+    inline void decodeAll() const
+    {
+        if (Q_UNLIKELY(pending)) {
+            const_cast<ServerInfoPrivate*>(this)->decodePending(pending);
+        }
+    }
+
     Q_DECLARE_PUBLIC(ServerInfo)
     quint64 steamId = 0;
     quint64 gameId = 0;
@@ -83,6 +120,10 @@ public:
     QString specName;
     QUrl modLink;
     QUrl modDownloadLink;
+    QByteArray raw;
+    RawString rawStrings[LazyFieldCount];
+    // pool of the reply the pending strings belong to
+    StringPool *pool = nullptr;
     ServerInfo *q_ptr = nullptr;
     quint32 modVersion = 0;
     quint32 modSize = 0;
@@ -90,6 +131,7 @@ public:
     quint16 gamePort = 0;
     quint16 specPort = 0;
     quint16 queryPort = 0;
+    quint16 pending = 0;
     quint8 protocol = 0;
     quint8 players = 0;
     quint8 maxPlayers = 0;
@@ -105,6 +147,7 @@ public:
     ServerInfo::TheShipMode theShipMode = ServerInfo::UnknownTheShipMode;
     bool goldSource = false;
     bool isMod = false;
+    bool lazyDecoding = false;
 
 private:
     Q_DISABLE_COPY(ServerInfoPrivate)
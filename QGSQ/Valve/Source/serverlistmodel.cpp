@@ -0,0 +1,376 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "serverlistmodel_p.h"
+#include "serverquery.h"
+#include <QLoggingCategory>
+#include <algorithm>
+
+Q_LOGGING_CATEGORY(SSLM, "qgsq.valve.source.serverlistmodel")
+
+using namespace QGSQ::Valve::Source;
+
+ServerListModel::ServerListModel(QObject *parent) : QAbstractListModel(parent), d_ptr(new ServerListModelPrivate)
+{
+    Q_D(ServerListModel);
+    d->q_ptr = this;
+    d->timer.setSingleShot(true);
+    d->timer.setInterval(100);
+    connect(&d->timer, &QTimer::timeout, this, &ServerListModel::flush);
+}
+
+ServerListModel::~ServerListModel()
+{
+
+}
+
+int ServerListModel::rowCount(const QModelIndex &parent) const
+{
+    Q_D(const ServerListModel);
+    return parent.isValid() ? 0 : d->rows.size();
+}
+
+QVariant ServerListModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const ServerListModel);
+    if (Q_UNLIKELY(!index.isValid() || (index.row() >= d->rows.size()))) {
+        return QVariant();
+    }
+
+    const ServerCatalog::Entry &e = d->rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return e.name;
+    case AddressRole:
+        return e.address;
+    case QueryPortRole:
+        return static_cast<int>(e.queryPort);
+    case MapRole:
+        return e.map;
+    case FolderRole:
+        return e.folder;
+    case GameRole:
+        return e.game;
+    case VersionRole:
+        return e.version;
+    case KeywordsRole:
+        return e.keywords;
+    case GamePortRole:
+        return static_cast<int>(e.gamePort);
+    case AppIdRole:
+        return static_cast<int>(e.appId);
+    case PlayersRole:
+        return static_cast<int>(e.players);
+    case MaxPlayersRole:
+        return static_cast<int>(e.maxPlayers);
+    case BotsRole:
+        return static_cast<int>(e.bots);
+    case ServerTypeRole:
+        return static_cast<int>(e.serverType);
+    case EnvironmentRole:
+        return static_cast<int>(e.environment);
+    case VisibilityRole:
+        return static_cast<int>(e.visibility);
+    case VacRole:
+        return static_cast<int>(e.vac);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int,QByteArray> ServerListModel::roleNames() const
+{
+    static const QHash<int,QByteArray> names({
+        {AddressRole, QByteArrayLiteral("address")},
+        {QueryPortRole, QByteArrayLiteral("queryPort")},
+        {NameRole, QByteArrayLiteral("name")},
+        {MapRole, QByteArrayLiteral("map")},
+        {FolderRole, QByteArrayLiteral("folder")},
+        {GameRole, QByteArrayLiteral("game")},
+        {VersionRole, QByteArrayLiteral("version")},
+        {KeywordsRole, QByteArrayLiteral("keywords")},
+        {GamePortRole, QByteArrayLiteral("gamePort")},
+        {AppIdRole, QByteArrayLiteral("appId")},
+        {PlayersRole, QByteArrayLiteral("players")},
+        {MaxPlayersRole, QByteArrayLiteral("maxPlayers")},
+        {BotsRole, QByteArrayLiteral("bots")},
+        {ServerTypeRole, QByteArrayLiteral("serverType")},
+        {EnvironmentRole, QByteArrayLiteral("environment")},
+        {VisibilityRole, QByteArrayLiteral("visibility")},
+        {VacRole, QByteArrayLiteral("vac")}
+    });
+    return names;
+}
+
+int ServerListModel::count() const
+{
+    Q_D(const ServerListModel);
+    return d->rows.size();
+}
+
+int ServerListModel::updateInterval() const
+{
+    Q_D(const ServerListModel);
+    return d->timer.interval();
+}
+
+void ServerListModel::setUpdateInterval(int msecs)
+{
+    Q_D(ServerListModel);
+    msecs = qMax(0, msecs);
+    if (d->timer.interval() != msecs) {
+        d->timer.setInterval(msecs);
+        Q_EMIT updateIntervalChanged(msecs);
+    }
+}
+
+StringPool *ServerListModel::stringPool() const
+{
+    Q_D(const ServerListModel);
+    return d->stringPool;
+}
+
+void ServerListModel::setStringPool(StringPool *pool)
+{
+    Q_D(ServerListModel);
+    d->stringPool = pool;
+}
+
+void ServerListModel::track(ServerQuery *query)
+{
+    if (Q_UNLIKELY(!query)) {
+        return;
+    }
+
+    connect(query, &ServerQuery::gotRawInfo, this, [this, query](const QByteArray &data){
+        if (!data.isEmpty()) {
+            updateRaw(query->server(), query->port(), data);
+        }
+    });
+}
+
+void ServerListModel::addServer(const QString &address, quint16 queryPort)
+{
+    Q_D(ServerListModel);
+    const QString key = ServerListModelPrivate::key(address, queryPort);
+    if (d->rowByKey.contains(key) || d->pending.contains(key)) {
+        return;
+    }
+
+    ServerCatalog::Entry e;
+    e.address = address;
+    e.queryPort = queryPort;
+    d->pending.insert(key, e);
+    d->schedule();
+}
+
+bool ServerListModel::removeServer(const QString &address, quint16 queryPort)
+{
+    Q_D(ServerListModel);
+    const QString key = ServerListModelPrivate::key(address, queryPort);
+    const bool wasPending = (d->pending.remove(key) > 0);
+
+    const int r = d->rowByKey.value(key, -1);
+    if (r < 0) {
+        return wasPending;
+    }
+
+    beginRemoveRows(QModelIndex(), r, r);
+    d->rows.remove(r);
+    d->rowByKey.remove(key);
+    d->reindex(r);
+    endRemoveRows();
+    Q_EMIT countChanged(d->rows.size());
+
+    return true;
+}
+
+int ServerListModel::row(const QString &address, quint16 queryPort) const
+{
+    Q_D(const ServerListModel);
+    return d->rowByKey.value(ServerListModelPrivate::key(address, queryPort), -1);
+}
+
+ServerCatalog::Entry ServerListModel::entry(int row) const
+{
+    Q_D(const ServerListModel);
+    return d->rows.value(row);
+}
+
+void ServerListModel::update(const ServerInfo *serverInfo)
+{
+    if (Q_LIKELY(serverInfo)) {
+        update(ServerCatalog::toEntry(serverInfo));
+    }
+}
+
+void ServerListModel::update(const ServerCatalog::Entry &entry)
+{
+    Q_D(ServerListModel);
+    // only the latest update of a server within one interval is applied
+    d->pending.insert(ServerListModelPrivate::key(entry.address, entry.queryPort), entry);
+    d->schedule();
+}
+
+bool ServerListModel::updateRaw(const QString &address, quint16 queryPort, const QByteArray &rawInfo)
+{
+    Q_D(ServerListModel);
+    if (Q_UNLIKELY(d->parser.setRawData(rawInfo, d->stringPool) <= 0)) {
+        qCWarning(SSLM, "Ignoring invalid A2S_INFO reply of %s:%u.", qUtf8Printable(address), queryPort);
+        return false;
+    }
+
+    ServerCatalog::Entry e = ServerCatalog::toEntry(&d->parser);
+    e.address = address;
+    e.queryPort = queryPort;
+    update(e);
+    return true;
+}
+
+void ServerListModel::flush()
+{
+    Q_D(ServerListModel);
+    d->timer.stop();
+    if (d->pending.isEmpty()) {
+        return;
+    }
+
+    QVector<ServerCatalog::Entry> appended;
+    QVector<QPair<int,quint32>> changed;
+    changed.reserve(d->pending.size());
+
+    for (auto it = d->pending.constBegin(); it != d->pending.constEnd(); ++it) {
+        const int r = d->rowByKey.value(it.key(), -1);
+        if (r < 0) {
+            appended.append(it.value());
+            continue;
+        }
+        ServerCatalog::Entry &current = d->rows[r];
+        const quint32 mask = ServerListModelPrivate::changedRoles(current, it.value());
+        current = it.value();
+        if (mask) {
+            changed.append(qMakePair(r, mask));
+        }
+    }
+    d->pending.clear();
+
+    // adjacent rows are reported together with the union of their changed roles
+    std::sort(changed.begin(), changed.end());
+    int i = 0;
+    while (i < changed.size()) {
+        const int first = changed.at(i).first;
+        int last = first;
+        quint32 mask = changed.at(i).second;
+        ++i;
+        while ((i < changed.size()) && (changed.at(i).first == last + 1)) {
+            last = changed.at(i).first;
+            mask |= changed.at(i).second;
+            ++i;
+        }
+        Q_EMIT dataChanged(index(first), index(last), ServerListModelPrivate::roles(mask));
+    }
+
+    if (!appended.isEmpty()) {
+        const int first = d->rows.size();
+        beginInsertRows(QModelIndex(), first, first + appended.size() - 1);
+        d->rows.append(appended);
+        d->reindex(first);
+        endInsertRows();
+        Q_EMIT countChanged(d->rows.size());
+    }
+}
+
+void ServerListModel::clear()
+{
+    Q_D(ServerListModel);
+    d->pending.clear();
+    d->timer.stop();
+    if (d->rows.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    d->rows.clear();
+    d->rowByKey.clear();
+    endResetModel();
+    Q_EMIT countChanged(0);
+}
+
+QString ServerListModelPrivate::key(const QString &address, quint16 queryPort)
+{
+    return address + QLatin1Char(':') + QString::number(queryPort);
+}
+
+quint32 ServerListModelPrivate::changedRoles(const ServerCatalog::Entry &a, const ServerCatalog::Entry &b)
+{
+    quint32 mask = 0;
+    auto mark = [&mask](bool differs, int role) {
+        if (differs) {
+            mask |= (1U << (role - ServerListModel::AddressRole));
+        }
+    };
+    // the cheap fixed fields change most often, so they come first
+    mark(a.players != b.players, ServerListModel::PlayersRole);
+    mark(a.bots != b.bots, ServerListModel::BotsRole);
+    mark(a.maxPlayers != b.maxPlayers, ServerListModel::MaxPlayersRole);
+    mark(a.appId != b.appId, ServerListModel::AppIdRole);
+    mark(a.gamePort != b.gamePort, ServerListModel::GamePortRole);
+    mark(a.serverType != b.serverType, ServerListModel::ServerTypeRole);
+    mark(a.environment != b.environment, ServerListModel::EnvironmentRole);
+    mark(a.visibility != b.visibility, ServerListModel::VisibilityRole);
+    mark(a.vac != b.vac, ServerListModel::VacRole);
+    mark(a.name != b.name, ServerListModel::NameRole);
+    mark(a.map != b.map, ServerListModel::MapRole);
+    mark(a.folder != b.folder, ServerListModel::FolderRole);
+    mark(a.game != b.game, ServerListModel::GameRole);
+    mark(a.version != b.version, ServerListModel::VersionRole);
+    mark(a.keywords != b.keywords, ServerListModel::KeywordsRole);
+    return mask;
+}
+
+QVector<int> ServerListModelPrivate::roles(quint32 mask)
+{
+    QVector<int> lst;
+    for (int role = ServerListModel::AddressRole; role <= ServerListModel::VacRole; ++role) {
+        if (mask & (1U << (role - ServerListModel::AddressRole))) {
+            lst.append(role);
+        }
+    }
+    if (mask & (1U << (ServerListModel::NameRole - ServerListModel::AddressRole))) {
+        lst.append(Qt::DisplayRole);
+    }
+    return lst;
+}
+
+void ServerListModelPrivate::schedule()
+{
+    if (!timer.isActive()) {
+        timer.start();
+    }
+}
+
+void ServerListModelPrivate::reindex(int from)
+{
+    for (int i = from; i < rows.size(); ++i) {
+        const ServerCatalog::Entry &e = rows.at(i);
+        rowByKey.insert(key(e.address, e.queryPort), i);
+    }
+}
+
+#include "moc_serverlistmodel.cpp"
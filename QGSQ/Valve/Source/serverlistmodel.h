@@ -0,0 +1,116 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERLISTMODEL_H
+#define QGSQ_VALVE_SOURCE_SERVERLISTMODEL_H
+
+#include "qgsq_global.h"
+#include "servercatalog.h"
+#include <QAbstractListModel>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerListModelPrivate;
+class ServerQuery;
+class StringPool;
+
+/*
+ * List model of servers for views and QML. Rows are plain values, no
+ * ServerInfo objects are kept. Updates are queued and applied in batches
+ * every updateInterval milliseconds: new servers are inserted with a single
+ * insert, changed rows are compared field by field and adjacent rows are
+ * reported with one dataChanged() containing only the changed roles.
+ * Use ServerListProxyModel for sorting and filtering.
+ */
+class QGSQ_LIBRARY ServerListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+public:
+    enum Roles {
+        AddressRole = Qt::UserRole + 1,
+        QueryPortRole,
+        NameRole,
+        MapRole,
+        FolderRole,
+        GameRole,
+        VersionRole,
+        KeywordsRole,
+        GamePortRole,
+        AppIdRole,
+        PlayersRole,
+        MaxPlayersRole,
+        BotsRole,
+        ServerTypeRole,
+        EnvironmentRole,
+        VisibilityRole,
+        VacRole
+    };
+    Q_ENUM(Roles)
+
+    explicit ServerListModel(QObject *parent = nullptr);
+
+    ~ServerListModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int,QByteArray> roleNames() const override;
+
+    int count() const;
+
+    int updateInterval() const;
+    void setUpdateInterval(int msecs);
+
+    StringPool *stringPool() const;
+    void setStringPool(StringPool *pool);
+
+    void track(ServerQuery *query);
+
+    Q_INVOKABLE void addServer(const QString &address, quint16 queryPort);
+    Q_INVOKABLE bool removeServer(const QString &address, quint16 queryPort);
+    Q_INVOKABLE int row(const QString &address, quint16 queryPort) const;
+    ServerCatalog::Entry entry(int row) const;
+
+    void update(const ServerInfo *serverInfo);
+    void update(const ServerCatalog::Entry &entry);
+    bool updateRaw(const QString &address, quint16 queryPort, const QByteArray &rawInfo);
+
+    Q_INVOKABLE void flush();
+    Q_INVOKABLE void clear();
+
+Q_SIGNALS:
+    void countChanged(int count);
+    void updateIntervalChanged(int updateInterval);
+
+protected:
+    const QScopedPointer<ServerListModelPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(ServerListModel)
+    Q_DECLARE_PRIVATE(ServerListModel)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SERVERLISTMODEL_H
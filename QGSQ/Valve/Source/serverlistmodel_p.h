@@ -0,0 +1,56 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERLISTMODEL_P_H
+#define QGSQ_VALVE_SOURCE_SERVERLISTMODEL_P_H
+
+#include "serverlistmodel.h"
+#include "serverinfo.h"
+#include <QTimer>
+#include <QHash>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerListModelPrivate
+{
+public:
+    static QString key(const QString &address, quint16 queryPort);
+    static quint32 changedRoles(const ServerCatalog::Entry &a, const ServerCatalog::Entry &b);
+    static QVector<int> roles(quint32 mask);
+    void schedule();
+    void reindex(int from);
+
+    Q_DECLARE_PUBLIC(ServerListModel)
+    ServerListModel *q_ptr = nullptr;
+    QVector<ServerCatalog::Entry> rows;
+    QHash<QString,int> rowByKey;
+    QHash<QString,ServerCatalog::Entry> pending;
+    QTimer timer;
+    // reused to decode raw replies, nothing is connected to it
+    ServerInfo parser;
+    StringPool *stringPool = nullptr;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SERVERLISTMODEL_P_H
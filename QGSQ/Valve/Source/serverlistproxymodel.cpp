@@ -0,0 +1,149 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "serverlistproxymodel_p.h"
+#include "serverlistmodel.h"
+
+using namespace QGSQ::Valve::Source;
+
+ServerListProxyModel::ServerListProxyModel(QObject *parent) : QSortFilterProxyModel(parent), d_ptr(new ServerListProxyModelPrivate)
+{
+    setSortRole(ServerListModel::NameRole);
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+    setDynamicSortFilter(true);
+    sort(0, Qt::AscendingOrder);
+}
+
+ServerListProxyModel::~ServerListProxyModel()
+{
+
+}
+
+QString ServerListProxyModel::search() const
+{
+    Q_D(const ServerListProxyModel);
+    return d->search;
+}
+
+void ServerListProxyModel::setSearch(const QString &search)
+{
+    Q_D(ServerListProxyModel);
+    if (d->search != search) {
+        d->search = search;
+        invalidateFilter();
+        Q_EMIT searchChanged(search);
+    }
+}
+
+int ServerListProxyModel::appId() const
+{
+    Q_D(const ServerListProxyModel);
+    return d->appId;
+}
+
+void ServerListProxyModel::setAppId(int appId)
+{
+    Q_D(ServerListProxyModel);
+    if (d->appId != appId) {
+        d->appId = appId;
+        invalidateFilter();
+        Q_EMIT appIdChanged(appId);
+    }
+}
+
+bool ServerListProxyModel::hideEmpty() const
+{
+    Q_D(const ServerListProxyModel);
+    return d->hideEmpty;
+}
+
+void ServerListProxyModel::setHideEmpty(bool hideEmpty)
+{
+    Q_D(ServerListProxyModel);
+    if (d->hideEmpty != hideEmpty) {
+        d->hideEmpty = hideEmpty;
+        invalidateFilter();
+        Q_EMIT hideEmptyChanged(hideEmpty);
+    }
+}
+
+bool ServerListProxyModel::hideFull() const
+{
+    Q_D(const ServerListProxyModel);
+    return d->hideFull;
+}
+
+void ServerListProxyModel::setHideFull(bool hideFull)
+{
+    Q_D(ServerListProxyModel);
+    if (d->hideFull != hideFull) {
+        d->hideFull = hideFull;
+        invalidateFilter();
+        Q_EMIT hideFullChanged(hideFull);
+    }
+}
+
+bool ServerListProxyModel::hidePrivate() const
+{
+    Q_D(const ServerListProxyModel);
+    return d->hidePrivate;
+}
+
+void ServerListProxyModel::setHidePrivate(bool hidePrivate)
+{
+    Q_D(ServerListProxyModel);
+    if (d->hidePrivate != hidePrivate) {
+        d->hidePrivate = hidePrivate;
+        invalidateFilter();
+        Q_EMIT hidePrivateChanged(hidePrivate);
+    }
+}
+
+bool ServerListProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_D(const ServerListProxyModel);
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+
+    if ((d->appId >= 0) && (idx.data(ServerListModel::AppIdRole).toInt() != d->appId)) {
+        return false;
+    }
+
+    if (d->hideEmpty || d->hideFull) {
+        const int players = idx.data(ServerListModel::PlayersRole).toInt();
+        if (d->hideEmpty && (players == 0)) {
+            return false;
+        }
+        if (d->hideFull && (players >= idx.data(ServerListModel::MaxPlayersRole).toInt())) {
+            return false;
+        }
+    }
+
+    if (d->hidePrivate && (idx.data(ServerListModel::VisibilityRole).toInt() != 0)) {
+        return false;
+    }
+
+    if (!d->search.isEmpty()) {
+        return idx.data(ServerListModel::NameRole).toString().contains(d->search, Qt::CaseInsensitive)
+                || idx.data(ServerListModel::MapRole).toString().contains(d->search, Qt::CaseInsensitive);
+    }
+
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
+
+#include "moc_serverlistproxymodel.cpp"
@@ -0,0 +1,86 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_H
+#define QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_H
+
+#include "qgsq_global.h"
+#include <QSortFilterProxyModel>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerListProxyModelPrivate;
+
+/*
+ * Sorts and filters a ServerListModel without querying servers again. The
+ * sort role defaults to the name, sorting and filtering are dynamic, so
+ * batched updates of the source model only move the affected rows.
+ */
+class QGSQ_LIBRARY ServerListProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString search READ search WRITE setSearch NOTIFY searchChanged)
+    Q_PROPERTY(int appId READ appId WRITE setAppId NOTIFY appIdChanged)
+    Q_PROPERTY(bool hideEmpty READ hideEmpty WRITE setHideEmpty NOTIFY hideEmptyChanged)
+    Q_PROPERTY(bool hideFull READ hideFull WRITE setHideFull NOTIFY hideFullChanged)
+    Q_PROPERTY(bool hidePrivate READ hidePrivate WRITE setHidePrivate NOTIFY hidePrivateChanged)
+public:
+    explicit ServerListProxyModel(QObject *parent = nullptr);
+
+    ~ServerListProxyModel();
+
+    QString search() const;
+    void setSearch(const QString &search);
+
+    int appId() const;
+    void setAppId(int appId);
+
+    bool hideEmpty() const;
+    void setHideEmpty(bool hideEmpty);
+
+    bool hideFull() const;
+    void setHideFull(bool hideFull);
+
+    bool hidePrivate() const;
+    void setHidePrivate(bool hidePrivate);
+
+Q_SIGNALS:
+    void searchChanged(const QString &search);
+    void appIdChanged(int appId);
+    void hideEmptyChanged(bool hideEmpty);
+    void hideFullChanged(bool hideFull);
+    void hidePrivateChanged(bool hidePrivate);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+    const QScopedPointer<ServerListProxyModelPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(ServerListProxyModel)
+    Q_DECLARE_PRIVATE(ServerListProxyModel)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_H
@@ -0,0 +1,43 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_P_H
+#define QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_P_H
+
+#include "serverlistproxymodel.h"
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class ServerListProxyModelPrivate
+{
+public:
+    QString search;
+    int appId = -1;
+    bool hideEmpty = false;
+    bool hideFull = false;
+    bool hidePrivate = false;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SERVERLISTPROXYMODEL_P_H
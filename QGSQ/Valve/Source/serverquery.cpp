@@ -20,9 +20,14 @@
 #include "serverquery_p.h"
 #include "serverinfo.h"
 #include "player.h"
+#include "a2slayout_p.h"
 #include "response.h"
-#include <QNetworkDatagram>
+#include "querymetrics.h"
+#include "querytracer.h"
 #include <QLoggingCategory>
+#include <QPointer>
+#include <QTimer>
+#include <memory>
 
 Q_LOGGING_CATEGORY(SQ, "qgsq.valve.source.serverquery")
 
@@ -60,7 +65,15 @@ ServerQuery::ServerQuery(ServerQueryPrivate &dd, QObject *parent) :
 
 ServerQuery::~ServerQuery()
 {
-
+    Q_D(ServerQuery);
+    // requests on a shared engine must not call back into the deleted object
+    if (d->sharedEngine) {
+        const QSet<quint32> requests = d->requests;
+        d->requests.clear();
+        for (quint32 requestId : requests) {
+            d->sharedEngine->abort(requestId);
+        }
+    }
 }
 
 bool ServerQuery::isValid() const
@@ -126,6 +139,118 @@ void ServerQuery::setTimeout(int timeout)
     }
 }
 
+QueryMetrics *ServerQuery::metrics() const
+{
+    Q_D(const ServerQuery);
+    return d->metrics;
+}
+
+void ServerQuery::setMetrics(QueryMetrics *metrics)
+{
+    Q_D(ServerQuery);
+    d->metrics = metrics;
+}
+
+QueryTracer *ServerQuery::tracer() const
+{
+    Q_D(const ServerQuery);
+    return d->tracer;
+}
+
+void ServerQuery::setTracer(QueryTracer *tracer)
+{
+    Q_D(ServerQuery);
+    d->tracer = tracer;
+}
+
+PacketCapture *ServerQuery::capture() const
+{
+    Q_D(const ServerQuery);
+    return d->capture;
+}
+
+void ServerQuery::setCapture(PacketCapture *capture)
+{
+    Q_D(ServerQuery);
+    d->capture = capture;
+}
+
+StringPool *ServerQuery::stringPool() const
+{
+    Q_D(const ServerQuery);
+    return d->stringPool;
+}
+
+void ServerQuery::setStringPool(StringPool *pool)
+{
+    Q_D(ServerQuery);
+    d->stringPool = pool;
+}
+
+InfoFilter *ServerQuery::infoFilter() const
+{
+    Q_D(const ServerQuery);
+    return d->infoFilter;
+}
+
+void ServerQuery::setInfoFilter(InfoFilter *filter)
+{
+    Q_D(ServerQuery);
+    d->infoFilter = filter;
+}
+
+DatagramTransportFactory *ServerQuery::transportFactory() const
+{
+    Q_D(const ServerQuery);
+    return d->transportFactory;
+}
+
+void ServerQuery::setTransportFactory(DatagramTransportFactory *factory)
+{
+    Q_D(ServerQuery);
+    d->transportFactory = factory;
+}
+
+PacketReplay *ServerQuery::replay() const
+{
+    Q_D(const ServerQuery);
+    return d->replay;
+}
+
+void ServerQuery::setReplay(PacketReplay *replay)
+{
+    Q_D(ServerQuery);
+    d->replay = replay;
+}
+
+QueryEngine *ServerQuery::engine() const
+{
+    Q_D(const ServerQuery);
+    return d->sharedEngine;
+}
+
+void ServerQuery::setEngine(QueryEngine *engine)
+{
+    Q_D(ServerQuery);
+    if (d->sharedEngine == engine) {
+        return;
+    }
+
+    if (Q_UNLIKELY(!d->requests.isEmpty())) {
+        qCWarning(SQ, "Can not change the engine while %i requests are pending.", d->requests.size());
+        return;
+    }
+
+    if (d->sharedEngine) {
+        d->sharedEngine->disconnect(this);
+    }
+    d->sharedEngine = engine;
+    if (engine) {
+        d->connectEngine(engine);
+        connect(engine, &QObject::destroyed, this, [d](){d->dropRequests();});
+    }
+}
+
 ServerInfo *ServerQuery::getInfo(QObject *parent) const
 {
     ServerInfo *si = nullptr;
@@ -134,17 +259,45 @@ ServerInfo *ServerQuery::getInfo(QObject *parent) const
     const QByteArray ba = getRawInfo();
     if (Q_LIKELY(!ba.isEmpty())) {
         si = new ServerInfo(d->server.toString(), d->port, parent);
-        si->setRawData(ba);
+        si->setRawData(ba, d->stringPool);
     }
 
     return si;
 }
 
-void ServerQuery::getInfoAsync()
+quint32 ServerQuery::getInfoAsync()
 {
     Q_D(ServerQuery);
-    d->serverInfoCon = QObject::connect(this, &QGSQ::Valve::Source::ServerQuery::gotRawInfo, [d](){d->processServerInfo();});
-    getRawInfoAsync();
+    const QString address = d->server.toString();
+    const quint16 port = d->port;
+    return d->startRequest(A2SProtocol::Info, [this, d, address, port](quint32 id, const QByteArray &data){
+        if (!d->acceptInfo(data)) {
+            return false;
+        }
+        Q_EMIT gotRawInfo(data);
+        if (!data.isEmpty()) {
+            ServerInfo *si = ServerInfo::fromRawData(data, address, port, nullptr, d->stringPool);
+            d->trace(id, QueryTracer::ParseDone);
+            Q_EMIT gotInfo(si);
+        }
+        return true;
+    });
+}
+
+QFuture<ServerInfo*> ServerQuery::getInfoFuture()
+{
+    Q_D(ServerQuery);
+    auto reporter = std::make_shared<FutureReporter<ServerInfo*>>();
+    const QString address = d->server.toString();
+    const quint16 port = d->port;
+    d->startRequest(A2SProtocol::Info, [reporter, d, address, port](quint32 id, const QByteArray &data){
+        const bool accepted = d->acceptInfo(data);
+        ServerInfo *si = (data.isEmpty() || !accepted) ? nullptr : ServerInfo::fromRawData(data, address, port, nullptr, d->stringPool);
+        d->trace(id, QueryTracer::ParseDone);
+        reporter->finish(si);
+        return accepted;
+    });
+    return reporter->future();
 }
 
 QByteArray ServerQuery::getRawInfo() const
@@ -155,24 +308,47 @@ QByteArray ServerQuery::getRawInfo() const
 
     qCInfo(SQ, "Start requesting server info (A2S_INFO) from %s:%u.", qUtf8Printable(d->server.toString()), d->port);
 
-    const auto data = d->getRawData(QByteArrayLiteral("\xff\xff\xff\xffTSource Engine Query\0"));
+    const auto data = d->getRawData(A2SProtocol::Info);
 
-    if (Q_UNLIKELY(data.isEmpty() || (!data.startsWith('I') || data.startsWith('m')))) {
+    if (Q_UNLIKELY(data.isEmpty())) {
         qCCritical(SQ, "Received invalid response to A2S_INFO query.");
         return ba;
     }
 
     qCInfo(SQ, "Finished requesting server info (A2S_INFO from %s:%u", qUtf8Printable(d->server.toString()), d->port);
 
+    if (!d->acceptInfo(data)) {
+        qCDebug(SQ, "Server info of %s:%u rejected by the info filter.", qUtf8Printable(d->server.toString()), d->port);
+        return ba;
+    }
+
     ba = data;
 
     return ba;
 }
 
-void ServerQuery::getRawInfoAsync()
+quint32 ServerQuery::getRawInfoAsync()
 {
     Q_D(ServerQuery);
-    d->getRawDataAsync(QByteArrayLiteral("\xff\xff\xff\xffTSource Engine Query\0"));
+    return d->startRequest(A2SProtocol::Info, [this, d](quint32, const QByteArray &data){
+        if (!d->acceptInfo(data)) {
+            return false;
+        }
+        Q_EMIT gotRawInfo(data);
+        return true;
+    });
+}
+
+QFuture<QByteArray> ServerQuery::getRawInfoFuture()
+{
+    Q_D(ServerQuery);
+    auto reporter = std::make_shared<FutureReporter<QByteArray>>();
+    d->startRequest(A2SProtocol::Info, [reporter, d](quint32, const QByteArray &data){
+        const bool accepted = d->acceptInfo(data);
+        reporter->finish(accepted ? data : QByteArray());
+        return accepted;
+    });
+    return reporter->future();
 }
 
 QHash<QString,QString> ServerQuery::getRules() const
@@ -195,17 +371,9 @@ QByteArray ServerQuery::getRawRules() const
 
     qCInfo(SQ, "Start requesting server rules (A2S_RULES) from %s:%u.", qUtf8Printable(d->server.toString()), d->port);
 
-    const auto challenge = d->getChallenge('V');
+    const auto data = d->getRawData(A2SProtocol::Rules);
 
-    if (Q_UNLIKELY(challenge.isEmpty())) {
-        return ba;
-    }
-
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + 'V' + challenge;
-
-    const auto data = d->getRawData(request);
-
-    if (Q_UNLIKELY(data.isEmpty() || !data.startsWith('E'))) {
+    if (Q_UNLIKELY(data.isEmpty())) {
         qCCritical(SQ, "Received invalid response to A2S_RULES query.");
         return ba;
     }
@@ -217,18 +385,51 @@ QByteArray ServerQuery::getRawRules() const
     return ba;
 }
 
-void ServerQuery::getRawRulesAsync()
+quint32 ServerQuery::getRawRulesAsync()
+{
+    Q_D(ServerQuery);
+    return d->startRequest(A2SProtocol::Rules, [this](quint32, const QByteArray &data){
+        Q_EMIT gotRawRules(data);
+        return true;
+    });
+}
+
+quint32 ServerQuery::getRulesAsync()
+{
+    Q_D(ServerQuery);
+    return d->startRequest(A2SProtocol::Rules, [this, d](quint32 id, const QByteArray &data){
+        Q_EMIT gotRawRules(data);
+        if (!data.isEmpty()) {
+            const auto rules = d->extractRules(data);
+            d->trace(id, QueryTracer::ParseDone);
+            Q_EMIT gotRules(rules);
+        }
+        return true;
+    });
+}
+
+QFuture<QByteArray> ServerQuery::getRawRulesFuture()
 {
     Q_D(ServerQuery);
-    d->gotChallengeToProcessRulesChallengeCon = QObject::connect(this, &QGSQ::Valve::Source::ServerQuery::gotChallenge, [d](const QByteArray &challenge){d->processRulesChallenge(challenge);});
-    d->getChallengeAsync('V');
+    auto reporter = std::make_shared<FutureReporter<QByteArray>>();
+    d->startRequest(A2SProtocol::Rules, [reporter](quint32, const QByteArray &data){
+        reporter->finish(data);
+        return true;
+    });
+    return reporter->future();
 }
 
-void ServerQuery::getRulesAsync()
+QFuture<QHash<QString,QString>> ServerQuery::getRulesFuture()
 {
     Q_D(ServerQuery);
-    d->rulesCon = QObject::connect(this, &QGSQ::Valve::Source::ServerQuery::gotRawRules, [d](const QByteArray &rules){d->processRules(rules);});
-    getRawRulesAsync();
+    auto reporter = std::make_shared<FutureReporter<QHash<QString,QString>>>();
+    d->startRequest(A2SProtocol::Rules, [reporter, d](quint32 id, const QByteArray &data){
+        const auto rules = d->extractRules(data);
+        d->trace(id, QueryTracer::ParseDone);
+        reporter->finish(rules);
+        return true;
+    });
+    return reporter->future();
 }
 
 QList<Player*> ServerQuery::getPlayers(QObject *parent) const
@@ -251,17 +452,9 @@ QByteArray ServerQuery::getRawPlayers() const
 
     qCInfo(SQ, "Start requesting players (A2S_PLAYER) from %s:%u.", qUtf8Printable(d->server.toString()), d->port);
 
-    const auto challenge = d->getChallenge('U');
-
-    if (Q_UNLIKELY(challenge.isEmpty())) {
-        return ba;
-    }
-
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + 'U' + challenge;
+    const auto data = d->getRawData(A2SProtocol::Players);
 
-    const auto data = d->getRawData(request);
-
-    if (Q_UNLIKELY(data.isEmpty() || !data.startsWith('D'))) {
+    if (Q_UNLIKELY(data.isEmpty())) {
         qCCritical(SQ, "Received invalid resposne to A2S_PLAYER query.");
         return ba;
     }
@@ -273,107 +466,261 @@ QByteArray ServerQuery::getRawPlayers() const
     return ba;
 }
 
-void ServerQuery::getRawPlayersAsync()
+quint32 ServerQuery::getRawPlayersAsync()
 {
     Q_D(ServerQuery);
-    d->gotChallengeToProcessPlayersChallengeCon = QObject::connect(this, &QGSQ::Valve::Source::ServerQuery::gotChallenge, [d](const QByteArray &challenge){d->processPlayersChallenge(challenge);});
-    d->getChallengeAsync('U');
+    return d->startRequest(A2SProtocol::Players, [this](quint32, const QByteArray &data){
+        Q_EMIT gotRawPlayers(data);
+        return true;
+    });
 }
 
-void ServerQuery::getPlayersAsync()
+quint32 ServerQuery::getPlayersAsync()
 {
     Q_D(ServerQuery);
-    d->playersCon = QObject::connect(this, &QGSQ::Valve::Source::ServerQuery::gotRawPlayers, [d](const QByteArray &players){d->processPlayers(players);});
-    getRawPlayersAsync();
+    return d->startRequest(A2SProtocol::Players, [this, d](quint32 id, const QByteArray &data){
+        Q_EMIT gotRawPlayers(data);
+        if (!data.isEmpty()) {
+            const auto players = d->extractPlayers(data);
+            d->trace(id, QueryTracer::ParseDone);
+            Q_EMIT gotPlayers(players);
+        }
+        return true;
+    });
 }
 
-bool ServerQuery::event(QEvent *event)
+QFuture<QByteArray> ServerQuery::getRawPlayersFuture()
 {
-    return QObject::event(event);
+    Q_D(ServerQuery);
+    auto reporter = std::make_shared<FutureReporter<QByteArray>>();
+    d->startRequest(A2SProtocol::Players, [reporter](quint32, const QByteArray &data){
+        reporter->finish(data);
+        return true;
+    });
+    return reporter->future();
 }
 
-QByteArray ServerQueryPrivate::getRawData(const QByteArray &request) const
+QFuture<QList<Player*>> ServerQuery::getPlayersFuture()
 {
-    QByteArray ba;
+    Q_D(ServerQuery);
+    auto reporter = std::make_shared<FutureReporter<QList<Player*>>>();
+    d->startRequest(A2SProtocol::Players, [reporter, d](quint32 id, const QByteArray &data){
+        const auto players = d->extractPlayers(data);
+        d->trace(id, QueryTracer::ParseDone);
+        reporter->finish(players);
+        return true;
+    });
+    return reporter->future();
+}
 
-    if (server.isNull()) {
-        qCCritical(SQ, "Failed to send request, invalid host address.");
-        return ba;
-    }
+int ServerQuery::pendingRequests() const
+{
+    Q_D(const ServerQuery);
+    return d->requests.size();
+}
 
-    if (!port) {
-        qCCritical(SQ, "Failed to send request, invalid query port.");
-        return ba;
+bool ServerQuery::abort(quint32 requestId)
+{
+    Q_D(ServerQuery);
+    // removed first, so the engine does not deliver the failed request
+    if (!d->requests.remove(requestId)) {
+        return false;
     }
+    qCDebug(SQ, "Aborting request %u.", requestId);
+    d->setRunning(!d->requests.isEmpty());
+    QueryEngine *engine = d->sharedEngine ? d->sharedEngine.data() : d->ownEngine;
+    engine->abort(requestId);
+    Q_EMIT requestFinished(requestId, false);
+    return true;
+}
 
-    QUdpSocket udp;
-    auto responseComplete = false;
-    auto noTimeout = true;
-    auto invalidData = false;
-
-    qCDebug(SQ, "Sending request \"%s\" to %s:%u.", request.toHex().constData(), qUtf8Printable(server.toString()), port);
-    if (Q_UNLIKELY(udp.writeDatagram(request, server, port) != request.size())) {
-        qCCritical(SQ, "Failed to send request to %s:%u.", qUtf8Printable(server.toString()), port);
-        return ba;
+QList<QByteArray> ServerQuery::getRawInfo(const QList<ServerQuery*> &queries, int timeout)
+{
+    QList<QByteArray> data = ServerQueryPrivate::getRawDataBatch(queries, A2SProtocol::Info, timeout);
+    for (int i = 0; i < data.size(); ++i) {
+        if (!queries.at(i)->d_func()->acceptInfo(data.at(i))) {
+            data[i].clear();
+        }
     }
+    return data;
+}
 
-    QByteArray rcvData;
-    while (!responseComplete && noTimeout && !invalidData) {
-        noTimeout = udp.waitForReadyRead(timeout);
-        if (noTimeout) {
-            const auto data = udp.receiveDatagram().data();
-            qCDebug(SQ) << "Received data:" << data;
-            const auto leftData = data.left(4);
-            if (leftData == QByteArrayLiteral("\xff\xff\xff\xff")) {
-                responseComplete = true;
-                rcvData = data.mid(4);
-            } else if (leftData == QByteArrayLiteral("\xfe\xff\xff\xff")) {
-
-            } else {
-                invalidData = true;
-            }
-        }
+QList<ServerInfo*> ServerQuery::getInfo(const QList<ServerQuery*> &queries, int timeout, QObject *parent)
+{
+    const QList<QByteArray> data = getRawInfo(queries, timeout);
+    QList<ServerInfo*> infos;
+    infos.reserve(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        const QByteArray &ba = data.at(i);
+        infos.append(ba.isEmpty() ? nullptr : ServerInfo::fromRawData(ba, queries.at(i)->server(), queries.at(i)->port(), parent, queries.at(i)->stringPool()));
     }
+    return infos;
+}
 
-    if (Q_UNLIKELY(invalidData)) {
-        qCCritical(SQ, "Received invalid data.");
-        return ba;
+QList<QByteArray> ServerQuery::getRawRules(const QList<ServerQuery*> &queries, int timeout)
+{
+    return ServerQueryPrivate::getRawDataBatch(queries, A2SProtocol::Rules, timeout);
+}
+
+QList<QHash<QString,QString>> ServerQuery::getRules(const QList<ServerQuery*> &queries, int timeout)
+{
+    const QList<QByteArray> data = ServerQueryPrivate::getRawDataBatch(queries, A2SProtocol::Rules, timeout);
+    QList<QHash<QString,QString>> rules;
+    rules.reserve(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        rules.append(data.at(i).isEmpty() ? QHash<QString,QString>() : queries.at(i)->d_func()->extractRules(data.at(i)));
     }
+    return rules;
+}
 
-    if (Q_UNLIKELY(!noTimeout)) {
-        qCCritical(SQ, "Timeout within %ims while wating for reply.", timeout);
-        return ba;
+QList<QByteArray> ServerQuery::getRawPlayers(const QList<ServerQuery*> &queries, int timeout)
+{
+    return ServerQueryPrivate::getRawDataBatch(queries, A2SProtocol::Players, timeout);
+}
+
+QList<QList<Player*>> ServerQuery::getPlayers(const QList<ServerQuery*> &queries, int timeout, QObject *parent)
+{
+    const QList<QByteArray> data = ServerQueryPrivate::getRawDataBatch(queries, A2SProtocol::Players, timeout);
+    QList<QList<Player*>> players;
+    players.reserve(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        players.append(data.at(i).isEmpty() ? QList<Player*>() : queries.at(i)->d_func()->extractPlayers(data.at(i), parent));
     }
+    return players;
+}
 
-    ba = rcvData;
+bool ServerQuery::event(QEvent *event)
+{
+    return QObject::event(event);
+}
 
-    return ba;
+QByteArray ServerQueryPrivate::getRawData(A2SProtocol::Type type) const
+{
+    // a single server is a batch of one, so challenges are handled like in all other queries
+    ServerQueryBatch batch(type, timeout);
+    batch.add(this);
+    return batch.run().first();
 }
 
-QByteArray ServerQueryPrivate::getChallenge(char header) const
+ServerQueryPrivate::~ServerQueryPrivate()
 {
-    QByteArray ba;
 
-    qCInfo(SQ, "Requesting challenge with header '%c' from %s:%u.", header, qUtf8Printable(server.toString()), port);
+}
 
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + header + QByteArrayLiteral("\xff\xff\xff\xff");
+quint32 ServerQueryPrivate::startRequest(A2SProtocol::Type type, const Callback &done)
+{
+    Q_Q(ServerQuery);
+    QPointer<ServerQuery> guard(q);
 
-    const auto data = getRawData(request);
+    if (Q_UNLIKELY(server.isNull() || !port)) {
+        qCCritical(SQ, "Failed to send request, invalid server address %s:%u.", qUtf8Printable(server.toString()), port);
+        if (metrics) {
+            metrics->add(QueryMetrics::RequestsFailed);
+        }
+        // reported after the caller got the id, like every other result
+        QTimer::singleShot(0, q, [guard, done](){
+            done(0, QByteArray());
+            // the callback might have deleted the ServerQuery
+            if (guard) {
+                Q_EMIT guard->requestFinished(0, false);
+            }
+        });
+        return 0;
+    }
 
-    if (data.isEmpty() || (data.size() != 5) || (data.at(0) != 'A')) {
-        qCCritical(SQ, "Received invalid response to challenge request.");
-        return ba;
+    const quint32 id = queryEngine()->query(A2SProtocol::instance(), server, port, type, timeout, [this, guard, done](quint32 requestId, const QByteArray &data){
+        // aborted requests and requests of a deleted ServerQuery are not delivered
+        if (!guard || !requests.remove(requestId)) {
+            return;
+        }
+        setRunning(!requests.isEmpty());
+        // info replies rejected by the info filter do not count as success
+        const bool accepted = done(requestId, data);
+        // the callback might have deleted the ServerQuery
+        if (guard) {
+            Q_EMIT guard->requestFinished(requestId, accepted && !data.isEmpty());
+        }
+    });
+
+    requests.insert(id);
+    setRunning(true);
+    return id;
+}
+
+DatagramTransport *ServerQueryPrivate::createTransport() const
+{
+    if (transportFactory) {
+        return transportFactory->createTransport();
     }
+    return new UdpSocketTransport;
+}
 
-    ba = data.mid(1, 4);
+QueryEngine *ServerQueryPrivate::queryEngine()
+{
+    if (sharedEngine) {
+        return sharedEngine;
+    }
 
-    return ba;
+    if (!ownEngine) {
+        Q_Q(ServerQuery);
+        ownEngine = new QueryEngine(q);
+        connectEngine(ownEngine);
+    }
+
+    // the own engine always runs with the current settings
+    ownEngine->setMetrics(metrics);
+    ownEngine->setTracer(tracer);
+    ownEngine->setCapture(capture);
+    ownEngine->setReplay(replay);
+    ownEngine->setTransportFactory(transportFactory);
+    return ownEngine;
 }
 
-void ServerQueryPrivate::getChallengeAsync(char header)
+void ServerQueryPrivate::connectEngine(QueryEngine *engine)
 {
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + header + QByteArrayLiteral("\xff\xff\xff\xff");
-    getRawDataAsync(request);
+    Q_Q(ServerQuery);
+    QObject::connect(engine, &QueryEngine::gotChallenge, q, [this](quint32 requestId, const QByteArray &challenge){
+        if (requests.contains(requestId)) {
+            Q_Q(ServerQuery);
+            Q_EMIT q->gotChallenge(challenge);
+        }
+    });
+}
+
+void ServerQueryPrivate::dropRequests()
+{
+    // a deleted engine does not finish its requests
+    const QSet<quint32> dropped = requests;
+    requests.clear();
+    setRunning(false);
+    Q_Q(ServerQuery);
+    QPointer<ServerQuery> guard(q);
+    for (quint32 requestId : dropped) {
+        if (!guard) {
+            return;
+        }
+        Q_EMIT q->requestFinished(requestId, false);
+    }
+}
+
+bool ServerQueryPrivate::acceptInfo(const QByteArray &data) const
+{
+    if (!infoFilter || data.isEmpty() || infoFilter->matches(data)) {
+        return true;
+    }
+    if (metrics) {
+        metrics->add(QueryMetrics::FilteredReplies);
+    }
+    return false;
+}
+
+QList<QByteArray> ServerQueryPrivate::getRawDataBatch(const QList<ServerQuery*> &queries, A2SProtocol::Type type, int timeout)
+{
+    ServerQueryBatch batch(type, (timeout > 0) ? timeout : 4000);
+    for (ServerQuery *q : queries) {
+        batch.add(q ? q->d_func() : nullptr);
+    }
+    return batch.run();
 }
 
 void ServerQueryPrivate::setRunning(bool _running)
@@ -385,117 +732,195 @@ void ServerQueryPrivate::setRunning(bool _running)
     }
 }
 
-void ServerQueryPrivate::getRawDataAsync(const QByteArray &request)
+ServerQueryBatch::ServerQueryBatch(A2SProtocol::Type _type, int _timeout) :
+    timeout(_timeout), type(_type)
+{
+    clock.start();
+}
+
+ServerQueryBatch::~ServerQueryBatch()
+{
+    qDeleteAll(entries);
+}
+
+void ServerQueryBatch::add(const ServerQueryPrivate *sq)
 {
-    responseComplete = false;
-    rcvData.clear();
-    if (!udp) {
-        udp = new QUdpSocket(q_ptr);
-        QObject::connect(udp, &QUdpSocket::readyRead, q_ptr, [this](){onUdpReadyRead();});
+    auto e = new Entry;
+    entries.append(e);
+
+    if (Q_UNLIKELY(!sq)) {
+        return;
     }
 
-    timeoutTimer = new QTimer(q_ptr);
-    timeoutTimer->setInterval(timeout + 100);
-    timeoutTimer->setTimerType(Qt::VeryCoarseTimer);
-    QObject::connect(timeoutTimer, &QTimer::timeout, q_ptr, [this](){
-        delete udp;
-        udp = nullptr;
-        timeoutTimer->deleteLater();
-        timeoutTimer = nullptr;
-        qCCritical(SQ, "Timeout within %ims while wating for reply.", timeout);
-    });
+    if (Q_UNLIKELY(sq->server.isNull() || !sq->port)) {
+        qCCritical(SQ, "Failed to send request, invalid server address %s:%u.", qUtf8Printable(sq->server.toString()), sq->port);
+        return;
+    }
 
-    timeoutTimer->start();
+    bool isV4 = false;
+    const quint32 v4 = sq->server.toIPv4Address(&isV4);
+    const auto endpoint = qMakePair(isV4 ? QHostAddress(v4) : sq->server, sq->port);
 
-    qCDebug(SQ, "Sending request \"%s\" to %s:%u.", request.toHex().constData(), qUtf8Printable(server.toString()), port);
-    if (Q_UNLIKELY(udp->writeDatagram(request, server, port) != request.size())) {
-        qCCritical(SQ, "Failed to send request to %s:%u.", qUtf8Printable(server.toString()), port);
+    // the same server is only queried once
+    Entry *first = byEndpoint.value(endpoint);
+    if (first) {
+        e->duplicateOf = first;
+        return;
     }
+
+    e->sq = sq;
+    e->done = false;
+    byEndpoint.insert(endpoint, e);
+    ++pending;
 }
 
-void ServerQueryPrivate::onUdpReadyRead()
+QList<QByteArray> ServerQueryBatch::run()
 {
-    if (udp) {
-        while (!responseComplete && udp->hasPendingDatagrams()) {
-            const auto data = udp->receiveDatagram().data();
-            const auto leftData = data.left(4);
-            if (leftData == QByteArrayLiteral("\xff\xff\xff\xff")) {
-                responseComplete = true;
-                rcvData = data.mid(4);
-                processRcvData();
-            } else if (leftData == QByteArrayLiteral("\xfe\xff\xff\xff")) {
+    for (Entry *e : entries) {
+        if (!e->done) {
+            count(e, QueryMetrics::RequestsStarted);
+            e->elapsed.start();
+            send(e, A2SProtocol::instance()->buildRequest(type, QByteArray()));
+        }
+    }
 
-            } else {
-//                invalidData = true;
+    Datagram datagram;
+    while ((pending > 0) && transport && !clock.hasExpired(timeout)) {
+        // every wait only gets the time left until the deadline, so a trickle of datagrams can not extend the call
+        if (!transport->waitForReadyRead(static_cast<int>(timeout - clock.elapsed()))) {
+            break;
+        }
+        while ((pending > 0) && transport->receiveDatagram(&datagram)) {
+            bool isV4 = false;
+            const quint32 v4 = datagram.sender.toIPv4Address(&isV4);
+            Entry *e = byEndpoint.value(qMakePair(isV4 ? QHostAddress(v4) : datagram.sender, datagram.senderPort));
+            const ServerQueryPrivate *sq = e ? e->sq : transportOwner;
+            if (sq->capture) {
+                sq->capture->record(datagram.sender, datagram.senderPort, transport->localAddress(), transport->localPort(), datagram.data);
             }
+            if (Q_UNLIKELY(!e || e->done)) {
+                qCWarning(SQ, "Dropping unexpected datagram from %s:%u.", qUtf8Printable(datagram.sender.toString()), datagram.senderPort);
+                if (sq->metrics) {
+                    sq->metrics->add(QueryMetrics::PacketsReceived);
+                    sq->metrics->add(QueryMetrics::BytesReceived, static_cast<quint64>(datagram.data.size()));
+                    sq->metrics->add(QueryMetrics::InvalidReplies);
+                }
+                continue;
+            }
+            process(e, datagram.data);
         }
-        if (responseComplete) {
-            delete timeoutTimer;
-            timeoutTimer = nullptr;
+    }
+
+    QList<QByteArray> results;
+    results.reserve(entries.size());
+    for (Entry *e : entries) {
+        if (!e->done) {
+            qCCritical(SQ, "Timeout within %ims while wating for reply from %s:%u.", timeout, qUtf8Printable(e->sq->server.toString()), e->sq->port);
+            count(e, QueryMetrics::Timeouts);
+            finish(e, QByteArray());
         }
+        results.append(e->duplicateOf ? e->duplicateOf->result : e->result);
     }
+
+    return results;
 }
 
-void ServerQueryPrivate::processRcvData()
+void ServerQueryBatch::send(Entry *e, const QByteArray &request)
 {
-    const auto header = rcvData.at(0);
-    Q_Q(ServerQuery);
-    bool deleteSocket = true;
-    if ((header == 'I') || (header == 'm')) {
-        Q_EMIT q->gotRawInfo(rcvData);
-    } else if (header == 'A') {
-        deleteSocket = false;
-        Q_EMIT q->gotChallenge(rcvData.mid(1, 4));
-    } else if (header == 'E') {
-        Q_EMIT q->gotRawRules(rcvData);
-    } else if (header == 'D') {
-        Q_EMIT q->gotRawPlayers(rcvData);
+    const ServerQueryPrivate *sq = e->sq;
+    count(e, QueryMetrics::PacketsSent);
+    count(e, QueryMetrics::BytesSent, static_cast<quint64>(request.size()));
+
+    // blocking queries replay the recorded replies without delay
+    if (sq->replay) {
+        const auto packets = sq->replay->replay(sq->server, sq->port, request, e->replayConversation);
+        for (const PacketReplay::Packet &packet : packets) {
+            if (e->done) {
+                break;
+            }
+            process(e, packet.data);
+        }
+        return;
     }
-    if (deleteSocket) {
-        delete udp;
-        udp = nullptr;
+
+    if (!transport) {
+        transport.reset(sq->createTransport());
+        transportOwner = sq;
     }
-}
 
-void ServerQueryPrivate::processServerInfo()
-{
-    auto si = ServerInfo::fromRawData(rcvData, server.toString(), port);
-    QObject::disconnect(serverInfoCon);
-    Q_Q(ServerQuery);
-    Q_EMIT q->gotInfo(si);
+    qCDebug(SQ, "Sending request \"%s\" to %s:%u.", request.toHex().constData(), qUtf8Printable(sq->server.toString()), sq->port);
+    if (Q_UNLIKELY(!transport->writeDatagram(request, sq->server, sq->port))) {
+        qCCritical(SQ, "Failed to send request to %s:%u.", qUtf8Printable(sq->server.toString()), sq->port);
+        finish(e, QByteArray());
+        return;
+    }
+    if (sq->capture) {
+        sq->capture->record(transport->localAddress(), transport->localPort(), sq->server, sq->port, request);
+    }
 }
 
-void ServerQueryPrivate::processRulesChallenge(const QByteArray &challenge)
+void ServerQueryBatch::process(Entry *e, const QByteArray &data)
 {
-    QObject::disconnect(gotChallengeToProcessRulesChallengeCon);
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + 'V' + challenge;
-    getRawDataAsync(request);
-}
+    count(e, QueryMetrics::PacketsReceived);
+    count(e, QueryMetrics::BytesReceived, static_cast<quint64>(data.size()));
 
-void ServerQueryPrivate::processRules(const QByteArray &data)
-{
-    const auto rules = extractRules(data);
-    QObject::disconnect(rulesCon);
-    Q_Q(ServerQuery);
-    Q_EMIT q->gotRules(rules);
-}
+    QByteArray payload;
+    const auto packet = A2SProtocol::instance()->unpack(data, &payload);
+    if (packet == A2SProtocol::SplitPacket) {
+        count(e, QueryMetrics::SplitPackets);
+        const auto status = e->split.add(data);
+        if (status == SplitPacketAssembler::Failed) {
+            qCCritical(SQ, "Received invalid split response from %s:%u.", qUtf8Printable(e->sq->server.toString()), e->sq->port);
+            count(e, QueryMetrics::InvalidReplies);
+            finish(e, QByteArray());
+            return;
+        }
+        if (status != SplitPacketAssembler::Complete) {
+            return;
+        }
+        payload = e->split.result();
+        e->split.clear();
+    } else if (Q_UNLIKELY(packet != A2SProtocol::SinglePacket)) {
+        qCWarning(SQ, "Ignoring invalid data from %s:%u.", qUtf8Printable(e->sq->server.toString()), e->sq->port);
+        count(e, QueryMetrics::InvalidReplies);
+        return;
+    }
 
-void ServerQueryPrivate::processPlayersChallenge(const QByteArray &challenge)
-{
-    QObject::disconnect(gotChallengeToProcessPlayersChallengeCon);
-    const QByteArray request = QByteArrayLiteral("\xff\xff\xff\xff") + 'U' + challenge;
-    getRawDataAsync(request);
+    QByteArray challenge;
+    const auto reply = A2SProtocol::instance()->matchReply(type, payload, &challenge);
+    if (reply == A2SProtocol::ChallengeReply) {
+        count(e, QueryMetrics::Challenges);
+        send(e, A2SProtocol::instance()->buildRequest(type, challenge));
+    } else if (reply == A2SProtocol::ExpectedReply) {
+        finish(e, payload);
+    } else {
+        qCWarning(SQ, "Received unexpected response with header '%c' from %s:%u.", payload.isEmpty() ? ' ' : payload.at(0), qUtf8Printable(e->sq->server.toString()), e->sq->port);
+        count(e, QueryMetrics::InvalidReplies);
+    }
 }
 
-void ServerQueryPrivate::processPlayers(const QByteArray &data)
+void ServerQueryBatch::finish(Entry *e, const QByteArray &result)
 {
-    const auto players = extractPlayers(data);
-    QObject::disconnect(playersCon);
-    Q_Q(ServerQuery);
-    Q_EMIT q->gotPlayers(players);
+    if (e->done) {
+        return;
+    }
+    e->done = true;
+    e->result = result;
+    --pending;
+
+    QueryMetrics *metrics = e->sq->metrics;
+    if (metrics) {
+        if (result.isEmpty()) {
+            metrics->add(QueryMetrics::RequestsFailed);
+        } else {
+            const auto metricsType = (type == A2SProtocol::Info) ? QueryMetrics::Info : ((type == A2SProtocol::Rules) ? QueryMetrics::Rules : QueryMetrics::Players);
+            metrics->add(QueryMetrics::RequestsSucceeded);
+            metrics->recordLatency(metricsType, e->elapsed.nsecsElapsed() / 1000);
+        }
+    }
 }
 
-QHash<QString,QString> ServerQueryPrivate::extractRules(const QByteArray &data) const
+QHash<QString,QString> ServerQueryPrivate::extractRules(const QByteArray &data)
 {
     QHash<QString,QString> rules;
 
@@ -505,11 +930,18 @@ QHash<QString,QString> ServerQueryPrivate::extractRules(const QByteArray &data)
         res.getCharacter(); // go over header
         const auto rulesCount = res.get<quint16>();
         if (rulesCount > 0) {
+            rules.reserve(rulesCount);
+            A2S::Reader reader(res);
+            A2S::RuleRecord rule;
             for (int i = 0; i < rulesCount; ++i) {
-                const QString name = res.getString();
-                const QString value = res.getString();
-                if (!name.isEmpty() && !value.isEmpty()) {
-                    rules.insert(name, value);
+                A2S::RuleEntry::read(&rule, reader);
+                if (Q_UNLIKELY(res.hasError())) {
+                    // some servers truncate long rule lists, keep what is complete
+                    qCWarning(SQ, "A2S_RULES response truncated after %i of %u rules.", i, rulesCount);
+                    break;
+                }
+                if (!rule.name.isEmpty() && !rule.value.isEmpty()) {
+                    rules.insert(rule.name, rule.value);
                 }
             }
         }
@@ -518,7 +950,7 @@ QHash<QString,QString> ServerQueryPrivate::extractRules(const QByteArray &data)
     return rules;
 }
 
-QList<Player*> ServerQueryPrivate::extractPlayers(const QByteArray &data, QObject *parent) const
+QList<Player*> ServerQueryPrivate::extractPlayers(const QByteArray &data, QObject *parent)
 {
     QList<Player*> lst;
 
@@ -529,12 +961,15 @@ QList<Player*> ServerQueryPrivate::extractPlayers(const QByteArray &data, QObjec
         const auto count = res.get<quint8>();
         if (count > 0) {
             lst.reserve(count);
+            A2S::Reader reader(res);
+            A2S::PlayerRecord player;
             for (int i = 0; i < count; ++i) {
-                res.get<quint8>(); // index of player chunk
-                const auto name = res.getString();
-                const auto score = res.get<qint32>();
-                const auto duration = res.get<float>();
-                lst.append(new Player(name, score, duration, parent));
+                A2S::PlayerEntry::read(&player, reader);
+                if (Q_UNLIKELY(res.hasError())) {
+                    qCWarning(SQ, "A2S_PLAYER response truncated after %i of %u players.", i, count);
+                    break;
+                }
+                lst.append(new Player(player.name, player.score, player.duration, parent));
             }
         }
     }
@@ -23,14 +23,25 @@
 #include "qgsq_global.h"
 #include "serverinfo.h"
 #include <QObject>
+#include <QFuture>
 
 class QHostAddress;
 
 namespace QGSQ {
+
+class QueryEngine;
+class QueryMetrics;
+class QueryTracer;
+class PacketCapture;
+class PacketReplay;
+class DatagramTransportFactory;
+
 namespace Valve {
 namespace Source {
 
 class ServerQueryPrivate;
+class StringPool;
+class InfoFilter;
 class ServerInfo;
 class Player;
 
@@ -63,20 +74,74 @@ public:
     int timeout() const;
     void setTimeout(int timeout);
 
+    QueryMetrics *metrics() const;
+    void setMetrics(QueryMetrics *metrics);
+
+    QueryTracer *tracer() const;
+    void setTracer(QueryTracer *tracer);
+
+    PacketCapture *capture() const;
+    void setCapture(PacketCapture *capture);
+
+    StringPool *stringPool() const;
+    void setStringPool(StringPool *pool);
+
+    InfoFilter *infoFilter() const;
+    void setInfoFilter(InfoFilter *filter);
+
+    DatagramTransportFactory *transportFactory() const;
+    void setTransportFactory(DatagramTransportFactory *factory);
+
+    PacketReplay *replay() const;
+    void setReplay(PacketReplay *replay);
+
+    /*
+     * Engine the asynchronous and future based requests run on, nullptr if
+     * the ServerQuery uses an engine of its own with its own settings. On a
+     * shared engine the metrics, tracer, capture, replay and transport
+     * factory of the engine are used instead, the timeout, string pool and
+     * info filter of the ServerQuery still apply. The engine can not be
+     * changed while requests are pending.
+     */
+    QueryEngine *engine() const;
+    void setEngine(QueryEngine *engine);
+
     ServerInfo* getInfo(QObject *parent = nullptr) const;
     QByteArray getRawInfo() const;
-    Q_INVOKABLE void getRawInfoAsync();
-    Q_INVOKABLE void getInfoAsync();
+    Q_INVOKABLE quint32 getRawInfoAsync();
+    Q_INVOKABLE quint32 getInfoAsync();
+    QFuture<QByteArray> getRawInfoFuture();
+    QFuture<ServerInfo*> getInfoFuture();
 
     QHash<QString, QString> getRules() const;
     QByteArray getRawRules() const;
-    Q_INVOKABLE void getRawRulesAsync();
-    Q_INVOKABLE void getRulesAsync();
+    Q_INVOKABLE quint32 getRawRulesAsync();
+    Q_INVOKABLE quint32 getRulesAsync();
+    QFuture<QByteArray> getRawRulesFuture();
+    QFuture<QHash<QString,QString>> getRulesFuture();
 
     QList<Player*> getPlayers(QObject *parent = nullptr) const;
     QByteArray getRawPlayers() const;
-    Q_INVOKABLE void getRawPlayersAsync();
-    Q_INVOKABLE void getPlayersAsync();
+    Q_INVOKABLE quint32 getRawPlayersAsync();
+    Q_INVOKABLE quint32 getPlayersAsync();
+    QFuture<QByteArray> getRawPlayersFuture();
+    QFuture<QList<Player*>> getPlayersFuture();
+
+    /*
+     * Blocking queries of many servers at once. All requests share one socket
+     * and one deadline of timeout milliseconds, no event loop is run while
+     * waiting. The results have the order of the queries, failed queries get
+     * an empty entry.
+     */
+    static QList<QByteArray> getRawInfo(const QList<ServerQuery*> &queries, int timeout);
+    static QList<ServerInfo*> getInfo(const QList<ServerQuery*> &queries, int timeout, QObject *parent = nullptr);
+    static QList<QByteArray> getRawRules(const QList<ServerQuery*> &queries, int timeout);
+    static QList<QHash<QString,QString>> getRules(const QList<ServerQuery*> &queries, int timeout);
+    static QList<QByteArray> getRawPlayers(const QList<ServerQuery*> &queries, int timeout);
+    static QList<QList<Player*>> getPlayers(const QList<ServerQuery*> &queries, int timeout, QObject *parent = nullptr);
+
+    int pendingRequests() const;
+    Q_INVOKABLE bool abort(quint32 requestId);
 
     bool event(QEvent *event) override;
 
@@ -94,6 +159,7 @@ Q_SIGNALS:
     void gotRules(const QHash<QString,QString> &rules);
     void gotRawPlayers(const QByteArray &rules);
     void gotPlayers(const QList<Player*> &players);
+    void requestFinished(quint32 requestId, bool success);
 
 protected:
     const QScopedPointer<ServerQueryPrivate> d_ptr;
@@ -21,57 +21,175 @@
 #define QGSQ_VALVE_SOURCE_SERVERQUERY_P_H
 
 #include "serverquery.h"
+#include "splitpacket_p.h"
+#include "queryengine.h"
+#include "querymetrics.h"
+#include "querytracer.h"
+#include "packetcapture.h"
+#include "packetreplay.h"
+#include "infofilter.h"
+#include "datagramtransport_p.h"
+#include "a2sprotocol.h"
 #include <QHostAddress>
-#include <QUdpSocket>
-#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QVector>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QFutureInterface>
 
 namespace QGSQ {
 namespace Valve {
 namespace Source {
 
+class ServerQueryPrivate;
+
+/*
+ * Reports the result of a future based query. If the request gets destroyed
+ * without a result, e.g. because it has been aborted or the ServerQuery has
+ * been deleted, the future is canceled instead of staying in the running
+ * state forever.
+ */
+template<typename T>
+class FutureReporter
+{
+public:
+    FutureReporter()
+    {
+        fi.reportStarted();
+    }
+
+    ~FutureReporter()
+    {
+        if (!fi.isFinished()) {
+            fi.reportCanceled();
+            fi.reportFinished();
+        }
+    }
+
+    QFuture<T> future() { return fi.future(); }
+
+    void finish(const T &result)
+    {
+        fi.reportFinished(&result);
+    }
+
+private:
+    QFutureInterface<T> fi;
+    Q_DISABLE_COPY(FutureReporter)
+};
+
+/*
+ * Blocking query of any number of servers over a single transport. All
+ * requests are sent at once, then one loop waits on the transport until
+ * every server answered or the common deadline expired. No event loop is
+ * run, so no other code of the caller is executed while waiting. Challenges
+ * are answered by sending the request again with them, recorded replies of
+ * a PacketReplay are processed without delay.
+ */
+class ServerQueryBatch
+{
+public:
+    ServerQueryBatch(A2SProtocol::Type _type, int _timeout);
+
+    ~ServerQueryBatch();
+
+    void add(const ServerQueryPrivate *sq);
+    QList<QByteArray> run();
+
+private:
+    struct Entry {
+        const ServerQueryPrivate *sq = nullptr;
+        Entry *duplicateOf = nullptr;
+        QByteArray result;
+        SplitPacketAssembler split;
+        QElapsedTimer elapsed;
+        int replayConversation = -1;
+        bool done = true;
+    };
+
+    void send(Entry *e, const QByteArray &request);
+    void process(Entry *e, const QByteArray &data);
+    void finish(Entry *e, const QByteArray &result);
+    static inline void count(const Entry *e, QueryMetrics::Counter counter, quint64 value = 1);
+
+    QVector<Entry*> entries;
+    QHash<QPair<QHostAddress,quint16>,Entry*> byEndpoint;
+    // deleted directly, the blocking loop never runs inside its readyRead()
+    QScopedPointer<DatagramTransport> transport;
+    // owner of the transport, gets the packets of unknown senders
+    const ServerQueryPrivate *transportOwner = nullptr;
+    // started on construction, the deadline is timeout milliseconds later
+    QElapsedTimer clock;
+    int timeout = 0;
+    int pending = 0;
+    A2SProtocol::Type type = A2SProtocol::Info;
+
+    Q_DISABLE_COPY(ServerQueryBatch)
+};
+
 class ServerQueryPrivate
 {
 public:
     ServerQueryPrivate() {}
 
-    virtual ~ServerQueryPrivate() {}
+    virtual ~ServerQueryPrivate();
 
-    QByteArray getRawData(const QByteArray &request) const;
-    void getRawDataAsync(const QByteArray &request);
-    void onUdpReadyRead();
-    QByteArray getChallenge(char header) const;
-    void getChallengeAsync(char header);
-    void setRunning(bool _running);
-    void processRcvData();
-    void processServerInfo();
-    void processRulesChallenge(const QByteArray &challenge);
-    void processRules(const QByteArray &data);
-    QHash<QString,QString> extractRules(const QByteArray &data) const;
-    void processPlayersChallenge(const QByteArray &challenge);
-    void processPlayers(const QByteArray &data);
-    QList<Player*> extractPlayers(const QByteArray &data, QObject *parent = nullptr) const;
+    QByteArray getRawData(A2SProtocol::Type type) const;
+    // like QueryEngine::Callback, returns false if the reply was rejected by the info filter
+    typedef std::function<bool(quint32, const QByteArray &)> Callback;
 
+    quint32 startRequest(A2SProtocol::Type type, const Callback &done);
+    static QList<QByteArray> getRawDataBatch(const QList<ServerQuery*> &queries, A2SProtocol::Type type, int timeout);
+    DatagramTransport *createTransport() const;
+    QueryEngine *queryEngine();
+    void connectEngine(QueryEngine *engine);
+    void dropRequests();
+    bool acceptInfo(const QByteArray &data) const;
+    void setRunning(bool _running);
+    // ParseDone is traced with the tracer of the engine the request runs on
+    inline void trace(quint32 requestId, QueryTracer::Event event) const
+    {
+        QueryTracer *_tracer = sharedEngine ? sharedEngine->tracer() : tracer;
+        if (Q_UNLIKELY(_tracer)) {
+            _tracer->traceEvent(requestId, event, QueryTracer::timestamp());
+        }
+    }
+    static QHash<QString,QString> extractRules(const QByteArray &data);
+    static QList<Player*> extractPlayers(const QByteArray &data, QObject *parent = nullptr);
 
     Q_DECLARE_PUBLIC(ServerQuery)
     ServerQuery *q_ptr = nullptr;
-    QUdpSocket *udp = nullptr;
-    QTimer *timeoutTimer = nullptr;
-    QMetaObject::Connection serverInfoCon;
-    QMetaObject::Connection gotChallengeToProcessRulesChallengeCon;
-    QMetaObject::Connection rulesCon;
-    QMetaObject::Connection gotChallengeToProcessPlayersChallengeCon;
-    QMetaObject::Connection playersCon;
+    // ids of the pending requests on the engine
+    QSet<quint32> requests;
+    // set with ServerQuery::setEngine(), otherwise ownEngine is created on first use
+    QPointer<QueryEngine> sharedEngine;
+    QueryEngine *ownEngine = nullptr;
     QHostAddress server;
-    QByteArray rcvData;
+    QueryMetrics *metrics = nullptr;
+    QueryTracer *tracer = nullptr;
+    PacketCapture *capture = nullptr;
+    PacketReplay *replay = nullptr;
+    DatagramTransportFactory *transportFactory = nullptr;
+    StringPool *stringPool = nullptr;
+    InfoFilter *infoFilter = nullptr;
     int timeout = 4000;
     quint16 port = 0;
     bool running = false;
-    bool responseComplete = false;
 
 private:
     Q_DISABLE_COPY(ServerQueryPrivate)
 };
 
+void ServerQueryBatch::count(const Entry *e, QueryMetrics::Counter counter, quint64 value)
+{
+    if (e->sq->metrics) {
+        e->sq->metrics->add(counter, value);
+    }
+}
+
 }
 }
 }
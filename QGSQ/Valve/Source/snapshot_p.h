@@ -0,0 +1,165 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SNAPSHOT_P_H
+#define QGSQ_VALVE_SOURCE_SNAPSHOT_P_H
+
+#include <QtGlobal>
+#include <QtEndian>
+#include <cstring>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Layout of a snapshot file, all integers are little endian:
+ *
+ * Header     magic "QGSQSNAP", quint16 version, quint16 flags, quint32 reserved,
+ *            qint64 creation time in ms since epoch, quint64 reserved
+ * Records    quint32 record size followed by the record, see RecordField
+ * Strings    quint32 count, quint32 offsets[count + 1] into the blob, UTF-8 blob
+ * Offsets    quint64 file offset of every record
+ * Index      quint32 bucket count (power of two), quint32 reserved, buckets made of
+ *            quint32 key hash and quint32 record index + 1 (0 marks an empty bucket),
+ *            open addressing with linear probing, see indexKeyHash()
+ * Footer     quint64 string table offset, quint64 offset table offset,
+ *            quint64 index offset (0 if there is none), quint32 record count,
+ *            quint32 string count, quint64 reserved, magic "QGSQSEND"
+ *
+ * String id 0 is always the empty string.
+ */
+namespace Snapshot {
+
+static const char HeaderMagic[] = "QGSQSNAP";
+static const char FooterMagic[] = "QGSQSEND";
+static const int MagicSize = 8;
+static const quint16 Version = 1;
+static const int HeaderSize = 32;
+static const int FooterSize = 48;
+
+enum RecordField : int {
+    AddressField            = 0,    // quint32 string id
+    QueryPortField          = 4,    // quint16
+    FlagsField              = 6,    // quint8, see RecordFlag
+    ProtocolField           = 7,    // quint8
+    NameField               = 8,    // quint32 string id
+    MapField                = 12,   // quint32 string id
+    FolderField             = 16,   // quint32 string id
+    GameField               = 20,   // quint32 string id
+    AppIdField              = 24,   // quint16
+    PlayersField            = 26,   // quint8
+    MaxPlayersField         = 27,   // quint8
+    BotsField               = 28,   // quint8
+    ServerTypeField         = 29,   // quint8
+    EnvironmentField        = 30,   // quint8
+    TheShipModeField        = 31,   // quint8
+    TheShipWitnessesField   = 32,   // quint8
+    TheShipDurationField    = 33,   // quint8
+    GamePortField           = 34,   // quint16
+    VersionField            = 36,   // quint32 string id
+    SteamIdField            = 40,   // quint64
+    GameIdField             = 48,   // quint64
+    SpecPortField           = 56,   // quint16
+    KeywordCountField       = 58,   // quint16
+    SpecNameField           = 60,   // quint32 string id
+    ModLinkField            = 64,   // quint32 string id
+    ModDownloadLinkField    = 68,   // quint32 string id
+    ModVersionField         = 72,   // quint32
+    ModSizeField            = 76,   // quint32
+    RuleCountField          = 80,   // quint16
+    PlayerCountField        = 82,   // quint16
+    FixedRecordSize         = 84
+};
+
+// the fixed part is followed by quint32 keyword ids, quint32 rule name/value id pairs
+// and players made of quint32 name id, qint32 score and a float duration
+static const int KeywordSize = 4;
+static const int RuleSize = 8;
+static const int PlayerSize = 12;
+
+static const int IndexHeaderSize = 8;
+static const int IndexBucketSize = 8;
+
+enum RecordFlag : quint8 {
+    GoldSourceFlag      = 0x01,
+    PrivateFlag         = 0x02,
+    VacFlag             = 0x04,
+    IsModFlag           = 0x08,
+    MultiplayerOnlyFlag = 0x10,
+    OwnDllFlag          = 0x20
+};
+
+template<typename T> inline T read(const uchar *src)
+{
+    return qFromLittleEndian<T>(src);
+}
+
+template<> inline float read<float>(const uchar *src)
+{
+    const quint32 i = qFromLittleEndian<quint32>(src);
+    float f;
+    std::memcpy(&f, &i, sizeof(f));
+    return f;
+}
+
+template<typename T> inline void write(uchar *dst, T value)
+{
+    qToLittleEndian<T>(value, dst);
+}
+
+template<> inline void write<float>(uchar *dst, float value)
+{
+    quint32 i;
+    std::memcpy(&i, &value, sizeof(i));
+    qToLittleEndian<quint32>(i, dst);
+}
+
+// 32 bit FNV-1a over the UTF-8 encoded address followed by the little endian query port,
+// independent of qHash() seeds and Qt versions so that it can be stored on disk
+inline quint32 indexKeyHash(const char *address, int size, quint16 port)
+{
+    quint32 h = 2166136261u;
+    for (int i = 0; i < size; ++i) {
+        h ^= static_cast<uchar>(address[i]);
+        h *= 16777619u;
+    }
+    h ^= static_cast<uchar>(port & 0xff);
+    h *= 16777619u;
+    h ^= static_cast<uchar>(port >> 8);
+    h *= 16777619u;
+    return h;
+}
+
+inline quint32 indexBucketCount(quint32 records)
+{
+    quint32 buckets = 1;
+    while (buckets < records * 2) {
+        buckets <<= 1;
+    }
+    return buckets;
+}
+
+}
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SNAPSHOT_P_H
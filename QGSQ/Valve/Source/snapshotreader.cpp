@@ -0,0 +1,653 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "snapshotreader_p.h"
+#include "snapshot_p.h"
+#include "serverinfo_p.h"
+#include "player.h"
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(SSR, "qgsq.valve.source.snapshotreader")
+
+using namespace QGSQ::Valve::Source;
+
+SnapshotRecord::SnapshotRecord(const SnapshotReaderPrivate *reader, const uchar *data, quint32 size) :
+    r(reader), data(data), size(size)
+{
+
+}
+
+bool SnapshotRecord::isValid() const
+{
+    return data != nullptr;
+}
+
+QString SnapshotRecord::string(int field) const
+{
+    return data ? r->string(Snapshot::read<quint32>(data + field)) : QString();
+}
+
+const uchar *SnapshotRecord::variablePart(int index, int section) const
+{
+    if (!data) {
+        return nullptr;
+    }
+
+    const int keywordCount = Snapshot::read<quint16>(data + Snapshot::KeywordCountField);
+    const int ruleCount = Snapshot::read<quint16>(data + Snapshot::RuleCountField);
+    const int playerCount = Snapshot::read<quint16>(data + Snapshot::PlayerCountField);
+
+    const uchar *p = data + Snapshot::FixedRecordSize;
+    switch (section) {
+    case 0:
+        return ((index >= 0) && (index < keywordCount)) ? p + index * Snapshot::KeywordSize : nullptr;
+    case 1:
+        p += keywordCount * Snapshot::KeywordSize;
+        return ((index >= 0) && (index < ruleCount)) ? p + index * Snapshot::RuleSize : nullptr;
+    case 2:
+        p += keywordCount * Snapshot::KeywordSize + ruleCount * Snapshot::RuleSize;
+        return ((index >= 0) && (index < playerCount)) ? p + index * Snapshot::PlayerSize : nullptr;
+    default:
+        return nullptr;
+    }
+}
+
+QString SnapshotRecord::address() const
+{
+    return string(Snapshot::AddressField);
+}
+
+quint16 SnapshotRecord::queryPort() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::QueryPortField) : 0;
+}
+
+bool SnapshotRecord::isGoldSource() const
+{
+    return data && (data[Snapshot::FlagsField] & Snapshot::GoldSourceFlag);
+}
+
+quint8 SnapshotRecord::protocol() const
+{
+    return data ? data[Snapshot::ProtocolField] : 0;
+}
+
+QString SnapshotRecord::name() const
+{
+    return string(Snapshot::NameField);
+}
+
+QString SnapshotRecord::map() const
+{
+    return string(Snapshot::MapField);
+}
+
+QString SnapshotRecord::folder() const
+{
+    return string(Snapshot::FolderField);
+}
+
+QString SnapshotRecord::game() const
+{
+    return string(Snapshot::GameField);
+}
+
+quint16 SnapshotRecord::appId() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::AppIdField) : 0;
+}
+
+quint8 SnapshotRecord::players() const
+{
+    return data ? data[Snapshot::PlayersField] : 0;
+}
+
+quint8 SnapshotRecord::maxPlayers() const
+{
+    return data ? data[Snapshot::MaxPlayersField] : 0;
+}
+
+quint8 SnapshotRecord::bots() const
+{
+    return data ? data[Snapshot::BotsField] : 0;
+}
+
+ServerInfo::Type SnapshotRecord::serverType() const
+{
+    return data ? static_cast<ServerInfo::Type>(data[Snapshot::ServerTypeField]) : ServerInfo::Unspecified;
+}
+
+ServerInfo::Environment SnapshotRecord::environment() const
+{
+    return data ? static_cast<ServerInfo::Environment>(data[Snapshot::EnvironmentField]) : ServerInfo::Unknown;
+}
+
+ServerInfo::Visibility SnapshotRecord::visibility() const
+{
+    return (data && (data[Snapshot::FlagsField] & Snapshot::PrivateFlag)) ? ServerInfo::Private : ServerInfo::Public;
+}
+
+ServerInfo::VAC SnapshotRecord::vac() const
+{
+    return (data && (data[Snapshot::FlagsField] & Snapshot::VacFlag)) ? ServerInfo::Secured : ServerInfo::Unsecured;
+}
+
+ServerInfo::TheShipMode SnapshotRecord::theShipMode() const
+{
+    return data ? static_cast<ServerInfo::TheShipMode>(data[Snapshot::TheShipModeField]) : ServerInfo::UnknownTheShipMode;
+}
+
+quint8 SnapshotRecord::theShipWitnesses() const
+{
+    return data ? data[Snapshot::TheShipWitnessesField] : 0;
+}
+
+quint8 SnapshotRecord::theShipDuration() const
+{
+    return data ? data[Snapshot::TheShipDurationField] : 0;
+}
+
+QString SnapshotRecord::version() const
+{
+    return string(Snapshot::VersionField);
+}
+
+quint16 SnapshotRecord::gamePort() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::GamePortField) : 0;
+}
+
+quint64 SnapshotRecord::steamId() const
+{
+    return data ? Snapshot::read<quint64>(data + Snapshot::SteamIdField) : 0;
+}
+
+quint16 SnapshotRecord::specPort() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::SpecPortField) : 0;
+}
+
+QString SnapshotRecord::specName() const
+{
+    return string(Snapshot::SpecNameField);
+}
+
+QStringList SnapshotRecord::keywords() const
+{
+    QStringList lst;
+
+    if (data) {
+        const int count = Snapshot::read<quint16>(data + Snapshot::KeywordCountField);
+        lst.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            lst.append(r->string(Snapshot::read<quint32>(variablePart(i, 0))));
+        }
+    }
+
+    return lst;
+}
+
+quint64 SnapshotRecord::gameId() const
+{
+    return data ? Snapshot::read<quint64>(data + Snapshot::GameIdField) : 0;
+}
+
+bool SnapshotRecord::isMod() const
+{
+    return data && (data[Snapshot::FlagsField] & Snapshot::IsModFlag);
+}
+
+QUrl SnapshotRecord::modLink() const
+{
+    return QUrl(string(Snapshot::ModLinkField));
+}
+
+QUrl SnapshotRecord::modDownloadLink() const
+{
+    return QUrl(string(Snapshot::ModDownloadLinkField));
+}
+
+quint32 SnapshotRecord::modVersion() const
+{
+    return data ? Snapshot::read<quint32>(data + Snapshot::ModVersionField) : 0;
+}
+
+quint32 SnapshotRecord::modSize() const
+{
+    return data ? Snapshot::read<quint32>(data + Snapshot::ModSizeField) : 0;
+}
+
+ServerInfo::ModType SnapshotRecord::modType() const
+{
+    return (data && (data[Snapshot::FlagsField] & Snapshot::MultiplayerOnlyFlag)) ? ServerInfo::MultiplayerOnlyMod : ServerInfo::SingleAndMultiplayerMod;
+}
+
+ServerInfo::ModDLLUsage SnapshotRecord::modDll() const
+{
+    return (data && (data[Snapshot::FlagsField] & Snapshot::OwnDllFlag)) ? ServerInfo::UsesOwnDll : ServerInfo::UsesHalfLifeDll;
+}
+
+int SnapshotRecord::ruleCount() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::RuleCountField) : 0;
+}
+
+QString SnapshotRecord::ruleName(int index) const
+{
+    const uchar *p = variablePart(index, 1);
+    return p ? r->string(Snapshot::read<quint32>(p)) : QString();
+}
+
+QString SnapshotRecord::ruleValue(int index) const
+{
+    const uchar *p = variablePart(index, 1);
+    return p ? r->string(Snapshot::read<quint32>(p + 4)) : QString();
+}
+
+QHash<QString,QString> SnapshotRecord::rules() const
+{
+    QHash<QString,QString> rules;
+
+    const int count = ruleCount();
+    rules.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const uchar *p = variablePart(i, 1);
+        rules.insert(r->string(Snapshot::read<quint32>(p)), r->string(Snapshot::read<quint32>(p + 4)));
+    }
+
+    return rules;
+}
+
+int SnapshotRecord::playerCount() const
+{
+    return data ? Snapshot::read<quint16>(data + Snapshot::PlayerCountField) : 0;
+}
+
+QString SnapshotRecord::playerName(int index) const
+{
+    const uchar *p = variablePart(index, 2);
+    return p ? r->string(Snapshot::read<quint32>(p)) : QString();
+}
+
+qint32 SnapshotRecord::playerScore(int index) const
+{
+    const uchar *p = variablePart(index, 2);
+    return p ? Snapshot::read<qint32>(p + 4) : 0;
+}
+
+float SnapshotRecord::playerDuration(int index) const
+{
+    const uchar *p = variablePart(index, 2);
+    return p ? Snapshot::read<float>(p + 8) : 0.0f;
+}
+
+QList<Player*> SnapshotRecord::playerList(QObject *parent) const
+{
+    QList<Player*> lst;
+
+    const int count = playerCount();
+    lst.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const uchar *p = variablePart(i, 2);
+        lst.append(new Player(r->string(Snapshot::read<quint32>(p)), Snapshot::read<qint32>(p + 4), Snapshot::read<float>(p + 8), parent));
+    }
+
+    return lst;
+}
+
+ServerInfo *SnapshotRecord::toServerInfo(QObject *parent) const
+{
+    if (Q_UNLIKELY(!data)) {
+        return nullptr;
+    }
+
+    auto si = new ServerInfo(address(), queryPort(), parent);
+    ServerInfoPrivate *d = si->d_func();
+    d->goldSource = isGoldSource();
+    d->protocol = protocol();
+    d->name = name();
+    d->map = map();
+    d->folder = folder();
+    d->game = game();
+    d->appId = appId();
+    d->players = players();
+    d->maxPlayers = maxPlayers();
+    d->bots = bots();
+    d->serverType = serverType();
+    d->environment = environment();
+    d->visibility = visibility();
+    d->vac = vac();
+    d->theShipMode = theShipMode();
+    d->theShipWitnesses = theShipWitnesses();
+    d->theShipDuration = theShipDuration();
+    d->version = version();
+    d->gamePort = gamePort();
+    d->steamId = steamId();
+    d->specPort = specPort();
+    d->specName = specName();
+    d->keywords = keywords();
+    d->gameId = gameId();
+    d->isMod = isMod();
+    d->modLink = modLink();
+    d->modDownloadLink = modDownloadLink();
+    d->modVersion = modVersion();
+    d->modSize = modSize();
+    d->modType = modType();
+    d->modDll = modDll();
+
+    return si;
+}
+
+SnapshotReader::SnapshotReader() : d_ptr(new SnapshotReaderPrivate)
+{
+
+}
+
+SnapshotReader::SnapshotReader(const QString &fileName) : d_ptr(new SnapshotReaderPrivate)
+{
+    open(fileName);
+}
+
+SnapshotReader::~SnapshotReader()
+{
+    close();
+}
+
+bool SnapshotReader::open(const QString &fileName)
+{
+    Q_D(SnapshotReader);
+    d->unmap();
+    d->errorString.clear();
+    return d->map(fileName);
+}
+
+void SnapshotReader::close()
+{
+    Q_D(SnapshotReader);
+    d->unmap();
+}
+
+bool SnapshotReader::isOpen() const
+{
+    Q_D(const SnapshotReader);
+    return d->data != nullptr;
+}
+
+quint16 SnapshotReader::version() const
+{
+    Q_D(const SnapshotReader);
+    return d->version;
+}
+
+QDateTime SnapshotReader::created() const
+{
+    Q_D(const SnapshotReader);
+    return d->created;
+}
+
+int SnapshotReader::count() const
+{
+    Q_D(const SnapshotReader);
+    return static_cast<int>(d->recordCount);
+}
+
+SnapshotRecord SnapshotReader::record(int index) const
+{
+    Q_D(const SnapshotReader);
+
+    if (Q_UNLIKELY(!d->data || (index < 0) || (static_cast<quint32>(index) >= d->recordCount))) {
+        return SnapshotRecord();
+    }
+
+    // offsets and sizes are untrusted, they are compared without additions that could wrap
+    const quint64 offset = Snapshot::read<quint64>(d->recordOffsets + static_cast<quint64>(index) * 8);
+    if (Q_UNLIKELY((offset < Snapshot::HeaderSize) || (offset > d->recordsEnd) || (d->recordsEnd - offset < 4))) {
+        qCWarning(SSR, "Invalid offset for record %i.", index);
+        return SnapshotRecord();
+    }
+
+    const quint32 size = Snapshot::read<quint32>(d->data + offset);
+    if (Q_UNLIKELY((size < Snapshot::FixedRecordSize) || (size > d->recordsEnd - offset - 4))) {
+        qCWarning(SSR, "Invalid size for record %i.", index);
+        return SnapshotRecord();
+    }
+
+    const uchar *rec = d->data + offset + 4;
+    const quint32 variableSize = Snapshot::read<quint16>(rec + Snapshot::KeywordCountField) * Snapshot::KeywordSize
+            + Snapshot::read<quint16>(rec + Snapshot::RuleCountField) * Snapshot::RuleSize
+            + Snapshot::read<quint16>(rec + Snapshot::PlayerCountField) * Snapshot::PlayerSize;
+    if (Q_UNLIKELY(Snapshot::FixedRecordSize + variableSize > size)) {
+        qCWarning(SSR, "Invalid variable data size for record %i.", index);
+        return SnapshotRecord();
+    }
+
+    return SnapshotRecord(d, rec, size);
+}
+
+bool SnapshotReader::hasIndex() const
+{
+    Q_D(const SnapshotReader);
+    return d->indexBuckets != nullptr;
+}
+
+int SnapshotReader::indexOf(const QString &address, quint16 queryPort) const
+{
+    Q_D(const SnapshotReader);
+
+    if (Q_UNLIKELY(!d->data)) {
+        return -1;
+    }
+
+    const QByteArray _address = address.toUtf8();
+
+    if (Q_UNLIKELY(!d->indexBuckets)) {
+        for (int i = 0; i < count(); ++i) {
+            const SnapshotRecord rec = record(i);
+            if (rec.isValid() && (rec.queryPort() == queryPort) && d->stringEquals(Snapshot::read<quint32>(rec.data + Snapshot::AddressField), _address)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    const quint32 hash = Snapshot::indexKeyHash(_address.constData(), _address.size(), queryPort);
+    const quint32 mask = d->bucketCount - 1;
+    quint32 bucket = hash & mask;
+
+    for (quint32 probes = 0; probes < d->bucketCount; ++probes) {
+        const uchar *b = d->indexBuckets + static_cast<quint64>(bucket) * Snapshot::IndexBucketSize;
+        const quint32 entry = Snapshot::read<quint32>(b + 4);
+        if (entry == 0) {
+            break;
+        }
+        if ((Snapshot::read<quint32>(b) == hash) && (entry <= d->recordCount)) {
+            const SnapshotRecord rec = record(static_cast<int>(entry - 1));
+            if (rec.isValid() && (rec.queryPort() == queryPort) && d->stringEquals(Snapshot::read<quint32>(rec.data + Snapshot::AddressField), _address)) {
+                return static_cast<int>(entry - 1);
+            }
+        }
+        bucket = (bucket + 1) & mask;
+    }
+
+    return -1;
+}
+
+SnapshotRecord SnapshotReader::find(const QString &address, quint16 queryPort) const
+{
+    const int idx = indexOf(address, queryPort);
+    return (idx > -1) ? record(idx) : SnapshotRecord();
+}
+
+QString SnapshotReader::errorString() const
+{
+    Q_D(const SnapshotReader);
+    return d->errorString;
+}
+
+bool SnapshotReaderPrivate::map(const QString &fileName)
+{
+    file.setFileName(fileName);
+    if (Q_UNLIKELY(!file.open(QIODevice::ReadOnly))) {
+        setError(file.errorString());
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    if (Q_UNLIKELY(fileSize < (Snapshot::HeaderSize + Snapshot::FooterSize))) {
+        setError(QStringLiteral("File is too small to be a snapshot."));
+        file.close();
+        return false;
+    }
+
+    const uchar *m = file.map(0, fileSize);
+    if (Q_UNLIKELY(!m)) {
+        setError(file.errorString());
+        file.close();
+        return false;
+    }
+
+    data = m;
+    size = static_cast<quint64>(fileSize);
+
+    if (Q_UNLIKELY(std::memcmp(data, Snapshot::HeaderMagic, Snapshot::MagicSize) != 0)) {
+        setError(QStringLiteral("Invalid snapshot header."));
+        unmap();
+        return false;
+    }
+
+    version = Snapshot::read<quint16>(data + 8);
+    if (Q_UNLIKELY((version == 0) || (version > Snapshot::Version))) {
+        setError(QStringLiteral("Unsupported snapshot version %1.").arg(version));
+        unmap();
+        return false;
+    }
+
+    created = QDateTime::fromMSecsSinceEpoch(Snapshot::read<qint64>(data + 16), Qt::UTC);
+
+    const uchar *footer = data + size - Snapshot::FooterSize;
+    if (Q_UNLIKELY(std::memcmp(footer + Snapshot::FooterSize - Snapshot::MagicSize, Snapshot::FooterMagic, Snapshot::MagicSize) != 0)) {
+        setError(QStringLiteral("Invalid snapshot footer, the snapshot might be incomplete."));
+        unmap();
+        return false;
+    }
+
+    const quint64 footerOffset = size - Snapshot::FooterSize;
+    const quint64 stringTableOffset = Snapshot::read<quint64>(footer);
+    const quint64 recordTableOffset = Snapshot::read<quint64>(footer + 8);
+    const quint64 indexOffset = Snapshot::read<quint64>(footer + 16);
+    recordCount = Snapshot::read<quint32>(footer + 24);
+    stringCount = Snapshot::read<quint32>(footer + 28);
+
+    const quint64 recordTableEnd = (indexOffset > 0) ? indexOffset : footerOffset;
+    const quint64 stringHeaderSize = 4 + (static_cast<quint64>(stringCount) + 1) * 4;
+
+    // the offsets are untrusted, they are compared without additions that could wrap
+    if (Q_UNLIKELY((stringTableOffset < Snapshot::HeaderSize)
+                   || (stringTableOffset > recordTableOffset)
+                   || (recordTableOffset - stringTableOffset < stringHeaderSize)
+                   || (recordTableEnd > footerOffset)
+                   || (recordTableOffset > recordTableEnd)
+                   || (recordTableEnd - recordTableOffset < static_cast<quint64>(recordCount) * 8)
+                   || (Snapshot::read<quint32>(data + stringTableOffset) != stringCount))) {
+        setError(QStringLiteral("Invalid snapshot table offsets."));
+        unmap();
+        return false;
+    }
+
+    recordsEnd = stringTableOffset;
+    stringOffsets = data + stringTableOffset + 4;
+    stringBlob = data + stringTableOffset + stringHeaderSize;
+    stringBlobSize = recordTableOffset - stringTableOffset - stringHeaderSize;
+    recordOffsets = data + recordTableOffset;
+
+    if (indexOffset > 0) {
+        const quint64 indexSize = footerOffset - indexOffset;
+        const quint32 buckets = (indexSize >= Snapshot::IndexHeaderSize) ? Snapshot::read<quint32>(data + indexOffset) : 0;
+        if (Q_UNLIKELY((buckets == 0) || (buckets & (buckets - 1))
+                       || (indexSize - Snapshot::IndexHeaderSize < static_cast<quint64>(buckets) * Snapshot::IndexBucketSize))) {
+            qCWarning(SSR, "Invalid index in snapshot %s, falling back to linear lookups.", qUtf8Printable(fileName));
+        } else {
+            bucketCount = buckets;
+            indexBuckets = data + indexOffset + Snapshot::IndexHeaderSize;
+        }
+    }
+
+    qCDebug(SSR, "Opened snapshot %s with %u records and %u strings.", qUtf8Printable(fileName), recordCount, stringCount);
+
+    return true;
+}
+
+void SnapshotReaderPrivate::unmap()
+{
+    if (data) {
+        file.unmap(const_cast<uchar*>(data));
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+    data = nullptr;
+    stringOffsets = nullptr;
+    stringBlob = nullptr;
+    recordOffsets = nullptr;
+    indexBuckets = nullptr;
+    size = 0;
+    stringBlobSize = 0;
+    recordsEnd = 0;
+    recordCount = 0;
+    stringCount = 0;
+    bucketCount = 0;
+    version = 0;
+    created = QDateTime();
+}
+
+void SnapshotReaderPrivate::setError(const QString &error)
+{
+    errorString = error;
+    qCCritical(SSR, "%s", qUtf8Printable(error));
+}
+
+QString SnapshotReaderPrivate::string(quint32 id) const
+{
+    if (id == 0 || id >= stringCount) {
+        return QString();
+    }
+
+    const quint32 start = Snapshot::read<quint32>(stringOffsets + static_cast<quint64>(id) * 4);
+    const quint32 end = Snapshot::read<quint32>(stringOffsets + (static_cast<quint64>(id) + 1) * 4);
+    if (Q_UNLIKELY((start > end) || (end > stringBlobSize))) {
+        return QString();
+    }
+
+    return QString::fromUtf8(reinterpret_cast<const char*>(stringBlob + start), static_cast<int>(end - start));
+}
+
+bool SnapshotReaderPrivate::stringEquals(quint32 id, const QByteArray &utf8) const
+{
+    if (id == 0 || id >= stringCount) {
+        return utf8.isEmpty();
+    }
+
+    const quint32 start = Snapshot::read<quint32>(stringOffsets + static_cast<quint64>(id) * 4);
+    const quint32 end = Snapshot::read<quint32>(stringOffsets + (static_cast<quint64>(id) + 1) * 4);
+    if (Q_UNLIKELY((start > end) || (end > stringBlobSize))) {
+        return false;
+    }
+
+    return (static_cast<int>(end - start) == utf8.size()) && (std::memcmp(stringBlob + start, utf8.constData(), end - start) == 0);
+}
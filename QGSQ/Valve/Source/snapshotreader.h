@@ -0,0 +1,181 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SNAPSHOTREADER_H
+#define QGSQ_VALVE_SOURCE_SNAPSHOTREADER_H
+
+#include "qgsq_global.h"
+#include "serverinfo.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QScopedPointer>
+#include <iterator>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class SnapshotReaderPrivate;
+class Player;
+
+/*
+ * Lightweight view on a single server record inside a memory mapped snapshot.
+ * Fields are decoded on access, the view is only valid as long as the
+ * SnapshotReader it was obtained from is open.
+ */
+class QGSQ_LIBRARY SnapshotRecord
+{
+public:
+    SnapshotRecord() {}
+
+    bool isValid() const;
+
+    QString address() const;
+    quint16 queryPort() const;
+    bool isGoldSource() const;
+    quint8 protocol() const;
+    QString name() const;
+    QString map() const;
+    QString folder() const;
+    QString game() const;
+    quint16 appId() const;
+    quint8 players() const;
+    quint8 maxPlayers() const;
+    quint8 bots() const;
+    ServerInfo::Type serverType() const;
+    ServerInfo::Environment environment() const;
+    ServerInfo::Visibility visibility() const;
+    ServerInfo::VAC vac() const;
+    ServerInfo::TheShipMode theShipMode() const;
+    quint8 theShipWitnesses() const;
+    quint8 theShipDuration() const;
+    QString version() const;
+    quint16 gamePort() const;
+    quint64 steamId() const;
+    quint16 specPort() const;
+    QString specName() const;
+    QStringList keywords() const;
+    quint64 gameId() const;
+    bool isMod() const;
+    QUrl modLink() const;
+    QUrl modDownloadLink() const;
+    quint32 modVersion() const;
+    quint32 modSize() const;
+    ServerInfo::ModType modType() const;
+    ServerInfo::ModDLLUsage modDll() const;
+
+    int ruleCount() const;
+    QString ruleName(int index) const;
+    QString ruleValue(int index) const;
+    QHash<QString,QString> rules() const;
+
+    int playerCount() const;
+    QString playerName(int index) const;
+    qint32 playerScore(int index) const;
+    float playerDuration(int index) const;
+    QList<Player*> playerList(QObject *parent = nullptr) const;
+
+    ServerInfo *toServerInfo(QObject *parent = nullptr) const;
+
+private:
+    friend class SnapshotReader;
+    SnapshotRecord(const SnapshotReaderPrivate *reader, const uchar *data, quint32 size);
+    QString string(int field) const;
+    const uchar *variablePart(int index, int section) const;
+
+    const SnapshotReaderPrivate *r = nullptr;
+    const uchar *data = nullptr;
+    quint32 size = 0;
+};
+
+/*
+ * Reads snapshots written by SnapshotWriter by memory mapping the file.
+ * Nothing but the header and footer is parsed when opening a snapshot,
+ * records can be looked up by address and port through the on-disk index.
+ */
+class QGSQ_LIBRARY SnapshotReader
+{
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef SnapshotRecord value_type;
+        typedef int difference_type;
+        typedef const SnapshotRecord *pointer;
+        typedef SnapshotRecord reference;
+
+        const_iterator() {}
+        SnapshotRecord operator*() const { return reader->record(i); }
+        int index() const { return i; }
+        const_iterator &operator++() { ++i; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++i; return it; }
+        bool operator==(const const_iterator &other) const { return (reader == other.reader) && (i == other.i); }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        friend class SnapshotReader;
+        const_iterator(const SnapshotReader *r, int index) : reader(r), i(index) {}
+        const SnapshotReader *reader = nullptr;
+        int i = 0;
+    };
+
+    SnapshotReader();
+
+    explicit SnapshotReader(const QString &fileName);
+
+    ~SnapshotReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+
+    quint16 version() const;
+    QDateTime created() const;
+    int count() const;
+
+    SnapshotRecord record(int index) const;
+
+    bool hasIndex() const;
+    int indexOf(const QString &address, quint16 queryPort) const;
+    SnapshotRecord find(const QString &address, quint16 queryPort) const;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count()); }
+    const_iterator constBegin() const { return begin(); }
+    const_iterator constEnd() const { return end(); }
+
+    QString errorString() const;
+
+protected:
+    const QScopedPointer<SnapshotReaderPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(SnapshotReader)
+    Q_DECLARE_PRIVATE(SnapshotReader)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SNAPSHOTREADER_H
@@ -0,0 +1,67 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SNAPSHOTREADER_P_H
+#define QGSQ_VALVE_SOURCE_SNAPSHOTREADER_P_H
+
+#include "snapshotreader.h"
+#include <QFile>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class SnapshotReaderPrivate
+{
+public:
+    SnapshotReaderPrivate() {}
+
+    virtual ~SnapshotReaderPrivate() {}
+
+    bool map(const QString &fileName);
+    void unmap();
+    void setError(const QString &error);
+    QString string(quint32 id) const;
+    bool stringEquals(quint32 id, const QByteArray &utf8) const;
+
+    QFile file;
+    QString errorString;
+    QDateTime created;
+    const uchar *data = nullptr;
+    const uchar *stringOffsets = nullptr;
+    const uchar *stringBlob = nullptr;
+    const uchar *recordOffsets = nullptr;
+    const uchar *indexBuckets = nullptr;
+    quint64 size = 0;
+    quint64 stringBlobSize = 0;
+    quint64 recordsEnd = 0;
+    quint32 recordCount = 0;
+    quint32 stringCount = 0;
+    quint32 bucketCount = 0;
+    quint16 version = 0;
+
+private:
+    Q_DISABLE_COPY(SnapshotReaderPrivate)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SNAPSHOTREADER_P_H
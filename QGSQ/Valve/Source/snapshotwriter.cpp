@@ -0,0 +1,367 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "snapshotwriter_p.h"
+#include "snapshot_p.h"
+#include "serverinfo.h"
+#include "player.h"
+#include <QFile>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(SSW, "qgsq.valve.source.snapshotwriter")
+
+using namespace QGSQ::Valve::Source;
+
+SnapshotWriter::SnapshotWriter() : d_ptr(new SnapshotWriterPrivate)
+{
+
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    Q_D(SnapshotWriter);
+    if (d->device) {
+        qCWarning(SSW, "Snapshot writer destroyed before finishing, the snapshot will be incomplete.");
+    }
+    delete d->file;
+}
+
+bool SnapshotWriter::open(const QString &fileName, const QDateTime &created)
+{
+    Q_D(SnapshotWriter);
+
+    if (Q_UNLIKELY(d->device)) {
+        d->setError(QStringLiteral("Snapshot writer is already open."));
+        return false;
+    }
+
+    auto file = new QFile(fileName);
+    if (Q_UNLIKELY(!file->open(QIODevice::WriteOnly|QIODevice::Truncate))) {
+        d->setError(file->errorString());
+        delete file;
+        return false;
+    }
+
+    delete d->file;
+    d->file = file;
+
+    return d->begin(file, created);
+}
+
+bool SnapshotWriter::open(QIODevice *device, const QDateTime &created)
+{
+    Q_D(SnapshotWriter);
+
+    if (Q_UNLIKELY(d->device)) {
+        d->setError(QStringLiteral("Snapshot writer is already open."));
+        return false;
+    }
+
+    if (Q_UNLIKELY(!device || !device->isWritable())) {
+        d->setError(QStringLiteral("Device is not writable."));
+        return false;
+    }
+
+    return d->begin(device, created);
+}
+
+bool SnapshotWriter::isOpen() const
+{
+    Q_D(const SnapshotWriter);
+    return d->device != nullptr;
+}
+
+bool SnapshotWriter::addServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules, const QList<Player*> &players)
+{
+    Q_D(SnapshotWriter);
+
+    if (Q_UNLIKELY(!d->device)) {
+        d->setError(QStringLiteral("Snapshot writer is not open."));
+        return false;
+    }
+
+    if (Q_UNLIKELY(!serverInfo)) {
+        d->setError(QStringLiteral("Can not add invalid server info."));
+        return false;
+    }
+
+    const QStringList keywords = serverInfo->keywords();
+    const int keywordCount = qMin(keywords.size(), 0xffff);
+    const int ruleCount = qMin(rules.size(), 0xffff);
+    const int playerCount = qMin(players.size(), 0xffff);
+
+    const int size = Snapshot::FixedRecordSize + keywordCount * Snapshot::KeywordSize + ruleCount * Snapshot::RuleSize + playerCount * Snapshot::PlayerSize;
+
+    QByteArray record(size + 4, '\0');
+    auto r = reinterpret_cast<uchar*>(record.data());
+    Snapshot::write<quint32>(r, static_cast<quint32>(size));
+    r += 4;
+
+    quint8 flags = 0;
+    if (serverInfo->isGoldSource()) {
+        flags |= Snapshot::GoldSourceFlag;
+    }
+    if (serverInfo->visibility() == ServerInfo::Private) {
+        flags |= Snapshot::PrivateFlag;
+    }
+    if (serverInfo->vac() == ServerInfo::Secured) {
+        flags |= Snapshot::VacFlag;
+    }
+    if (serverInfo->isMod()) {
+        flags |= Snapshot::IsModFlag;
+    }
+    if (serverInfo->modType() == ServerInfo::MultiplayerOnlyMod) {
+        flags |= Snapshot::MultiplayerOnlyFlag;
+    }
+    if (serverInfo->modDll() == ServerInfo::UsesOwnDll) {
+        flags |= Snapshot::OwnDllFlag;
+    }
+
+    Snapshot::write<quint32>(r + Snapshot::AddressField, d->stringId(serverInfo->address()));
+    Snapshot::write<quint16>(r + Snapshot::QueryPortField, serverInfo->queryPort());
+    r[Snapshot::FlagsField] = flags;
+    r[Snapshot::ProtocolField] = serverInfo->protocol();
+    Snapshot::write<quint32>(r + Snapshot::NameField, d->stringId(serverInfo->name()));
+    Snapshot::write<quint32>(r + Snapshot::MapField, d->stringId(serverInfo->map()));
+    Snapshot::write<quint32>(r + Snapshot::FolderField, d->stringId(serverInfo->folder()));
+    Snapshot::write<quint32>(r + Snapshot::GameField, d->stringId(serverInfo->game()));
+    Snapshot::write<quint16>(r + Snapshot::AppIdField, serverInfo->appId());
+    r[Snapshot::PlayersField] = serverInfo->players();
+    r[Snapshot::MaxPlayersField] = serverInfo->maxPlayers();
+    r[Snapshot::BotsField] = serverInfo->bots();
+    r[Snapshot::ServerTypeField] = serverInfo->serverType();
+    r[Snapshot::EnvironmentField] = serverInfo->environment();
+    r[Snapshot::TheShipModeField] = serverInfo->theShipMode();
+    r[Snapshot::TheShipWitnessesField] = serverInfo->theShipWitnesses();
+    r[Snapshot::TheShipDurationField] = serverInfo->theShipDuration();
+    Snapshot::write<quint16>(r + Snapshot::GamePortField, serverInfo->gamePort());
+    Snapshot::write<quint32>(r + Snapshot::VersionField, d->stringId(serverInfo->version()));
+    Snapshot::write<quint64>(r + Snapshot::SteamIdField, serverInfo->steamId());
+    Snapshot::write<quint64>(r + Snapshot::GameIdField, serverInfo->gameId());
+    Snapshot::write<quint16>(r + Snapshot::SpecPortField, serverInfo->specPort());
+    Snapshot::write<quint16>(r + Snapshot::KeywordCountField, static_cast<quint16>(keywordCount));
+    Snapshot::write<quint32>(r + Snapshot::SpecNameField, d->stringId(serverInfo->specName()));
+    Snapshot::write<quint32>(r + Snapshot::ModLinkField, d->stringId(serverInfo->modLink().toString()));
+    Snapshot::write<quint32>(r + Snapshot::ModDownloadLinkField, d->stringId(serverInfo->modDownloadLink().toString()));
+    Snapshot::write<quint32>(r + Snapshot::ModVersionField, serverInfo->modVersion());
+    Snapshot::write<quint32>(r + Snapshot::ModSizeField, serverInfo->modSize());
+    Snapshot::write<quint16>(r + Snapshot::RuleCountField, static_cast<quint16>(ruleCount));
+    Snapshot::write<quint16>(r + Snapshot::PlayerCountField, static_cast<quint16>(playerCount));
+
+    auto v = r + Snapshot::FixedRecordSize;
+    for (int i = 0; i < keywordCount; ++i) {
+        Snapshot::write<quint32>(v, d->stringId(keywords.at(i)));
+        v += Snapshot::KeywordSize;
+    }
+
+    int ri = 0;
+    for (auto it = rules.constBegin(); (it != rules.constEnd()) && (ri < ruleCount); ++it, ++ri) {
+        Snapshot::write<quint32>(v, d->stringId(it.key()));
+        Snapshot::write<quint32>(v + 4, d->stringId(it.value()));
+        v += Snapshot::RuleSize;
+    }
+
+    for (int i = 0; i < playerCount; ++i) {
+        const Player *p = players.at(i);
+        Snapshot::write<quint32>(v, p ? d->stringId(p->name()) : 0);
+        Snapshot::write<qint32>(v + 4, p ? p->score() : 0);
+        Snapshot::write<float>(v + 8, p ? p->duration() : 0.0f);
+        v += Snapshot::PlayerSize;
+    }
+
+    const quint64 offset = d->written;
+    if (Q_UNLIKELY(!d->write(record))) {
+        return false;
+    }
+    d->recordOffsets.append(offset);
+
+    const QByteArray address = serverInfo->address().toUtf8();
+    d->recordHashes.append(Snapshot::indexKeyHash(address.constData(), address.size(), serverInfo->queryPort()));
+
+    return true;
+}
+
+bool SnapshotWriter::finish()
+{
+    Q_D(SnapshotWriter);
+
+    if (Q_UNLIKELY(!d->device)) {
+        d->setError(QStringLiteral("Snapshot writer is not open."));
+        return false;
+    }
+
+    const bool ok = d->writeTables();
+
+    if (d->file) {
+        d->file->close();
+    }
+    d->reset();
+
+    return ok;
+}
+
+quint32 SnapshotWriter::count() const
+{
+    Q_D(const SnapshotWriter);
+    return static_cast<quint32>(d->recordOffsets.size());
+}
+
+QString SnapshotWriter::errorString() const
+{
+    Q_D(const SnapshotWriter);
+    return d->errorString;
+}
+
+bool SnapshotWriterPrivate::begin(QIODevice *_device, const QDateTime &created)
+{
+    reset();
+    device = _device;
+    errorString.clear();
+
+    stringIds.insert(QString(), 0);
+    stringOffsets.append(0);
+    stringOffsets.append(0);
+
+    QByteArray header(Snapshot::HeaderSize, '\0');
+    auto h = reinterpret_cast<uchar*>(header.data());
+    std::memcpy(h, Snapshot::HeaderMagic, Snapshot::MagicSize);
+    Snapshot::write<quint16>(h + 8, Snapshot::Version);
+    Snapshot::write<qint64>(h + 16, created.toMSecsSinceEpoch());
+
+    return write(header);
+}
+
+quint32 SnapshotWriterPrivate::stringId(const QString &str)
+{
+    if (str.isEmpty()) {
+        return 0;
+    }
+
+    auto it = stringIds.constFind(str);
+    if (it != stringIds.constEnd()) {
+        return it.value();
+    }
+
+    const auto id = static_cast<quint32>(stringOffsets.size() - 1);
+    strings.append(str.toUtf8());
+    stringOffsets.append(static_cast<quint32>(strings.size()));
+    stringIds.insert(str, id);
+
+    return id;
+}
+
+bool SnapshotWriterPrivate::write(const QByteArray &data)
+{
+    if (Q_UNLIKELY(device->write(data) != data.size())) {
+        setError(device->errorString());
+        return false;
+    }
+    written += static_cast<quint64>(data.size());
+    return true;
+}
+
+bool SnapshotWriterPrivate::writeTables()
+{
+    const quint64 stringTableOffset = written;
+    const quint32 stringCount = static_cast<quint32>(stringOffsets.size() - 1);
+
+    QByteArray table(4 + stringOffsets.size() * 4, '\0');
+    auto t = reinterpret_cast<uchar*>(table.data());
+    Snapshot::write<quint32>(t, stringCount);
+    for (int i = 0; i < stringOffsets.size(); ++i) {
+        Snapshot::write<quint32>(t + 4 + i * 4, stringOffsets.at(i));
+    }
+
+    if (Q_UNLIKELY(!write(table) || !write(strings))) {
+        return false;
+    }
+
+    const quint64 recordTableOffset = written;
+    QByteArray offsets(recordOffsets.size() * 8, '\0');
+    auto o = reinterpret_cast<uchar*>(offsets.data());
+    for (int i = 0; i < recordOffsets.size(); ++i) {
+        Snapshot::write<quint64>(o + i * 8, recordOffsets.at(i));
+    }
+
+    if (Q_UNLIKELY(!write(offsets))) {
+        return false;
+    }
+
+    const quint64 indexOffset = written;
+    if (Q_UNLIKELY(!writeIndex())) {
+        return false;
+    }
+
+    QByteArray footer(Snapshot::FooterSize, '\0');
+    auto f = reinterpret_cast<uchar*>(footer.data());
+    Snapshot::write<quint64>(f, stringTableOffset);
+    Snapshot::write<quint64>(f + 8, recordTableOffset);
+    Snapshot::write<quint64>(f + 16, indexOffset);
+    Snapshot::write<quint32>(f + 24, static_cast<quint32>(recordOffsets.size()));
+    Snapshot::write<quint32>(f + 28, stringCount);
+    std::memcpy(f + Snapshot::FooterSize - Snapshot::MagicSize, Snapshot::FooterMagic, Snapshot::MagicSize);
+
+    if (Q_UNLIKELY(!write(footer))) {
+        return false;
+    }
+
+    qCDebug(SSW, "Finished snapshot with %i records and %u strings in %llu bytes.", recordOffsets.size(), stringCount, written);
+
+    return true;
+}
+
+bool SnapshotWriterPrivate::writeIndex()
+{
+    const quint32 bucketCount = Snapshot::indexBucketCount(static_cast<quint32>(recordHashes.size()));
+    const quint32 mask = bucketCount - 1;
+
+    QByteArray index(Snapshot::IndexHeaderSize + static_cast<int>(bucketCount) * Snapshot::IndexBucketSize, '\0');
+    auto idx = reinterpret_cast<uchar*>(index.data());
+    Snapshot::write<quint32>(idx, bucketCount);
+    auto buckets = idx + Snapshot::IndexHeaderSize;
+
+    for (int i = 0; i < recordHashes.size(); ++i) {
+        const quint32 hash = recordHashes.at(i);
+        quint32 bucket = hash & mask;
+        while (Snapshot::read<quint32>(buckets + bucket * Snapshot::IndexBucketSize + 4) != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        Snapshot::write<quint32>(buckets + bucket * Snapshot::IndexBucketSize, hash);
+        Snapshot::write<quint32>(buckets + bucket * Snapshot::IndexBucketSize + 4, static_cast<quint32>(i + 1));
+    }
+
+    return write(index);
+}
+
+void SnapshotWriterPrivate::reset()
+{
+    stringIds.clear();
+    stringOffsets.clear();
+    recordOffsets.clear();
+    recordHashes.clear();
+    strings.clear();
+    device = nullptr;
+    written = 0;
+}
+
+void SnapshotWriterPrivate::setError(const QString &error)
+{
+    errorString = error;
+    qCCritical(SSW, "%s", qUtf8Printable(error));
+}
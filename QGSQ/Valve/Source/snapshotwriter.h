@@ -0,0 +1,77 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_H
+#define QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QScopedPointer>
+
+class QIODevice;
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class SnapshotWriterPrivate;
+class ServerInfo;
+class Player;
+
+/*
+ * Writes the results of a whole scan into a compact binary snapshot that can
+ * be read back with SnapshotReader. Records are written to the device as soon
+ * as they are added, strings are deduplicated and written together with the
+ * record table when calling finish().
+ */
+class QGSQ_LIBRARY SnapshotWriter
+{
+public:
+    SnapshotWriter();
+
+    ~SnapshotWriter();
+
+    bool open(const QString &fileName, const QDateTime &created = QDateTime::currentDateTimeUtc());
+    bool open(QIODevice *device, const QDateTime &created = QDateTime::currentDateTimeUtc());
+    bool isOpen() const;
+
+    bool addServer(const ServerInfo *serverInfo, const QHash<QString,QString> &rules = QHash<QString,QString>(), const QList<Player*> &players = QList<Player*>());
+
+    bool finish();
+
+    quint32 count() const;
+
+    QString errorString() const;
+
+protected:
+    const QScopedPointer<SnapshotWriterPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(SnapshotWriter)
+    Q_DECLARE_PRIVATE(SnapshotWriter)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_H
@@ -0,0 +1,66 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_P_H
+#define QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_P_H
+
+#include "snapshotwriter.h"
+#include <QVector>
+#include <QByteArray>
+
+class QFile;
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class SnapshotWriterPrivate
+{
+public:
+    SnapshotWriterPrivate() {}
+
+    virtual ~SnapshotWriterPrivate() {}
+
+    bool begin(QIODevice *_device, const QDateTime &created);
+    quint32 stringId(const QString &str);
+    bool write(const QByteArray &data);
+    bool writeTables();
+    bool writeIndex();
+    void reset();
+    void setError(const QString &error);
+
+    QHash<QString,quint32> stringIds;
+    QVector<quint32> stringOffsets;
+    QVector<quint64> recordOffsets;
+    QVector<quint32> recordHashes;
+    QByteArray strings;
+    QString errorString;
+    QIODevice *device = nullptr;
+    QFile *file = nullptr;
+    quint64 written = 0;
+
+private:
+    Q_DISABLE_COPY(SnapshotWriterPrivate)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SNAPSHOTWRITER_P_H
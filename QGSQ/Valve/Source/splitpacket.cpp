@@ -0,0 +1,277 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "splitpacket_p.h"
+#include <QtEndian>
+#include <QLoggingCategory>
+#ifdef QGSQ_WITH_BZIP2
+#include <bzlib.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(SQ)
+
+#define QGSQ_SPLIT_MAX_PENDING 32
+// limits the memory a forged size of a compressed response can allocate
+#define QGSQ_SPLIT_MAX_DECOMPRESSED_SIZE 1048576
+
+using namespace QGSQ::Valve::Source;
+
+static bool isSimpleHeader(const char *data)
+{
+    return qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(data)) == -1;
+}
+
+static bool isBzip2Header(const char *data)
+{
+    return (data[0] == 'B') && (data[1] == 'Z') && (data[2] == 'h');
+}
+
+quint32 SplitPacketAssembler::crc32(const QByteArray &data)
+{
+    quint32 crc = 0xffffffffU;
+    for (const char c : data) {
+        crc ^= static_cast<uchar>(c);
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0xedb88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+SplitPacketAssembler::Status SplitPacketAssembler::add(const QByteArray &datagram)
+{
+    if (Q_UNLIKELY(datagram.size() < 9)) {
+        qCWarning(SQ, "Received split packet that is too short.");
+        return Incomplete;
+    }
+
+    const auto id = qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(datagram.constData() + 4));
+    if (!m_hasId) {
+        m_id = id;
+        m_hasId = true;
+    } else if (Q_UNLIKELY(id != m_id)) {
+        qCWarning(SQ, "Dropping split packet with unexpected id %i.", id);
+        return Incomplete;
+    }
+
+    if (m_layout != Unknown) {
+        return addPart(datagram);
+    }
+
+    m_layout = detectLayout(datagram);
+    if (m_layout == Unknown) {
+        if (Q_UNLIKELY(m_pending.size() >= QGSQ_SPLIT_MAX_PENDING)) {
+            qCCritical(SQ, "Too many split packets without the first one.");
+            return Failed;
+        }
+        m_pending.append(datagram);
+        return Incomplete;
+    }
+
+    if ((m_layout != GoldSource) && (static_cast<quint32>(m_id) & 0x80000000U)) {
+#ifdef QGSQ_WITH_BZIP2
+        m_compressed = true;
+#else
+        qCCritical(SQ, "Received bzip2 compressed split response, which is not supported by this build.");
+        return Failed;
+#endif
+    }
+
+    Status status = addPart(datagram);
+    const QList<QByteArray> pending = m_pending;
+    m_pending.clear();
+    for (const QByteArray &p : pending) {
+        if (status != Incomplete) {
+            break;
+        }
+        status = addPart(p);
+    }
+
+    return status;
+}
+
+void SplitPacketAssembler::clear()
+{
+    m_pending.clear();
+    m_parts.clear();
+    m_result.clear();
+    m_id = 0;
+    m_decompressedSize = 0;
+    m_checksum = 0;
+    m_received = 0;
+    m_layout = Unknown;
+    m_hasId = false;
+    m_compressed = false;
+}
+
+bool SplitPacketAssembler::parseHeader(const QByteArray &datagram, Layout layout, int &number, int &total, int &offset)
+{
+    const auto data = reinterpret_cast<const uchar*>(datagram.constData());
+    const int size = datagram.size();
+
+    switch (layout) {
+    case Source:
+        if (size < 12) {
+            return false;
+        }
+        total = data[8];
+        number = data[9];
+        offset = 12;
+        break;
+    case SourceNoSize:
+        if (size < 10) {
+            return false;
+        }
+        total = data[8];
+        number = data[9];
+        offset = 10;
+        break;
+    case GoldSource:
+        if (size < 9) {
+            return false;
+        }
+        total = data[8] & 0x0f;
+        number = data[8] >> 4;
+        offset = 9;
+        break;
+    default:
+        return false;
+    }
+
+    return (total > 0) && (number < total);
+}
+
+SplitPacketAssembler::Layout SplitPacketAssembler::detectLayout(const QByteArray &datagram)
+{
+    // the payload of the first packet starts with the simple response header 0xFFFFFFFF
+    const char *data = datagram.constData();
+    const int size = datagram.size();
+
+    // compressed ones start with the decompressed size and checksum followed by the bzip2 stream
+    if (qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data + 4)) & 0x80000000U) {
+        if ((size >= 23) && (data[9] == 0) && isBzip2Header(data + 20)) {
+            return Source;
+        }
+        if ((size >= 21) && (data[9] == 0) && isBzip2Header(data + 18)) {
+            return SourceNoSize;
+        }
+    }
+
+    if ((size >= 16) && (data[9] == 0) && isSimpleHeader(data + 12)) {
+        return Source;
+    }
+
+    if ((size >= 14) && (data[9] == 0) && isSimpleHeader(data + 10)) {
+        return SourceNoSize;
+    }
+
+    if ((size >= 13) && ((static_cast<uchar>(data[8]) >> 4) == 0) && isSimpleHeader(data + 9)) {
+        return GoldSource;
+    }
+
+    return Unknown;
+}
+
+SplitPacketAssembler::Status SplitPacketAssembler::addPart(const QByteArray &datagram)
+{
+    int number = 0;
+    int total = 0;
+    int offset = 0;
+
+    if (Q_UNLIKELY(!parseHeader(datagram, m_layout, number, total, offset))) {
+        qCWarning(SQ, "Dropping split packet with invalid header.");
+        return Incomplete;
+    }
+
+    if (m_parts.isEmpty()) {
+        m_parts.resize(total);
+    } else if (Q_UNLIKELY(total != m_parts.size())) {
+        qCCritical(SQ, "Split packets disagree about the number of packets.");
+        return Failed;
+    }
+
+    if (!m_parts.at(number).isNull()) {
+        // duplicate
+        return Incomplete;
+    }
+
+    if (m_compressed && (number == 0)) {
+        if (Q_UNLIKELY(datagram.size() < offset + 8)) {
+            qCCritical(SQ, "Compressed split response misses its size and checksum.");
+            return Failed;
+        }
+        m_decompressedSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(datagram.constData() + offset));
+        m_checksum = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(datagram.constData() + offset + 4));
+        offset += 8;
+    }
+
+    // keep parts non null even if they carry no payload
+    m_parts[number] = datagram.mid(offset);
+    if (m_parts.at(number).isNull()) {
+        m_parts[number] = QByteArray("", 0);
+    }
+    ++m_received;
+
+    if (m_received < total) {
+        return Incomplete;
+    }
+
+    int resultSize = 0;
+    for (const QByteArray &part : m_parts) {
+        resultSize += part.size();
+    }
+
+    QByteArray assembled;
+    assembled.reserve(resultSize);
+    for (const QByteArray &part : m_parts) {
+        assembled.append(part);
+    }
+
+#ifdef QGSQ_WITH_BZIP2
+    if (m_compressed) {
+        if (Q_UNLIKELY(m_decompressedSize > QGSQ_SPLIT_MAX_DECOMPRESSED_SIZE)) {
+            qCCritical(SQ, "Compressed split response is too big, %u bytes.", m_decompressedSize);
+            return Failed;
+        }
+        QByteArray decompressed(static_cast<int>(m_decompressedSize), Qt::Uninitialized);
+        unsigned int decompressedSize = m_decompressedSize;
+        const int ret = BZ2_bzBuffToBuffDecompress(decompressed.data(), &decompressedSize, assembled.data(), static_cast<unsigned int>(assembled.size()), 0, 0);
+        if (Q_UNLIKELY((ret != BZ_OK) || (decompressedSize != m_decompressedSize))) {
+            qCCritical(SQ, "Failed to decompress split response.");
+            return Failed;
+        }
+        if (Q_UNLIKELY(crc32(decompressed) != m_checksum)) {
+            qCCritical(SQ, "Checksum of decompressed split response does not match.");
+            return Failed;
+        }
+        assembled = decompressed;
+    }
+#endif
+
+    if (Q_UNLIKELY((assembled.size() < 5) || !isSimpleHeader(assembled.constData()))) {
+        qCCritical(SQ, "Reassembled split response is invalid.");
+        return Failed;
+    }
+
+    m_result = assembled.mid(4);
+    m_parts.clear();
+
+    return Complete;
+}
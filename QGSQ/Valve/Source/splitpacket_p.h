@@ -0,0 +1,82 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQ_VALVE_SOURCE_SPLITPACKET_P_H
+#define QGSQ_VALVE_SOURCE_SPLITPACKET_P_H
+
+#include "queryprotocol.h"
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+/*
+ * Reassembles responses that are split over multiple datagrams starting
+ * with 0xFEFFFFFF. The packet layout differs between Source engine
+ * servers, old Source engine servers without the size field and GoldSource
+ * servers, so it is detected from the first packet of the response.
+ * Packets arriving before the first one are kept until the layout is known.
+ * Source engine responses can be bzip2 compressed, they are decompressed
+ * if the library is built with bzip2 support.
+ */
+class SplitPacketAssembler : public QueryReassembler
+{
+public:
+    Status add(const QByteArray &datagram) override;
+
+    QByteArray result() const override { return m_result; }
+
+    void clear() override;
+
+    // CRC32 used for the checksum of compressed responses
+    static quint32 crc32(const QByteArray &data);
+
+private:
+    enum Layout : quint8 {
+        Unknown         = 0,
+        Source          = 1,
+        SourceNoSize    = 2,
+        GoldSource      = 3
+    };
+
+    static bool parseHeader(const QByteArray &datagram, Layout layout, int &number, int &total, int &offset);
+    static Layout detectLayout(const QByteArray &datagram);
+    Status addPart(const QByteArray &datagram);
+
+    QList<QByteArray> m_pending;
+    QVector<QByteArray> m_parts;
+    QByteArray m_result;
+    qint32 m_id = 0;
+    quint32 m_decompressedSize = 0;
+    quint32 m_checksum = 0;
+    int m_received = 0;
+    Layout m_layout = Unknown;
+    bool m_hasId = false;
+    bool m_compressed = false;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_SPLITPACKET_P_H
@@ -0,0 +1,136 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "stringpool_p.h"
+
+using namespace QGSQ::Valve::Source;
+
+StringPool::StringPool(int maxEntries) :
+    d_ptr(new StringPoolPrivate(qMax(0, maxEntries)))
+{
+
+}
+
+StringPool::~StringPool()
+{
+
+}
+
+QString StringPool::intern(const char *utf8, int size)
+{
+    if (size <= 0) {
+        return QString();
+    }
+    Q_D(StringPool);
+    QMutexLocker locker(&d->mutex);
+    return d->intern(utf8, size);
+}
+
+QString StringPool::intern(const QByteArray &utf8)
+{
+    return intern(utf8.constData(), utf8.size());
+}
+
+QStringList StringPool::internList(const char *utf8, int size, char separator)
+{
+    QStringList list;
+    if (size <= 0) {
+        return list;
+    }
+
+    Q_D(StringPool);
+    QMutexLocker locker(&d->mutex);
+
+    const auto it = d->lists.constFind(QByteArray::fromRawData(utf8, size));
+    if (it != d->lists.constEnd()) {
+        ++d->hits;
+        return it.value();
+    }
+
+    const char *end = utf8 + size;
+    const char *part = utf8;
+    for (const char *p = utf8; p <= end; ++p) {
+        if ((p == end) || (*p == separator)) {
+            if (p > part) {
+                list.append(d->intern(part, static_cast<int>(p - part)));
+            }
+            part = p + 1;
+        }
+    }
+
+    if (d->strings.size() + d->lists.size() < d->maxEntries) {
+        d->lists.insert(QByteArray(utf8, size), list);
+    }
+
+    return list;
+}
+
+int StringPool::size() const
+{
+    Q_D(const StringPool);
+    QMutexLocker locker(&d->mutex);
+    return d->strings.size() + d->lists.size();
+}
+
+int StringPool::maxEntries() const
+{
+    Q_D(const StringPool);
+    return d->maxEntries;
+}
+
+quint64 StringPool::hits() const
+{
+    Q_D(const StringPool);
+    QMutexLocker locker(&d->mutex);
+    return d->hits;
+}
+
+quint64 StringPool::misses() const
+{
+    Q_D(const StringPool);
+    QMutexLocker locker(&d->mutex);
+    return d->misses;
+}
+
+void StringPool::clear()
+{
+    Q_D(StringPool);
+    QMutexLocker locker(&d->mutex);
+    d->strings.clear();
+    d->lists.clear();
+    d->hits = 0;
+    d->misses = 0;
+}
+
+QString StringPoolPrivate::intern(const char *utf8, int size)
+{
+    // the raw data key avoids a copy for lookups
+    const auto it = strings.constFind(QByteArray::fromRawData(utf8, size));
+    if (it != strings.constEnd()) {
+        ++hits;
+        return it.value();
+    }
+
+    ++misses;
+    const QString str = QString::fromUtf8(utf8, size);
+    if (strings.size() + lists.size() < maxEntries) {
+        strings.insert(QByteArray(utf8, size), str);
+    }
+    return str;
+}
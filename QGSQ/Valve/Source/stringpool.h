@@ -0,0 +1,74 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_STRINGPOOL_H
+#define QGSQ_VALVE_SOURCE_STRINGPOOL_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QStringList>
+#include <QScopedPointer>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class StringPoolPrivate;
+
+/*
+ * Interning pool for strings that repeat across many servers, like map,
+ * game folder, game description, version and keywords. Strings are looked up
+ * by their raw UTF-8 bytes, so a hit neither decodes nor allocates and all
+ * users share one implicitly shared QString. Once maxEntries strings are
+ * stored, new strings are returned without being added. The pool is thread
+ * safe, interned strings stay valid after clear() or deleting the pool.
+ */
+class QGSQ_LIBRARY StringPool
+{
+public:
+    explicit StringPool(int maxEntries = 65536);
+
+    ~StringPool();
+
+    QString intern(const char *utf8, int size);
+    QString intern(const QByteArray &utf8);
+
+    QStringList internList(const char *utf8, int size, char separator);
+
+    int size() const;
+    int maxEntries() const;
+
+    quint64 hits() const;
+    quint64 misses() const;
+
+    void clear();
+
+protected:
+    const QScopedPointer<StringPoolPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(StringPool)
+    Q_DECLARE_PRIVATE(StringPool)
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_STRINGPOOL_H
@@ -0,0 +1,50 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_VALVE_SOURCE_STRINGPOOL_P_H
+#define QGSQ_VALVE_SOURCE_STRINGPOOL_P_H
+
+#include "stringpool.h"
+#include <QHash>
+#include <QMutex>
+
+namespace QGSQ {
+namespace Valve {
+namespace Source {
+
+class StringPoolPrivate
+{
+public:
+    explicit StringPoolPrivate(int _maxEntries) : maxEntries(_maxEntries) {}
+
+    QString intern(const char *utf8, int size);
+
+    mutable QMutex mutex;
+    QHash<QByteArray,QString> strings;
+    QHash<QByteArray,QStringList> lists;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    int maxEntries = 65536;
+};
+
+}
+}
+}
+
+#endif // QGSQ_VALVE_SOURCE_STRINGPOOL_P_H
@@ -0,0 +1,85 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "datagramtransport_p.h"
+#include <QNetworkDatagram>
+
+using namespace QGSQ;
+
+DatagramTransport::DatagramTransport(QObject *parent) : QObject(parent)
+{
+
+}
+
+DatagramTransport::~DatagramTransport()
+{
+
+}
+
+DatagramTransportFactory::~DatagramTransportFactory()
+{
+
+}
+
+DatagramTransport *UdpSocketTransportFactory::createTransport()
+{
+    return new UdpSocketTransport;
+}
+
+UdpSocketTransport::UdpSocketTransport(QObject *parent) : DatagramTransport(parent)
+{
+    connect(&udp, &QUdpSocket::readyRead, this, &DatagramTransport::readyRead);
+}
+
+bool UdpSocketTransport::writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port)
+{
+    return udp.writeDatagram(data, address, port) == data.size();
+}
+
+bool UdpSocketTransport::hasPendingDatagrams() const
+{
+    return udp.hasPendingDatagrams();
+}
+
+bool UdpSocketTransport::receiveDatagram(Datagram *datagram)
+{
+    const QNetworkDatagram received = udp.receiveDatagram();
+    if (Q_UNLIKELY(!received.isValid())) {
+        return false;
+    }
+    datagram->data = received.data();
+    datagram->sender = received.senderAddress();
+    datagram->senderPort = static_cast<quint16>(received.senderPort());
+    return true;
+}
+
+bool UdpSocketTransport::waitForReadyRead(int msecs)
+{
+    return udp.waitForReadyRead(msecs);
+}
+
+QHostAddress UdpSocketTransport::localAddress() const
+{
+    return udp.localAddress();
+}
+
+quint16 UdpSocketTransport::localPort() const
+{
+    return udp.localPort();
+}
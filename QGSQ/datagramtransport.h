@@ -0,0 +1,94 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_DATAGRAMTRANSPORT_H
+#define QGSQ_DATAGRAMTRANSPORT_H
+
+#include "qgsq_global.h"
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+
+namespace QGSQ {
+
+/*
+ * A datagram received by a DatagramTransport.
+ */
+struct Datagram {
+    QByteArray data;
+    QHostAddress sender;
+    quint16 senderPort = 0;
+};
+
+/*
+ * Abstract unconnected datagram socket used by ServerQuery and QueryEngine.
+ * Transports are created through a DatagramTransportFactory and owned by
+ * the caller of createTransport(), that deletes them directly, only from
+ * inside their own readyRead() with deleteLater(). readyRead() has to be
+ * emitted whenever new datagrams can be received without blocking.
+ */
+class QGSQ_LIBRARY DatagramTransport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DatagramTransport(QObject *parent = nullptr);
+
+    ~DatagramTransport();
+
+    virtual bool writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port) = 0;
+    virtual bool hasPendingDatagrams() const = 0;
+    virtual bool receiveDatagram(Datagram *datagram) = 0;
+    virtual bool waitForReadyRead(int msecs) = 0;
+
+    virtual QHostAddress localAddress() const = 0;
+    virtual quint16 localPort() const = 0;
+
+Q_SIGNALS:
+    void readyRead();
+
+private:
+    Q_DISABLE_COPY(DatagramTransport)
+};
+
+/*
+ * Creates the transports used by ServerQuery and QueryEngine. Install an
+ * implementation with setTransportFactory(), it has to outlive the object
+ * using it and every transport it created, including transports whose
+ * deleteLater() is still pending. Without factory QUdpSocket is used.
+ */
+class QGSQ_LIBRARY DatagramTransportFactory
+{
+public:
+    virtual ~DatagramTransportFactory();
+
+    virtual DatagramTransport *createTransport() = 0;
+};
+
+/*
+ * Transport factory for QUdpSocket, the default of ServerQuery and QueryEngine.
+ */
+class QGSQ_LIBRARY UdpSocketTransportFactory : public DatagramTransportFactory
+{
+public:
+    DatagramTransport *createTransport() override;
+};
+
+}
+
+#endif // QGSQ_DATAGRAMTRANSPORT_H
@@ -0,0 +1,48 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_DATAGRAMTRANSPORT_P_H
+#define QGSQ_DATAGRAMTRANSPORT_P_H
+
+#include "datagramtransport.h"
+#include <QUdpSocket>
+
+namespace QGSQ {
+
+class UdpSocketTransport : public DatagramTransport
+{
+    Q_OBJECT
+public:
+    explicit UdpSocketTransport(QObject *parent = nullptr);
+
+    bool writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port) override;
+    bool hasPendingDatagrams() const override;
+    bool receiveDatagram(Datagram *datagram) override;
+    bool waitForReadyRead(int msecs) override;
+
+    QHostAddress localAddress() const override;
+    quint16 localPort() const override;
+
+private:
+    QUdpSocket udp;
+};
+
+}
+
+#endif // QGSQ_DATAGRAMTRANSPORT_P_H
@@ -0,0 +1,368 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "epolltransport_p.h"
+#include <QSocketNotifier>
+#include <QPointer>
+#include <QVarLengthArray>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QtEndian>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(SET, "qgsq.epolltransport")
+
+using namespace QGSQ;
+
+namespace {
+
+bool toSockAddr(const QHostAddress &address, quint16 port, int family, sockaddr_storage *storage, socklen_t *length)
+{
+    memset(storage, 0, sizeof(sockaddr_storage));
+    if (family == AF_INET) {
+        bool ok = false;
+        const quint32 ip = address.toIPv4Address(&ok);
+        if (!ok) {
+            return false;
+        }
+        auto sin = reinterpret_cast<sockaddr_in*>(storage);
+        sin->sin_family = AF_INET;
+        sin->sin_port = qToBigEndian(port);
+        sin->sin_addr.s_addr = qToBigEndian(ip);
+        *length = sizeof(sockaddr_in);
+    } else {
+        const Q_IPV6ADDR ip = address.toIPv6Address();
+        auto sin6 = reinterpret_cast<sockaddr_in6*>(storage);
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = qToBigEndian(port);
+        memcpy(sin6->sin6_addr.s6_addr, ip.c, 16);
+        *length = sizeof(sockaddr_in6);
+    }
+    return true;
+}
+
+void fromSockAddr(const sockaddr_storage *storage, QHostAddress *address, quint16 *port)
+{
+    if (storage->ss_family == AF_INET) {
+        auto sin = reinterpret_cast<const sockaddr_in*>(storage);
+        address->setAddress(qFromBigEndian<quint32>(sin->sin_addr.s_addr));
+        *port = qFromBigEndian<quint16>(sin->sin_port);
+    } else if (storage->ss_family == AF_INET6) {
+        auto sin6 = reinterpret_cast<const sockaddr_in6*>(storage);
+        address->setAddress(sin6->sin6_addr.s6_addr);
+        *port = qFromBigEndian<quint16>(sin6->sin6_port);
+    } else {
+        address->clear();
+        *port = 0;
+    }
+}
+
+}
+
+EpollTransportFactory::EpollTransportFactory(int batchSize) :
+    d_ptr(new EpollTransportFactoryPrivate(batchSize))
+{
+
+}
+
+EpollTransportFactory::~EpollTransportFactory()
+{
+
+}
+
+bool EpollTransportFactory::isValid() const
+{
+    Q_D(const EpollTransportFactory);
+    return d->epollFd >= 0;
+}
+
+int EpollTransportFactory::batchSize() const
+{
+    Q_D(const EpollTransportFactory);
+    return d->batchSize;
+}
+
+DatagramTransport *EpollTransportFactory::createTransport()
+{
+    Q_D(EpollTransportFactory);
+    return new EpollTransport(d);
+}
+
+RecvMmsgTransportFactory::RecvMmsgTransportFactory(int batchSize) :
+    EpollTransportFactory(qMax(2, batchSize))
+{
+
+}
+
+EpollTransportFactoryPrivate::EpollTransportFactoryPrivate(int _batchSize) :
+    batchSize(qBound(1, _batchSize, 1024))
+{
+    buffers.resize(batchSize * QGSQ_EPOLL_MAX_DATAGRAM);
+    if (batchSize > 1) {
+        messages.resize(batchSize);
+        iovecs.resize(batchSize);
+        addresses.resize(batchSize);
+        for (int i = 0; i < batchSize; ++i) {
+            iovecs[i].iov_base = buffers.data() + i * QGSQ_EPOLL_MAX_DATAGRAM;
+            iovecs[i].iov_len = QGSQ_EPOLL_MAX_DATAGRAM;
+            memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+        }
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (Q_UNLIKELY(epollFd < 0)) {
+        qCCritical(SET, "Failed to create epoll instance: %s", strerror(errno));
+        return;
+    }
+
+    notifier = new QSocketNotifier(epollFd, QSocketNotifier::Read);
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [this](){dispatch();});
+}
+
+EpollTransportFactoryPrivate::~EpollTransportFactoryPrivate()
+{
+    delete notifier;
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+}
+
+void EpollTransportFactoryPrivate::dispatch()
+{
+    epoll_event events[QGSQ_EPOLL_MAX_EVENTS];
+    const int count = epoll_wait(epollFd, events, QGSQ_EPOLL_MAX_EVENTS, 0);
+    // a receiver of one transport might delete the others of this wake up
+    QVarLengthArray<QPointer<EpollTransport>, QGSQ_EPOLL_MAX_EVENTS> transports;
+    for (int i = 0; i < count; ++i) {
+        transports.append(static_cast<EpollTransport*>(events[i].data.ptr));
+    }
+    for (const QPointer<EpollTransport> &transport : transports) {
+        if (transport) {
+            transport->readable();
+        }
+    }
+}
+
+EpollTransport::EpollTransport(EpollTransportFactoryPrivate *_engine, QObject *parent) :
+    DatagramTransport(parent), engine(_engine)
+{
+
+}
+
+EpollTransport::~EpollTransport()
+{
+    if (fd >= 0) {
+        if (engine->epollFd >= 0) {
+            epoll_ctl(engine->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        ::close(fd);
+    }
+}
+
+bool EpollTransport::open(int _family)
+{
+    fd = ::socket(_family, SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+    if (Q_UNLIKELY(fd < 0)) {
+        qCCritical(SET, "Failed to create socket: %s", strerror(errno));
+        return false;
+    }
+    family = _family;
+
+    if (engine->epollFd >= 0) {
+        epoll_event event;
+        memset(&event, 0, sizeof(epoll_event));
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        if (Q_UNLIKELY(epoll_ctl(engine->epollFd, EPOLL_CTL_ADD, fd, &event) != 0)) {
+            qCCritical(SET, "Failed to register socket with epoll: %s", strerror(errno));
+        }
+    }
+
+    return true;
+}
+
+bool EpollTransport::writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port)
+{
+    if (fd < 0) {
+        bool isIPv4 = false;
+        address.toIPv4Address(&isIPv4);
+        if (!open(isIPv4 ? AF_INET : AF_INET6)) {
+            return false;
+        }
+    }
+
+    sockaddr_storage storage;
+    socklen_t length = 0;
+    if (Q_UNLIKELY(!toSockAddr(address, port, family, &storage, &length))) {
+        qCWarning(SET, "Can not send to %s with a socket of another address family.", qUtf8Printable(address.toString()));
+        return false;
+    }
+
+    ssize_t sent = 0;
+    do {
+        sent = ::sendto(fd, data.constData(), static_cast<size_t>(data.size()), 0, reinterpret_cast<const sockaddr*>(&storage), length);
+    } while ((sent < 0) && (errno == EINTR));
+
+    return sent == data.size();
+}
+
+bool EpollTransport::hasPendingDatagrams() const
+{
+    return !queue.isEmpty() || (fill() > 0);
+}
+
+bool EpollTransport::receiveDatagram(Datagram *datagram)
+{
+    if (queue.isEmpty() && (fill() <= 0)) {
+        return false;
+    }
+    *datagram = queue.dequeue();
+    return true;
+}
+
+bool EpollTransport::waitForReadyRead(int msecs)
+{
+    if (!queue.isEmpty()) {
+        return true;
+    }
+
+    if (fd < 0) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    for (;;) {
+        const int remaining = (msecs < 0) ? -1 : qMax<int>(0, msecs - static_cast<int>(timer.elapsed()));
+        const int result = ::poll(&pfd, 1, remaining);
+        if ((result < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        if (fill() > 0) {
+            return true;
+        }
+        if (remaining == 0) {
+            return false;
+        }
+    }
+}
+
+QHostAddress EpollTransport::localAddress() const
+{
+    QHostAddress address;
+    if (fd >= 0) {
+        sockaddr_storage storage;
+        socklen_t length = sizeof(sockaddr_storage);
+        quint16 port = 0;
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&storage), &length) == 0) {
+            fromSockAddr(&storage, &address, &port);
+        }
+    }
+    return address;
+}
+
+quint16 EpollTransport::localPort() const
+{
+    quint16 port = 0;
+    if (fd >= 0) {
+        sockaddr_storage storage;
+        socklen_t length = sizeof(sockaddr_storage);
+        QHostAddress address;
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&storage), &length) == 0) {
+            fromSockAddr(&storage, &address, &port);
+        }
+    }
+    return port;
+}
+
+void EpollTransport::readable()
+{
+    if (fill() > 0) {
+        Q_EMIT readyRead();
+    }
+}
+
+int EpollTransport::fill() const
+{
+    if (fd < 0) {
+        return 0;
+    }
+
+    const int batchSize = engine->batchSize;
+    char *buffers = engine->buffers.data();
+    int received = 0;
+
+    if (batchSize == 1) {
+        sockaddr_storage storage;
+        socklen_t length = sizeof(sockaddr_storage);
+        ssize_t size = 0;
+        do {
+            size = ::recvfrom(fd, buffers, QGSQ_EPOLL_MAX_DATAGRAM, MSG_TRUNC, reinterpret_cast<sockaddr*>(&storage), &length);
+        } while ((size < 0) && (errno == EINTR));
+        if ((size >= 0) && (size <= QGSQ_EPOLL_MAX_DATAGRAM)) {
+            Datagram datagram;
+            datagram.data = QByteArray(buffers, static_cast<int>(size));
+            fromSockAddr(&storage, &datagram.sender, &datagram.senderPort);
+            queue.enqueue(datagram);
+            received = 1;
+        }
+        return received;
+    }
+
+    QVector<mmsghdr> &messages = engine->messages;
+    for (int i = 0; i < batchSize; ++i) {
+        // modified by the kernel on every call
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        messages[i].msg_hdr.msg_flags = 0;
+    }
+
+    int count = 0;
+    do {
+        count = ::recvmmsg(fd, messages.data(), static_cast<unsigned int>(batchSize), MSG_DONTWAIT, nullptr);
+    } while ((count < 0) && (errno == EINTR));
+
+    for (int i = 0; i < count; ++i) {
+        const mmsghdr &message = messages.at(i);
+        if (Q_UNLIKELY(message.msg_hdr.msg_flags & MSG_TRUNC)) {
+            continue;
+        }
+        Datagram datagram;
+        datagram.data = QByteArray(static_cast<const char*>(engine->iovecs.at(i).iov_base), static_cast<int>(message.msg_len));
+        fromSockAddr(&engine->addresses.at(i), &datagram.sender, &datagram.senderPort);
+        queue.enqueue(datagram);
+        ++received;
+    }
+
+    return received;
+}
@@ -0,0 +1,72 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_EPOLLTRANSPORT_H
+#define QGSQ_EPOLLTRANSPORT_H
+
+#include "qgsq_global.h"
+#include "datagramtransport.h"
+#include <QScopedPointer>
+
+namespace QGSQ {
+
+class EpollTransportFactoryPrivate;
+
+/*
+ * Linux only transport factory using non-blocking native UDP sockets. All
+ * sockets of a factory are registered with one epoll instance, so the event
+ * loop only watches a single file descriptor, regardless of the number of
+ * requests in flight. Readable sockets are drained with up to batchSize
+ * datagrams per wake up. A factory and its transports have to be used in the
+ * thread the factory has been created in.
+ */
+class QGSQ_LIBRARY EpollTransportFactory : public DatagramTransportFactory
+{
+public:
+    explicit EpollTransportFactory(int batchSize = 1);
+
+    ~EpollTransportFactory();
+
+    bool isValid() const;
+
+    int batchSize() const;
+
+    DatagramTransport *createTransport() override;
+
+protected:
+    const QScopedPointer<EpollTransportFactoryPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(EpollTransportFactory)
+    Q_DECLARE_PRIVATE(EpollTransportFactory)
+};
+
+/*
+ * Epoll based transport factory that receives up to batchSize datagrams with
+ * a single recvmmsg() system call.
+ */
+class QGSQ_LIBRARY RecvMmsgTransportFactory : public EpollTransportFactory
+{
+public:
+    explicit RecvMmsgTransportFactory(int batchSize = 32);
+};
+
+}
+
+#endif // QGSQ_EPOLLTRANSPORT_H
@@ -0,0 +1,88 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_EPOLLTRANSPORT_P_H
+#define QGSQ_EPOLLTRANSPORT_P_H
+
+#include "epolltransport.h"
+#include <QVector>
+#include <QQueue>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+class QSocketNotifier;
+
+#define QGSQ_EPOLL_MAX_EVENTS 64
+#define QGSQ_EPOLL_MAX_DATAGRAM 65536
+
+namespace QGSQ {
+
+class EpollTransportFactoryPrivate
+{
+public:
+    explicit EpollTransportFactoryPrivate(int _batchSize);
+
+    ~EpollTransportFactoryPrivate();
+
+    void dispatch();
+
+    // receive buffers shared by all transports of the factory, data is copied out immediately
+    QVector<char> buffers;
+    QVector<mmsghdr> messages;
+    QVector<iovec> iovecs;
+    QVector<sockaddr_storage> addresses;
+    QSocketNotifier *notifier = nullptr;
+    int epollFd = -1;
+    int batchSize = 1;
+
+private:
+    Q_DISABLE_COPY(EpollTransportFactoryPrivate)
+};
+
+class EpollTransport : public DatagramTransport
+{
+    Q_OBJECT
+public:
+    explicit EpollTransport(EpollTransportFactoryPrivate *_engine, QObject *parent = nullptr);
+
+    ~EpollTransport();
+
+    bool writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port) override;
+    bool hasPendingDatagrams() const override;
+    bool receiveDatagram(Datagram *datagram) override;
+    bool waitForReadyRead(int msecs) override;
+
+    QHostAddress localAddress() const override;
+    quint16 localPort() const override;
+
+    void readable();
+
+private:
+    bool open(int family);
+    int fill() const;
+
+    EpollTransportFactoryPrivate *engine = nullptr;
+    mutable QQueue<Datagram> queue;
+    int fd = -1;
+    int family = 0;
+};
+
+}
+
+#endif // QGSQ_EPOLLTRANSPORT_P_H
@@ -0,0 +1,159 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "loopbacktransport_p.h"
+#include <QTimer>
+#include <QtEndian>
+#include <cstring>
+
+using namespace QGSQ;
+
+LoopbackTransportFactory::LoopbackTransportFactory() :
+    d_ptr(new LoopbackTransportFactoryPrivate)
+{
+
+}
+
+LoopbackTransportFactory::~LoopbackTransportFactory()
+{
+
+}
+
+void LoopbackTransportFactory::bind(const QHostAddress &address, quint16 port, const Handler &handler)
+{
+    Q_D(LoopbackTransportFactory);
+    d->handlers.insert(LoopbackTransportFactoryPrivate::endpointKey(address, port), handler);
+}
+
+void LoopbackTransportFactory::unbind(const QHostAddress &address, quint16 port)
+{
+    Q_D(LoopbackTransportFactory);
+    d->handlers.remove(LoopbackTransportFactoryPrivate::endpointKey(address, port));
+}
+
+quint64 LoopbackTransportFactory::datagramsSent() const
+{
+    Q_D(const LoopbackTransportFactory);
+    return d->datagramsSent;
+}
+
+DatagramTransport *LoopbackTransportFactory::createTransport()
+{
+    Q_D(LoopbackTransportFactory);
+    // ephemeral port range, skipping ports still in use after a wrap around
+    do {
+        d->lastPort = (d->lastPort == 65535) ? 49152 : d->lastPort + 1;
+    } while (d->transports.contains(d->lastPort));
+    return new LoopbackTransport(d, d->lastPort);
+}
+
+QByteArray LoopbackTransportFactoryPrivate::endpointKey(const QHostAddress &address, quint16 port)
+{
+    const Q_IPV6ADDR ip = address.toIPv6Address();
+    QByteArray key(18, '\0');
+    memcpy(key.data(), ip.c, 16);
+    qToBigEndian<quint16>(port, key.data() + 16);
+    return key;
+}
+
+LoopbackTransport::LoopbackTransport(LoopbackTransportFactoryPrivate *_network, quint16 _port, QObject *parent) :
+    DatagramTransport(parent), network(_network), port(_port)
+{
+    network->transports.insert(port, this);
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+    network->transports.remove(port);
+}
+
+bool LoopbackTransport::writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 destinationPort)
+{
+    ++network->datagramsSent;
+
+    const auto handler = network->handlers.constFind(LoopbackTransportFactoryPrivate::endpointKey(address, destinationPort));
+    if (handler != network->handlers.constEnd()) {
+        const QList<QByteArray> replies = handler.value()(data, localAddress(), port);
+        for (const QByteArray &reply : replies) {
+            deliver(reply, address, destinationPort);
+        }
+        return true;
+    }
+
+    if (address.isLoopback()) {
+        LoopbackTransport *peer = network->transports.value(destinationPort);
+        if (peer) {
+            peer->deliver(data, localAddress(), port);
+        }
+    }
+
+    // like on a real network, datagrams to unknown endpoints are silently lost
+    return true;
+}
+
+bool LoopbackTransport::hasPendingDatagrams() const
+{
+    return !queue.isEmpty();
+}
+
+bool LoopbackTransport::receiveDatagram(Datagram *datagram)
+{
+    if (queue.isEmpty()) {
+        return false;
+    }
+    *datagram = queue.dequeue();
+    return true;
+}
+
+bool LoopbackTransport::waitForReadyRead(int msecs)
+{
+    // everything is delivered synchronously, waiting would not change anything
+    Q_UNUSED(msecs);
+    return !queue.isEmpty();
+}
+
+QHostAddress LoopbackTransport::localAddress() const
+{
+    return QHostAddress(QHostAddress::LocalHost);
+}
+
+quint16 LoopbackTransport::localPort() const
+{
+    return port;
+}
+
+void LoopbackTransport::deliver(const QByteArray &data, const QHostAddress &sender, quint16 senderPort)
+{
+    Datagram datagram;
+    datagram.data = data;
+    datagram.sender = sender;
+    datagram.senderPort = senderPort;
+    queue.enqueue(datagram);
+
+    // coalesce the notifications of all replies delivered in one go
+    if (!notifyPending) {
+        notifyPending = true;
+        QTimer::singleShot(0, this, [this](){
+            notifyPending = false;
+            if (!queue.isEmpty()) {
+                Q_EMIT readyRead();
+            }
+        });
+    }
+}
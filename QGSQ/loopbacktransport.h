@@ -0,0 +1,68 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_LOOPBACKTRANSPORT_H
+#define QGSQ_LOOPBACKTRANSPORT_H
+
+#include "qgsq_global.h"
+#include "datagramtransport.h"
+#include <QScopedPointer>
+#include <QList>
+#include <functional>
+
+namespace QGSQ {
+
+class LoopbackTransportFactoryPrivate;
+
+/*
+ * In-memory network for tests and benchmarks. Transports created by the
+ * factory get unique local endpoints on 127.0.0.1 and can send datagrams to
+ * each other and to handlers bound to arbitrary endpoints. A handler gets the
+ * request and the sender and returns the replies, that are queued for the
+ * sender and announced by readyRead() from the event loop. Nothing ever
+ * touches the operating system's network stack. The factory has to be used in
+ * a single thread.
+ */
+class QGSQ_LIBRARY LoopbackTransportFactory : public DatagramTransportFactory
+{
+public:
+    typedef std::function<QList<QByteArray>(const QByteArray &, const QHostAddress &, quint16)> Handler;
+
+    LoopbackTransportFactory();
+
+    ~LoopbackTransportFactory();
+
+    void bind(const QHostAddress &address, quint16 port, const Handler &handler);
+    void unbind(const QHostAddress &address, quint16 port);
+
+    quint64 datagramsSent() const;
+
+    DatagramTransport *createTransport() override;
+
+protected:
+    const QScopedPointer<LoopbackTransportFactoryPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(LoopbackTransportFactory)
+    Q_DECLARE_PRIVATE(LoopbackTransportFactory)
+};
+
+}
+
+#endif // QGSQ_LOOPBACKTRANSPORT_H
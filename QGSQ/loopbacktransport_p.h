@@ -0,0 +1,69 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_LOOPBACKTRANSPORT_P_H
+#define QGSQ_LOOPBACKTRANSPORT_P_H
+
+#include "loopbacktransport.h"
+#include <QHash>
+#include <QQueue>
+
+namespace QGSQ {
+
+class LoopbackTransport;
+
+class LoopbackTransportFactoryPrivate
+{
+public:
+    static QByteArray endpointKey(const QHostAddress &address, quint16 port);
+
+    QHash<QByteArray,LoopbackTransportFactory::Handler> handlers;
+    QHash<quint16,LoopbackTransport*> transports;
+    quint64 datagramsSent = 0;
+    quint16 lastPort = 49151;
+};
+
+class LoopbackTransport : public DatagramTransport
+{
+    Q_OBJECT
+public:
+    LoopbackTransport(LoopbackTransportFactoryPrivate *_network, quint16 _port, QObject *parent = nullptr);
+
+    ~LoopbackTransport();
+
+    bool writeDatagram(const QByteArray &data, const QHostAddress &address, quint16 port) override;
+    bool hasPendingDatagrams() const override;
+    bool receiveDatagram(Datagram *datagram) override;
+    bool waitForReadyRead(int msecs) override;
+
+    QHostAddress localAddress() const override;
+    quint16 localPort() const override;
+
+    void deliver(const QByteArray &data, const QHostAddress &sender, quint16 senderPort);
+
+private:
+    LoopbackTransportFactoryPrivate *network = nullptr;
+    QQueue<Datagram> queue;
+    quint16 port = 0;
+    bool notifyPending = false;
+};
+
+}
+
+#endif // QGSQ_LOOPBACKTRANSPORT_P_H
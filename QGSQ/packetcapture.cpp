@@ -0,0 +1,244 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "packetcapture_p.h"
+#include <QFile>
+#include <QtEndian>
+#include <QLoggingCategory>
+#include <chrono>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(SPC, "qgsq.packetcapture")
+
+using namespace QGSQ;
+
+namespace {
+
+quint16 ipv4Checksum(const uchar *header)
+{
+    quint32 sum = 0;
+    for (int i = 0; i < Pcap::IPv4HeaderSize; i += 2) {
+        sum += qFromBigEndian<quint16>(header + i);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return static_cast<quint16>(~sum);
+}
+
+bool isUnspecified(const QHostAddress &address)
+{
+    return address.isNull() || (address == QHostAddress::AnyIPv4) || (address == QHostAddress::AnyIPv6) || (address == QHostAddress::Any);
+}
+
+// addresses of both ends have to be of the same family, dual stack sockets report IPv4 peers as mapped IPv6 addresses
+QHostAddress normalized(const QHostAddress &address, bool ipv4)
+{
+    if (ipv4) {
+        bool ok = false;
+        const quint32 v4 = address.toIPv4Address(&ok);
+        return ok ? QHostAddress(v4) : QHostAddress(QHostAddress::AnyIPv4);
+    }
+    return (address.protocol() == QAbstractSocket::IPv6Protocol) ? address : QHostAddress(address.toIPv6Address());
+}
+
+}
+
+PacketCapture::PacketCapture() : d_ptr(new PacketCapturePrivate)
+{
+
+}
+
+PacketCapture::~PacketCapture()
+{
+    close();
+}
+
+bool PacketCapture::open(const QString &fileName)
+{
+    Q_D(PacketCapture);
+    QMutexLocker locker(&d->mutex);
+
+    if (Q_UNLIKELY(d->device)) {
+        d->setError(QStringLiteral("Packet capture is already open."));
+        return false;
+    }
+
+    auto file = new QFile(fileName);
+    if (Q_UNLIKELY(!file->open(QIODevice::WriteOnly|QIODevice::Truncate))) {
+        d->setError(file->errorString());
+        delete file;
+        return false;
+    }
+
+    d->file = file;
+    d->device = file;
+
+    if (Q_UNLIKELY(!d->begin())) {
+        d->device = nullptr;
+        delete d->file;
+        d->file = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool PacketCapture::open(QIODevice *device)
+{
+    Q_D(PacketCapture);
+    QMutexLocker locker(&d->mutex);
+
+    if (Q_UNLIKELY(d->device)) {
+        d->setError(QStringLiteral("Packet capture is already open."));
+        return false;
+    }
+
+    if (Q_UNLIKELY(!device || !device->isWritable())) {
+        d->setError(QStringLiteral("Device is not writable."));
+        return false;
+    }
+
+    d->device = device;
+
+    if (Q_UNLIKELY(!d->begin())) {
+        d->device = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool PacketCapture::isOpen() const
+{
+    Q_D(const PacketCapture);
+    QMutexLocker locker(&d->mutex);
+    return d->device != nullptr;
+}
+
+void PacketCapture::close()
+{
+    Q_D(PacketCapture);
+    QMutexLocker locker(&d->mutex);
+    d->device = nullptr;
+    delete d->file;
+    d->file = nullptr;
+}
+
+void PacketCapture::record(const QHostAddress &source, quint16 sourcePort, const QHostAddress &destination, quint16 destinationPort, const QByteArray &payload)
+{
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // the local end is usually unbound, the family is taken from the peer
+    bool ipv4 = false;
+    (isUnspecified(source) ? destination : source).toIPv4Address(&ipv4);
+    const QHostAddress src = normalized(source, ipv4);
+    const QHostAddress dst = normalized(destination, ipv4);
+
+    const int ipHeaderSize = ipv4 ? Pcap::IPv4HeaderSize : Pcap::IPv6HeaderSize;
+    const int udpSize = Pcap::UdpHeaderSize + payload.size();
+    const int packetSize = ipHeaderSize + udpSize;
+    if (Q_UNLIKELY(udpSize > 0xffff)) {
+        qCWarning(SPC, "Datagram of %i bytes is too big to be captured.", payload.size());
+        return;
+    }
+
+    QByteArray record(Pcap::RecordHeaderSize + ipHeaderSize + Pcap::UdpHeaderSize, '\0');
+    auto r = reinterpret_cast<uchar*>(record.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(now / 1000000), r);
+    qToLittleEndian<quint32>(static_cast<quint32>(now % 1000000), r + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(packetSize), r + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(packetSize), r + 12);
+
+    uchar *ip = r + Pcap::RecordHeaderSize;
+    if (ipv4) {
+        ip[0] = 0x45;
+        qToBigEndian<quint16>(static_cast<quint16>(packetSize), ip + 2);
+        qToBigEndian<quint16>(0x4000, ip + 6);
+        ip[8] = 64;
+        ip[9] = Pcap::UdpProtocol;
+        qToBigEndian<quint32>(src.toIPv4Address(), ip + 12);
+        qToBigEndian<quint32>(dst.toIPv4Address(), ip + 16);
+        qToBigEndian<quint16>(ipv4Checksum(ip), ip + 10);
+    } else {
+        ip[0] = 0x60;
+        qToBigEndian<quint16>(static_cast<quint16>(udpSize), ip + 4);
+        ip[6] = Pcap::UdpProtocol;
+        ip[7] = 64;
+        const Q_IPV6ADDR s6 = src.toIPv6Address();
+        const Q_IPV6ADDR d6 = dst.toIPv6Address();
+        memcpy(ip + 8, s6.c, 16);
+        memcpy(ip + 24, d6.c, 16);
+    }
+
+    uchar *udp = ip + ipHeaderSize;
+    qToBigEndian<quint16>(sourcePort, udp);
+    qToBigEndian<quint16>(destinationPort, udp + 2);
+    qToBigEndian<quint16>(static_cast<quint16>(udpSize), udp + 4);
+
+    Q_D(PacketCapture);
+    QMutexLocker locker(&d->mutex);
+    if (Q_UNLIKELY(!d->device)) {
+        return;
+    }
+    if (Q_LIKELY(d->write(record.constData(), record.size()) && d->write(payload.constData(), payload.size()))) {
+        ++d->count;
+    }
+}
+
+quint64 PacketCapture::count() const
+{
+    Q_D(const PacketCapture);
+    QMutexLocker locker(&d->mutex);
+    return d->count;
+}
+
+QString PacketCapture::errorString() const
+{
+    Q_D(const PacketCapture);
+    QMutexLocker locker(&d->mutex);
+    return d->errorString;
+}
+
+bool PacketCapturePrivate::begin()
+{
+    uchar header[Pcap::GlobalHeaderSize] = {};
+    qToLittleEndian<quint32>(Pcap::Magic, header);
+    qToLittleEndian<quint16>(Pcap::VersionMajor, header + 4);
+    qToLittleEndian<quint16>(Pcap::VersionMinor, header + 6);
+    qToLittleEndian<quint32>(Pcap::SnapLength, header + 16);
+    qToLittleEndian<quint32>(Pcap::Raw, header + 20);
+    count = 0;
+    return write(reinterpret_cast<const char*>(header), Pcap::GlobalHeaderSize);
+}
+
+bool PacketCapturePrivate::write(const char *data, int size)
+{
+    if (Q_UNLIKELY(device->write(data, size) != size)) {
+        setError(device->errorString());
+        return false;
+    }
+    return true;
+}
+
+void PacketCapturePrivate::setError(const QString &error)
+{
+    errorString = error;
+    qCCritical(SPC, "%s", qUtf8Printable(error));
+}
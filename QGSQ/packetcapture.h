@@ -0,0 +1,70 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_PACKETCAPTURE_H
+#define QGSQ_PACKETCAPTURE_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QByteArray>
+#include <QScopedPointer>
+
+class QIODevice;
+class QHostAddress;
+
+namespace QGSQ {
+
+class PacketCapturePrivate;
+
+/*
+ * Records datagrams into a pcap file with raw IP link type, so captures can
+ * be inspected with common tools and replayed with PacketReplay. IP and UDP
+ * headers are synthesized from the endpoints, checksums are left empty.
+ * Recording is thread safe, one capture can be shared by many QueryEngine
+ * and ServerQuery objects.
+ */
+class QGSQ_LIBRARY PacketCapture
+{
+public:
+    PacketCapture();
+
+    ~PacketCapture();
+
+    bool open(const QString &fileName);
+    bool open(QIODevice *device);
+    bool isOpen() const;
+    void close();
+
+    void record(const QHostAddress &source, quint16 sourcePort, const QHostAddress &destination, quint16 destinationPort, const QByteArray &payload);
+
+    quint64 count() const;
+
+    QString errorString() const;
+
+protected:
+    const QScopedPointer<PacketCapturePrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(PacketCapture)
+    Q_DECLARE_PRIVATE(PacketCapture)
+};
+
+}
+
+#endif // QGSQ_PACKETCAPTURE_H
@@ -0,0 +1,71 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_PACKETCAPTURE_P_H
+#define QGSQ_PACKETCAPTURE_P_H
+
+#include "packetcapture.h"
+#include <QMutex>
+#include <QHostAddress>
+
+class QFile;
+
+namespace QGSQ {
+
+namespace Pcap {
+const quint32 Magic = 0xa1b2c3d4;
+const quint32 MagicSwapped = 0xd4c3b2a1;
+const quint32 MagicNsec = 0xa1b23c4d;
+const quint32 MagicNsecSwapped = 0x4d3cb2a1;
+const quint16 VersionMajor = 2;
+const quint16 VersionMinor = 4;
+const quint32 SnapLength = 65535;
+const int GlobalHeaderSize = 24;
+const int RecordHeaderSize = 16;
+const int IPv4HeaderSize = 20;
+const int IPv6HeaderSize = 40;
+const int UdpHeaderSize = 8;
+const quint8 UdpProtocol = 17;
+
+enum LinkType : quint32 {
+    Ethernet    = 1,
+    Raw         = 101,
+    LinuxCooked = 113,
+    IPv4        = 228,
+    IPv6        = 229
+};
+}
+
+class PacketCapturePrivate
+{
+public:
+    bool begin();
+    bool write(const char *data, int size);
+    void setError(const QString &error);
+
+    mutable QMutex mutex;
+    QString errorString;
+    QIODevice *device = nullptr;
+    QFile *file = nullptr;
+    quint64 count = 0;
+};
+
+}
+
+#endif // QGSQ_PACKETCAPTURE_P_H
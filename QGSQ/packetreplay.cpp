@@ -0,0 +1,538 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "packetreplay_p.h"
+#include "packetcapture_p.h"
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+#include <QLoggingCategory>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(SPR, "qgsq.packetreplay")
+
+using namespace QGSQ;
+
+namespace {
+
+// 16 byte IPv6 representation (IPv4 as mapped address) and port of both ends
+QByteArray conversationKey(const QHostAddress &server, quint16 serverPort, const QHostAddress &client, quint16 clientPort)
+{
+    QByteArray key(36, '\0');
+    char *k = key.data();
+    const Q_IPV6ADDR s = server.toIPv6Address();
+    const Q_IPV6ADDR c = client.toIPv6Address();
+    memcpy(k, s.c, 16);
+    qToBigEndian<quint16>(serverPort, k + 16);
+    memcpy(k + 18, c.c, 16);
+    qToBigEndian<quint16>(clientPort, k + 34);
+    return key;
+}
+
+// A2S requests are the only datagrams sent by the querying side
+bool isRequest(const QByteArray &payload)
+{
+    if ((payload.size() < 5) || !payload.startsWith(QByteArrayLiteral("\xff\xff\xff\xff"))) {
+        return false;
+    }
+    switch (payload.at(4)) {
+    case 'T':
+    case 'V':
+    case 'U':
+    case 'W':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// the info request carries the challenge after the query string, rules and players instead of -1
+bool hasChallenge(const QByteArray &request)
+{
+    if (request.at(4) == 'T') {
+        return request.size() > 25;
+    }
+    return (request.size() >= 9) && (QByteArray::fromRawData(request.constData() + 5, 4) != QByteArrayLiteral("\xff\xff\xff\xff"));
+}
+
+// the header of a split reply is only part of its first fragment
+char splitReplyType(const QByteArray &payload)
+{
+    const auto marker = [&payload](int offset) -> bool {
+        return (payload.size() > offset + 4) && (QByteArray::fromRawData(payload.constData() + offset, 4) == QByteArrayLiteral("\xff\xff\xff\xff"));
+    };
+
+    // compressed replies can not be looked into
+    if ((payload.size() < 10) || (static_cast<uchar>(payload.at(7)) & 0x80)) {
+        return 0;
+    }
+    // Source with and without size field, GoldSource
+    if (payload.at(9) == 0) {
+        if (marker(12)) {
+            return payload.at(16);
+        }
+        if (marker(10)) {
+            return payload.at(14);
+        }
+    }
+    if (((static_cast<uchar>(payload.at(8)) >> 4) == 0) && marker(9)) {
+        return payload.at(13);
+    }
+    return 0;
+}
+
+bool answers(char requestType, bool challengeReply, char reply)
+{
+    // split replies of unknown type answer everything
+    if (reply == 0) {
+        return true;
+    }
+    if (challengeReply) {
+        return reply == 'A';
+    }
+    switch (requestType) {
+    case 'T':
+        return (reply == 'I') || (reply == 'm');
+    case 'V':
+        return reply == 'E';
+    case 'U':
+        return reply == 'D';
+    default:
+        return false;
+    }
+}
+
+}
+
+PacketReplay::PacketReplay() : d_ptr(new PacketReplayPrivate)
+{
+
+}
+
+PacketReplay::~PacketReplay()
+{
+
+}
+
+bool PacketReplay::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (Q_UNLIKELY(!file.open(QIODevice::ReadOnly))) {
+        Q_D(PacketReplay);
+        QMutexLocker locker(&d->mutex);
+        d->setError(file.errorString());
+        return false;
+    }
+    return load(&file);
+}
+
+bool PacketReplay::load(QIODevice *device)
+{
+    Q_D(PacketReplay);
+    QMutexLocker locker(&d->mutex);
+
+    if (Q_UNLIKELY(!device || !device->isReadable())) {
+        d->setError(QStringLiteral("Device is not readable."));
+        return false;
+    }
+
+    return d->parse(device->readAll());
+}
+
+QString PacketReplay::errorString() const
+{
+    Q_D(const PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    return d->errorString;
+}
+
+qreal PacketReplay::speed() const
+{
+    Q_D(const PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    return d->speed;
+}
+
+void PacketReplay::setSpeed(qreal speed)
+{
+    Q_D(PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    d->speed = (speed > 0.0) ? speed : 0.0;
+}
+
+bool PacketReplay::serverFallback() const
+{
+    Q_D(const PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    return d->serverFallback;
+}
+
+void PacketReplay::setServerFallback(bool enabled)
+{
+    Q_D(PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    d->serverFallback = enabled;
+}
+
+int PacketReplay::packetCount() const
+{
+    Q_D(const PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    return d->packetCount;
+}
+
+int PacketReplay::conversationCount() const
+{
+    Q_D(const PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    return d->conversations.size();
+}
+
+void PacketReplay::rewind()
+{
+    Q_D(PacketReplay);
+    QMutexLocker locker(&d->mutex);
+    for (ReplayConversation &c : d->conversations) {
+        for (ReplayDatagram &dg : c.datagrams) {
+            dg.used = false;
+        }
+    }
+}
+
+QList<PacketReplay::Packet> PacketReplay::replay(const QHostAddress &server, quint16 port, const QByteArray &request, int &conversation)
+{
+    QList<Packet> packets;
+
+    if (Q_UNLIKELY(request.size() < 5)) {
+        return packets;
+    }
+
+    Q_D(PacketReplay);
+    QMutexLocker locker(&d->mutex);
+
+    const char type = request.at(4);
+    const bool challenged = hasChallenge(request);
+
+    // challenge answers are usually found in the conversation of the first request
+    if ((conversation < 0) || (conversation >= d->conversations.size()) || (PacketReplayPrivate::nextRequest(d->conversations.at(conversation), type, challenged) < 0)) {
+        conversation = d->findConversation(server, port, type, challenged);
+        if (Q_UNLIKELY(conversation < 0)) {
+            qCWarning(SPR, "No recorded request '%c' left for %s:%u.", type, qUtf8Printable(server.toString()), port);
+            return packets;
+        }
+    }
+
+    ReplayConversation &c = d->conversations[conversation];
+    const int size = c.datagrams.size();
+    const int requestIndex = PacketReplayPrivate::nextRequest(c, type, challenged);
+    c.datagrams[requestIndex].used = true;
+    const qint64 sent = c.datagrams.at(requestIndex).timestamp;
+    // the request was answered with a challenge if it was sent again with one
+    const bool challengeReply = (type == 'W') || (!challenged && (PacketReplayPrivate::nextRequest(c, type, true) > requestIndex));
+
+    auto take = [&](int i) {
+        ReplayDatagram &dg = c.datagrams[i];
+        dg.used = true;
+        Packet packet;
+        if (d->speed > 0.0) {
+            packet.delay = qMax<qint64>(0, qRound64(static_cast<qreal>(dg.timestamp - sent) / d->speed));
+        }
+        packet.data = dg.payload;
+        packets.append(packet);
+    };
+
+    // replies to concurrent requests are interleaved, so the first matching one is taken
+    for (int i = requestIndex + 1; i < size; ++i) {
+        const ReplayDatagram &dg = c.datagrams.at(i);
+        if (dg.outgoing || dg.used || !answers(type, challengeReply, dg.type)) {
+            continue;
+        }
+        if (dg.split) {
+            const quint32 splitId = dg.splitId;
+            for (int j = i; j < size; ++j) {
+                const ReplayDatagram &fragment = c.datagrams.at(j);
+                if (!fragment.outgoing && !fragment.used && fragment.split && (fragment.splitId == splitId)) {
+                    take(j);
+                }
+            }
+        } else {
+            take(i);
+        }
+        break;
+    }
+
+    if (Q_UNLIKELY(packets.isEmpty())) {
+        qCDebug(SPR, "Recorded request '%c' in conversation %i was not answered.", type, conversation);
+    }
+
+    return packets;
+}
+
+bool PacketReplayPrivate::parse(const QByteArray &capture)
+{
+    conversations.clear();
+    packetCount = 0;
+
+    if (Q_UNLIKELY(capture.size() < Pcap::GlobalHeaderSize)) {
+        setError(QStringLiteral("Capture file is too short."));
+        return false;
+    }
+
+    const auto data = reinterpret_cast<const uchar*>(capture.constData());
+    const int size = capture.size();
+
+    bool bigEndian = false;
+    bool nsec = false;
+    switch (qFromLittleEndian<quint32>(data)) {
+    case Pcap::Magic:
+        break;
+    case Pcap::MagicNsec:
+        nsec = true;
+        break;
+    case Pcap::MagicSwapped:
+        bigEndian = true;
+        break;
+    case Pcap::MagicNsecSwapped:
+        bigEndian = true;
+        nsec = true;
+        break;
+    default:
+        setError(QStringLiteral("Unsupported capture file format, only pcap files are supported."));
+        return false;
+    }
+
+    auto read32 = [bigEndian](const uchar *p) -> quint32 {
+        return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+    };
+
+    // upper bits might contain FCS information
+    const quint32 linkType = read32(data + 20) & 0x0fffffff;
+    switch (linkType) {
+    case Pcap::Ethernet:
+    case Pcap::Raw:
+    case Pcap::LinuxCooked:
+    case Pcap::IPv4:
+    case Pcap::IPv6:
+        break;
+    default:
+        setError(QStringLiteral("Unsupported link type %1.").arg(linkType));
+        return false;
+    }
+
+    QHash<QByteArray,int> index;
+    int offset = Pcap::GlobalHeaderSize;
+    while (offset + Pcap::RecordHeaderSize <= size) {
+        const uchar *record = data + offset;
+        const quint32 length = read32(record + 8);
+        offset += Pcap::RecordHeaderSize;
+        if (Q_UNLIKELY(length > static_cast<quint32>(size - offset))) {
+            qCWarning(SPR, "Capture file is truncated.");
+            break;
+        }
+        const qint64 timestamp = static_cast<qint64>(read32(record)) * 1000000 + (nsec ? read32(record + 4) / 1000 : read32(record + 4));
+        addFrame(data + offset, static_cast<int>(length), linkType, timestamp, index);
+        offset += static_cast<int>(length);
+    }
+
+    resolveSplitTypes();
+
+    qCDebug(SPR, "Loaded %i datagrams in %i conversations.", packetCount, conversations.size());
+
+    return true;
+}
+
+void PacketReplayPrivate::addFrame(const uchar *frame, int size, quint32 linkType, qint64 timestamp, QHash<QByteArray,int> &index)
+{
+    int offset = 0;
+    int version = 0;
+
+    if (linkType == Pcap::Ethernet || linkType == Pcap::LinuxCooked) {
+        offset = (linkType == Pcap::Ethernet) ? 14 : 16;
+        if (size < offset) {
+            return;
+        }
+        quint16 etherType = qFromBigEndian<quint16>(frame + offset - 2);
+        // VLAN tags
+        while ((etherType == 0x8100) || (etherType == 0x88a8)) {
+            if (size < offset + 4) {
+                return;
+            }
+            etherType = qFromBigEndian<quint16>(frame + offset + 2);
+            offset += 4;
+        }
+        if (etherType == 0x0800) {
+            version = 4;
+        } else if (etherType == 0x86dd) {
+            version = 6;
+        } else {
+            return;
+        }
+    } else {
+        if (size < 1) {
+            return;
+        }
+        version = frame[0] >> 4;
+    }
+
+    const uchar *ip = frame + offset;
+    int available = size - offset;
+    QHostAddress source;
+    QHostAddress destination;
+    int headerSize = 0;
+
+    if (version == 4) {
+        if (available < Pcap::IPv4HeaderSize) {
+            return;
+        }
+        headerSize = (ip[0] & 0x0f) * 4;
+        // fragmented datagrams are not reassembled
+        if ((headerSize < Pcap::IPv4HeaderSize) || (available < headerSize) || (ip[9] != Pcap::UdpProtocol) || (qFromBigEndian<quint16>(ip + 6) & 0x3fff)) {
+            return;
+        }
+        available = qMin<int>(available, qFromBigEndian<quint16>(ip + 2));
+        source = QHostAddress(qFromBigEndian<quint32>(ip + 12));
+        destination = QHostAddress(qFromBigEndian<quint32>(ip + 16));
+    } else if (version == 6) {
+        if ((available < Pcap::IPv6HeaderSize) || (ip[6] != Pcap::UdpProtocol)) {
+            return;
+        }
+        headerSize = Pcap::IPv6HeaderSize;
+        available = qMin<int>(available, headerSize + qFromBigEndian<quint16>(ip + 4));
+        Q_IPV6ADDR addr;
+        memcpy(addr.c, ip + 8, 16);
+        source = QHostAddress(addr);
+        memcpy(addr.c, ip + 24, 16);
+        destination = QHostAddress(addr);
+    } else {
+        return;
+    }
+
+    const uchar *udp = ip + headerSize;
+    available -= headerSize;
+    if (available < Pcap::UdpHeaderSize) {
+        return;
+    }
+    const int payloadSize = qMin<int>(available, qFromBigEndian<quint16>(udp + 4)) - Pcap::UdpHeaderSize;
+    if (payloadSize <= 0) {
+        return;
+    }
+
+    const QByteArray payload(reinterpret_cast<const char*>(udp + Pcap::UdpHeaderSize), payloadSize);
+    addDatagram(source, qFromBigEndian<quint16>(udp), destination, qFromBigEndian<quint16>(udp + 2), payload, timestamp, index);
+}
+
+void PacketReplayPrivate::addDatagram(const QHostAddress &source, quint16 sourcePort, const QHostAddress &destination, quint16 destinationPort, const QByteArray &payload, qint64 timestamp, QHash<QByteArray,int> &index)
+{
+    ReplayDatagram dg;
+    dg.timestamp = timestamp;
+    dg.payload = payload;
+    dg.outgoing = isRequest(payload);
+    if (dg.outgoing) {
+        dg.type = payload.at(4);
+        dg.challenged = hasChallenge(payload);
+    } else if (payload.startsWith(QByteArrayLiteral("\xff\xff\xff\xff")) && (payload.size() > 4)) {
+        dg.type = payload.at(4);
+    } else if (payload.startsWith(QByteArrayLiteral("\xfe\xff\xff\xff")) && (payload.size() >= 8)) {
+        dg.split = true;
+        dg.splitId = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(payload.constData() + 4));
+        dg.type = splitReplyType(payload);
+    }
+
+    const QByteArray key = dg.outgoing ? conversationKey(destination, destinationPort, source, sourcePort) : conversationKey(source, sourcePort, destination, destinationPort);
+
+    int conversation = index.value(key, -1);
+    if (conversation < 0) {
+        // replies without a recorded request are useless
+        if (!dg.outgoing) {
+            return;
+        }
+        ReplayConversation c;
+        c.server = destination;
+        c.serverPort = destinationPort;
+        c.client = source;
+        c.clientPort = sourcePort;
+        conversation = conversations.size();
+        conversations.append(c);
+        index.insert(key, conversation);
+    }
+
+    conversations[conversation].datagrams.append(dg);
+    ++packetCount;
+}
+
+void PacketReplayPrivate::resolveSplitTypes()
+{
+    for (ReplayConversation &c : conversations) {
+        QHash<quint32,char> types;
+        for (const ReplayDatagram &dg : c.datagrams) {
+            if (dg.split && dg.type) {
+                types.insert(dg.splitId, dg.type);
+            }
+        }
+        for (ReplayDatagram &dg : c.datagrams) {
+            if (dg.split && !dg.type) {
+                dg.type = types.value(dg.splitId);
+            }
+        }
+    }
+}
+
+int PacketReplayPrivate::findConversation(const QHostAddress &server, quint16 port, char type, bool challenged) const
+{
+    int fallback = -1;
+    for (int i = 0; i < conversations.size(); ++i) {
+        const ReplayConversation &c = conversations.at(i);
+        if (nextRequest(c, type, challenged) < 0) {
+            continue;
+        }
+        if ((c.serverPort == port) && c.server.isEqual(server, QHostAddress::ConvertV4MappedToIPv4)) {
+            return i;
+        }
+        if (fallback < 0) {
+            fallback = i;
+        }
+    }
+
+    if (!serverFallback) {
+        return -1;
+    }
+
+    // allows to replay a capture against a different address
+    if (fallback >= 0) {
+        qCWarning(SPR, "Replaying conversation with %s:%u for %s:%u.", qUtf8Printable(conversations.at(fallback).server.toString()), conversations.at(fallback).serverPort, qUtf8Printable(server.toString()), port);
+    }
+    return fallback;
+}
+
+int PacketReplayPrivate::nextRequest(const ReplayConversation &c, char type, bool challenged)
+{
+    for (int i = 0; i < c.datagrams.size(); ++i) {
+        const ReplayDatagram &dg = c.datagrams.at(i);
+        if (dg.outgoing && !dg.used && (dg.type == type) && (dg.challenged == challenged)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PacketReplayPrivate::setError(const QString &error)
+{
+    errorString = error;
+    qCCritical(SPR, "%s", qUtf8Printable(error));
+}
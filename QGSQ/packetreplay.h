@@ -0,0 +1,91 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_PACKETREPLAY_H
+#define QGSQ_PACKETREPLAY_H
+
+#include "qgsq_global.h"
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QScopedPointer>
+
+class QIODevice;
+class QHostAddress;
+
+namespace QGSQ {
+
+class PacketReplayPrivate;
+
+/*
+ * Feeds UDP traffic recorded with PacketCapture or any other pcap writer back
+ * into QueryEngine instead of using the network. The capture is split into
+ * conversations between a query socket and a server, one conversation can
+ * contain concurrent requests of different types. Every request is bound to
+ * the first unused recorded request with the same server, type and challenge
+ * state and answered with the first unused recorded reply to it, matched by
+ * the reply header and with all fragments of a split reply. The replies are
+ * delivered with their original delays divided by the speed factor, a speed
+ * of 0 delivers them immediately. With the server fallback enabled, requests
+ * to servers without recorded requests left are answered from any other
+ * server, so captures can be replayed against other addresses. Requests are
+ * recognized by their A2S header, so only captures of Valve servers can be
+ * replayed for now.
+ */
+class QGSQ_LIBRARY PacketReplay
+{
+public:
+    struct Packet {
+        qint64 delay = 0;
+        QByteArray data;
+    };
+
+    PacketReplay();
+
+    ~PacketReplay();
+
+    bool load(const QString &fileName);
+    bool load(QIODevice *device);
+
+    QString errorString() const;
+
+    qreal speed() const;
+    void setSpeed(qreal speed);
+
+    bool serverFallback() const;
+    void setServerFallback(bool enabled);
+
+    int packetCount() const;
+    int conversationCount() const;
+
+    void rewind();
+
+    QList<Packet> replay(const QHostAddress &server, quint16 port, const QByteArray &request, int &conversation);
+
+protected:
+    const QScopedPointer<PacketReplayPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(PacketReplay)
+    Q_DECLARE_PRIVATE(PacketReplay)
+};
+
+}
+
+#endif // QGSQ_PACKETREPLAY_H
@@ -0,0 +1,72 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_PACKETREPLAY_P_H
+#define QGSQ_PACKETREPLAY_P_H
+
+#include "packetreplay.h"
+#include <QMutex>
+#include <QHostAddress>
+#include <QVector>
+#include <QHash>
+
+namespace QGSQ {
+
+struct ReplayDatagram {
+    qint64 timestamp = 0;
+    QByteArray payload;
+    quint32 splitId = 0;
+    // request type or reply header, 0 if unknown
+    char type = 0;
+    bool outgoing = false;
+    bool challenged = false;
+    bool split = false;
+    bool used = false;
+};
+
+struct ReplayConversation {
+    QHostAddress server;
+    QHostAddress client;
+    QVector<ReplayDatagram> datagrams;
+    quint16 serverPort = 0;
+    quint16 clientPort = 0;
+};
+
+class PacketReplayPrivate
+{
+public:
+    bool parse(const QByteArray &capture);
+    void addFrame(const uchar *frame, int size, quint32 linkType, qint64 timestamp, QHash<QByteArray,int> &index);
+    void addDatagram(const QHostAddress &source, quint16 sourcePort, const QHostAddress &destination, quint16 destinationPort, const QByteArray &payload, qint64 timestamp, QHash<QByteArray,int> &index);
+    void resolveSplitTypes();
+    int findConversation(const QHostAddress &server, quint16 port, char type, bool challenged) const;
+    static int nextRequest(const ReplayConversation &c, char type, bool challenged);
+    void setError(const QString &error);
+
+    mutable QMutex mutex;
+    QString errorString;
+    QVector<ReplayConversation> conversations;
+    qreal speed = 1.0;
+    int packetCount = 0;
+    bool serverFallback = false;
+};
+
+}
+
+#endif // QGSQ_PACKETREPLAY_P_H
@@ -20,4 +20,47 @@
 #ifndef QGSQ_QGSQ_H
 #define QGSQ_QGSQ_H
 
+#include <QFuture>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QList>
+#include <memory>
+
+namespace QGSQ {
+
+/*
+ * Returns a future that finishes as soon as all futures in the list have
+ * finished, no matter whether they finished with a result or got canceled.
+ * The results can afterwards be taken from the single futures. Must be
+ * called from a thread with a running event loop.
+ */
+template<typename T>
+QFuture<void> whenAll(const QList<QFuture<T>> &futures)
+{
+    QFutureInterface<void> fi;
+    fi.reportStarted();
+    const QFuture<void> all = fi.future();
+
+    if (futures.isEmpty()) {
+        fi.reportFinished();
+        return all;
+    }
+
+    auto remaining = std::make_shared<int>(futures.size());
+    for (const QFuture<T> &future : futures) {
+        auto watcher = new QFutureWatcher<T>;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [fi, remaining, watcher]() mutable {
+            watcher->deleteLater();
+            if (--(*remaining) == 0) {
+                fi.reportFinished();
+            }
+        });
+        watcher->setFuture(future);
+    }
+
+    return all;
+}
+
+}
+
 #endif // QGSQ_QGSQ_H
@@ -20,7 +20,9 @@
 #ifndef QGSQ_GLOBAL_H
 #define QGSQ_GLOBAL_H
 
-#if defined(qgsq_EXPORTS)
+#if defined(QGSQ_STATIC)
+#  define QGSQ_LIBRARY
+#elif defined(qgsq_EXPORTS)
 #  define QGSQ_LIBRARY Q_DECL_EXPORT
 #else
 #  define QGSQ_LIBRARY Q_DECL_IMPORT
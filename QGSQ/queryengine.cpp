@@ -0,0 +1,534 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "queryengine_p.h"
+#include "datagramtransport_p.h"
+#include <QLoggingCategory>
+#include <QPointer>
+
+Q_LOGGING_CATEGORY(QE, "qgsq.queryengine")
+
+using namespace QGSQ;
+
+QueryEngine::QueryEngine(QObject *parent) : QObject(parent), d_ptr(new QueryEnginePrivate)
+{
+    Q_D(QueryEngine);
+    d->q_ptr = this;
+    d->clock.start();
+    d->timer.setSingleShot(true);
+    d->timer.setTimerType(Qt::CoarseTimer);
+    connect(&d->timer, &QTimer::timeout, this, [d](){d->onTimeout();});
+}
+
+QueryEngine::~QueryEngine()
+{
+
+}
+
+int QueryEngine::timeout() const
+{
+    Q_D(const QueryEngine);
+    return d->timeout;
+}
+
+void QueryEngine::setTimeout(int timeout)
+{
+    Q_D(QueryEngine);
+    if (d->timeout != timeout) {
+        d->timeout = timeout;
+        Q_EMIT timeoutChanged(timeout);
+    }
+}
+
+int QueryEngine::socketCount() const
+{
+    Q_D(const QueryEngine);
+    return d->socketCount;
+}
+
+void QueryEngine::setSocketCount(int count)
+{
+    Q_D(QueryEngine);
+    count = qMax(count, 1);
+    if (d->socketCount != count) {
+        d->socketCount = count;
+        Q_EMIT socketCountChanged(count);
+    }
+}
+
+QueryMetrics *QueryEngine::metrics() const
+{
+    Q_D(const QueryEngine);
+    return d->metrics;
+}
+
+void QueryEngine::setMetrics(QueryMetrics *metrics)
+{
+    Q_D(QueryEngine);
+    d->metrics = metrics;
+}
+
+DatagramTransportFactory *QueryEngine::transportFactory() const
+{
+    Q_D(const QueryEngine);
+    return d->transportFactory;
+}
+
+void QueryEngine::setTransportFactory(DatagramTransportFactory *factory)
+{
+    Q_D(QueryEngine);
+    d->transportFactory = factory;
+}
+
+QueryTracer *QueryEngine::tracer() const
+{
+    Q_D(const QueryEngine);
+    return d->tracer;
+}
+
+void QueryEngine::setTracer(QueryTracer *tracer)
+{
+    Q_D(QueryEngine);
+    d->tracer = tracer;
+}
+
+PacketCapture *QueryEngine::capture() const
+{
+    Q_D(const QueryEngine);
+    return d->capture;
+}
+
+void QueryEngine::setCapture(PacketCapture *capture)
+{
+    Q_D(QueryEngine);
+    d->capture = capture;
+}
+
+PacketReplay *QueryEngine::replay() const
+{
+    Q_D(const QueryEngine);
+    return d->replay;
+}
+
+void QueryEngine::setReplay(PacketReplay *replay)
+{
+    Q_D(QueryEngine);
+    d->replay = replay;
+}
+
+bool QueryEngine::isRunning() const
+{
+    Q_D(const QueryEngine);
+    return d->running;
+}
+
+int QueryEngine::pendingRequests() const
+{
+    Q_D(const QueryEngine);
+    return d->requests.size();
+}
+
+quint32 QueryEngine::query(const QueryProtocol *protocol, const QHostAddress &server, quint16 port, int type)
+{
+    Q_D(QueryEngine);
+    return query(protocol, server, port, type, d->timeout, Callback());
+}
+
+quint32 QueryEngine::query(const QueryProtocol *protocol, const QHostAddress &server, quint16 port, int type, int timeout, const Callback &done)
+{
+    if (Q_UNLIKELY(!protocol)) {
+        qCCritical(QE, "Failed to start request without protocol.");
+        return 0;
+    }
+
+    if (Q_UNLIKELY(server.isNull() || !port)) {
+        qCCritical(QE, "Failed to start %s request, invalid server address %s:%u.", qUtf8Printable(protocol->name()), qUtf8Printable(server.toString()), port);
+        return 0;
+    }
+
+    Q_D(QueryEngine);
+
+    // 0 is never used as request id
+    do {
+        ++d->lastRequestId;
+    } while ((d->lastRequestId == 0) || d->requests.contains(d->lastRequestId));
+
+    auto request = new QueryEngineRequest;
+    request->protocol = protocol;
+    request->done = done;
+    request->endpoint = QueryEnginePrivate::endpoint(server, port);
+    request->id = d->lastRequestId;
+    request->type = type;
+    request->timeout = (timeout > 0) ? timeout : d->timeout;
+    request->socket = d->replay ? -1 : d->socketFor(request->endpoint);
+    request->deadline = d->clock.elapsed() + request->timeout;
+
+    d->requests.insert(request->id, request);
+    QueryEngineEndpoint *&ep = d->endpoints[request->endpoint];
+    if (!ep) {
+        ep = new QueryEngineEndpoint;
+    }
+    ep->requests.append(request);
+    d->deadlines.insert(request->deadline, request->id);
+    d->count(QueryMetrics::RequestsStarted);
+    d->trace(request->id, QueryTracer::Enqueued);
+    d->setRunning(true);
+    d->scheduleTimeout();
+
+    request->elapsed.start();
+    d->send(request, protocol->buildRequest(type, QByteArray()));
+    d->trace(request->id, protocol->requestsChallenge(type) ? QueryTracer::ChallengeSent : QueryTracer::RequestSent);
+
+    return request->id;
+}
+
+bool QueryEngine::abort(quint32 requestId)
+{
+    Q_D(QueryEngine);
+    QueryEngineRequest *request = d->requests.value(requestId);
+    if (!request) {
+        return false;
+    }
+    qCDebug(QE, "Aborting request %u.", requestId);
+    d->finish(request, QByteArray());
+    return true;
+}
+
+QueryEnginePrivate::~QueryEnginePrivate()
+{
+    qDeleteAll(requests);
+    qDeleteAll(endpoints);
+    // the transport factory might be deleted right after the engine, so sockets are only deferred if needed
+    for (int i = 0; i < sockets.size(); ++i) {
+        DatagramTransport *socket = sockets.at(i);
+        if (!socket) {
+            continue;
+        }
+        if (i == receiving) {
+            socket->disconnect();
+            socket->deleteLater();
+        } else {
+            delete socket;
+        }
+    }
+}
+
+QueryEndpoint QueryEnginePrivate::endpoint(const QHostAddress &address, quint16 port)
+{
+    bool isV4 = false;
+    const quint32 v4 = address.toIPv4Address(&isV4);
+    return qMakePair(isV4 ? QHostAddress(v4) : address, port);
+}
+
+int QueryEnginePrivate::socketFor(const QueryEndpoint &endpoint)
+{
+    const int index = static_cast<int>(qHash(endpoint) % static_cast<uint>(socketCount));
+    if (index >= sockets.size()) {
+        sockets.resize(index + 1);
+    }
+
+    if (!sockets.at(index)) {
+        DatagramTransport *socket = transportFactory ? transportFactory->createTransport() : new UdpSocketTransport;
+        Q_Q(QueryEngine);
+        QObject::connect(socket, &DatagramTransport::readyRead, q, [this, index](){onReadyRead(index);});
+        sockets[index] = socket;
+    }
+
+    return index;
+}
+
+void QueryEnginePrivate::send(QueryEngineRequest *request, const QByteArray &data)
+{
+    if (request->socket < 0) {
+        sendReplay(request, data);
+        return;
+    }
+
+    const QueryEndpoint &ep = request->endpoint;
+    DatagramTransport *socket = sockets.at(request->socket);
+    qCDebug(QE, "Sending %s request \"%s\" to %s:%u.", qUtf8Printable(request->protocol->name()), data.toHex().constData(), qUtf8Printable(ep.first.toString()), ep.second);
+    if (Q_UNLIKELY(!socket->writeDatagram(data, ep.first, ep.second))) {
+        qCCritical(QE, "Failed to send request to %s:%u.", qUtf8Printable(ep.first.toString()), ep.second);
+        return;
+    }
+    if (capture) {
+        capture->record(socket->localAddress(), socket->localPort(), ep.first, ep.second, data);
+    }
+    count(QueryMetrics::PacketsSent);
+    count(QueryMetrics::BytesSent, static_cast<quint64>(data.size()));
+}
+
+void QueryEnginePrivate::sendReplay(QueryEngineRequest *request, const QByteArray &data)
+{
+    count(QueryMetrics::PacketsSent);
+    count(QueryMetrics::BytesSent, static_cast<quint64>(data.size()));
+    if (Q_UNLIKELY(!replay)) {
+        return;
+    }
+
+    const QueryEndpoint &ep = request->endpoint;
+    const auto packets = replay->replay(ep.first, ep.second, data, request->replayConversation);
+    Q_Q(QueryEngine);
+    const quint32 id = request->id;
+    for (const PacketReplay::Packet &packet : packets) {
+        Datagram datagram;
+        datagram.data = packet.data;
+        datagram.sender = ep.first;
+        datagram.senderPort = ep.second;
+        // the request might be finished or aborted before the packet is due
+        QTimer::singleShot(static_cast<int>(packet.delay / 1000), Qt::PreciseTimer, q, [this, id, datagram](){
+            if (requests.contains(id)) {
+                processDatagram(datagram);
+            }
+        });
+    }
+}
+
+void QueryEnginePrivate::onReadyRead(int socket)
+{
+    Q_Q(QueryEngine);
+    // the engine might be deleted by a receiver of its signals
+    QPointer<QueryEngine> guard(q);
+    DatagramTransport *transport = sockets.at(socket);
+    const int previous = receiving;
+    receiving = socket;
+    Datagram datagram;
+    while (guard && transport->receiveDatagram(&datagram)) {
+        if (capture) {
+            capture->record(datagram.sender, datagram.senderPort, transport->localAddress(), transport->localPort(), datagram.data);
+        }
+        processDatagram(datagram);
+    }
+    if (guard) {
+        receiving = previous;
+    }
+}
+
+void QueryEnginePrivate::processDatagram(const Datagram &datagram)
+{
+    count(QueryMetrics::PacketsReceived);
+    count(QueryMetrics::BytesReceived, static_cast<quint64>(datagram.data.size()));
+
+    QueryEngineEndpoint *ep = endpoints.value(endpoint(datagram.sender, datagram.senderPort));
+    if (Q_UNLIKELY(!ep)) {
+        qCWarning(QE, "Dropping datagram from unexpected sender %s:%u.", qUtf8Printable(datagram.sender.toString()), datagram.senderPort);
+        count(QueryMetrics::InvalidReplies);
+        return;
+    }
+
+    // the protocol of the oldest request that understands the datagram unpacks it
+    for (const QueryEngineRequest *request : ep->requests) {
+        const QueryProtocol *protocol = request->protocol;
+        QByteArray payload;
+        const auto packet = protocol->unpack(datagram.data, &payload);
+        if (packet == QueryProtocol::SinglePacket) {
+            processReply(ep, protocol, payload, -1);
+            return;
+        } else if (packet == QueryProtocol::SplitPacket) {
+            addFragment(ep, protocol, datagram.data);
+            return;
+        }
+    }
+
+    qCWarning(QE, "Received invalid datagram from %s:%u.", qUtf8Printable(datagram.sender.toString()), datagram.senderPort);
+    count(QueryMetrics::InvalidReplies);
+}
+
+void QueryEnginePrivate::addFragment(QueryEngineEndpoint *ep, const QueryProtocol *protocol, const QByteArray &datagram)
+{
+    count(QueryMetrics::SplitPackets);
+
+    const quint32 id = protocol->splitId(datagram);
+    QueryEngineSplit &split = ep->splits[id];
+    if (!split.reassembler) {
+        split.reassembler = protocol->createReassembler();
+        if (Q_UNLIKELY(!split.reassembler)) {
+            qCWarning(QE, "Received split packet, but %s does not split replies.", qUtf8Printable(protocol->name()));
+            ep->splits.remove(id);
+            count(QueryMetrics::InvalidReplies);
+            return;
+        }
+        // the first fragment can only be traced when the reply is attributed
+        split.firstFragment = tracer ? QueryTracer::timestamp() : 0;
+    }
+
+    const auto status = split.reassembler->add(datagram);
+    if (status == QueryReassembler::Incomplete) {
+        return;
+    }
+
+    const QByteArray payload = split.reassembler->result();
+    const qint64 firstFragment = split.firstFragment;
+    delete split.reassembler;
+    ep->splits.remove(id);
+
+    if (status == QueryReassembler::Failed) {
+        // the request the reply belongs to is unknown, it runs into its timeout
+        count(QueryMetrics::InvalidReplies);
+        return;
+    }
+
+    processReply(ep, protocol, payload, firstFragment);
+}
+
+void QueryEnginePrivate::processReply(QueryEngineEndpoint *ep, const QueryProtocol *protocol, const QByteArray &payload, qint64 firstFragment)
+{
+    // the oldest request the reply matches gets it, a challenge goes to the oldest request still waiting for one
+    QueryEngineRequest *challenged = nullptr;
+    QByteArray challenge;
+    for (QueryEngineRequest *request : ep->requests) {
+        if (request->protocol != protocol) {
+            continue;
+        }
+        QByteArray c;
+        const auto reply = protocol->matchReply(request->type, payload, &c);
+        if (reply == QueryProtocol::ExpectedReply) {
+            traceReassembly(request->id, firstFragment);
+            finish(request, payload);
+            return;
+        } else if ((reply == QueryProtocol::ChallengeReply) && (!challenged || (challenged->challenged && !request->challenged))) {
+            challenged = request;
+            challenge = c;
+        }
+    }
+
+    if (challenged) {
+        traceReassembly(challenged->id, firstFragment);
+        answerChallenge(challenged, challenge);
+        return;
+    }
+
+    qCWarning(QE, "Received unexpected %s reply.", qUtf8Printable(protocol->name()));
+    count(QueryMetrics::InvalidReplies);
+}
+
+void QueryEnginePrivate::answerChallenge(QueryEngineRequest *request, const QByteArray &challenge)
+{
+    count(QueryMetrics::Challenges);
+    trace(request->id, QueryTracer::ChallengeReceived);
+    request->challenged = true;
+
+    Q_Q(QueryEngine);
+    QPointer<QueryEngine> guard(q);
+    const quint32 id = request->id;
+    Q_EMIT q->gotChallenge(id, challenge);
+    // a receiver might have aborted the request or deleted the engine
+    if (!guard || !requests.contains(id)) {
+        return;
+    }
+
+    send(request, request->protocol->buildRequest(request->type, challenge));
+    trace(id, QueryTracer::RequestSent);
+}
+
+void QueryEnginePrivate::finish(QueryEngineRequest *request, const QByteArray &payload)
+{
+    const quint32 id = request->id;
+    const bool succeeded = !payload.isEmpty();
+    const QueryEngine::Callback done = request->done;
+    QueryTracer *_tracer = tracer;
+    if (metrics) {
+        if (succeeded) {
+            metrics->add(QueryMetrics::RequestsSucceeded);
+            const int latencyType = request->protocol->latencyType(request->type);
+            if ((latencyType >= 0) && (latencyType < QueryMetrics::QueryTypeCount)) {
+                metrics->recordLatency(static_cast<QueryMetrics::QueryType>(latencyType), request->elapsed.nsecsElapsed() / 1000);
+            }
+        } else {
+            metrics->add(QueryMetrics::RequestsFailed);
+        }
+    }
+
+    removeRequest(request);
+
+    Q_Q(QueryEngine);
+    QPointer<QueryEngine> guard(q);
+    if (done) {
+        done(id, payload);
+    }
+    if (guard && succeeded) {
+        Q_EMIT q->gotReply(id, payload);
+    }
+    if (Q_UNLIKELY(_tracer)) {
+        _tracer->traceEvent(id, QueryTracer::Delivered, QueryTracer::timestamp());
+    }
+    if (guard) {
+        Q_EMIT q->requestFinished(id, succeeded);
+    }
+}
+
+void QueryEnginePrivate::removeRequest(QueryEngineRequest *request)
+{
+    requests.remove(request->id);
+
+    // replies being reassembled are dropped with the last request to the server
+    auto it = endpoints.find(request->endpoint);
+    if (it != endpoints.end()) {
+        it.value()->requests.removeOne(request);
+        if (it.value()->requests.isEmpty()) {
+            delete it.value();
+            endpoints.erase(it);
+        }
+    }
+
+    auto dit = deadlines.find(request->deadline, request->id);
+    if (dit != deadlines.end()) {
+        deadlines.erase(dit);
+    }
+
+    delete request;
+    setRunning(!requests.isEmpty());
+    scheduleTimeout();
+}
+
+void QueryEnginePrivate::scheduleTimeout()
+{
+    if (deadlines.isEmpty()) {
+        timer.stop();
+        return;
+    }
+
+    const qint64 remaining = deadlines.firstKey() - clock.elapsed();
+    timer.start(static_cast<int>(qMax(remaining, Q_INT64_C(0))));
+}
+
+void QueryEnginePrivate::onTimeout()
+{
+    Q_Q(QueryEngine);
+    QPointer<QueryEngine> guard(q);
+    const qint64 now = clock.elapsed();
+    while (guard && !deadlines.isEmpty() && (deadlines.firstKey() <= now)) {
+        QueryEngineRequest *request = requests.value(deadlines.first());
+        const QueryEndpoint &ep = request->endpoint;
+        qCWarning(QE, "Timeout within %ims while waiting for %s reply from %s:%u.", request->timeout, qUtf8Printable(request->protocol->name()), qUtf8Printable(ep.first.toString()), ep.second);
+        count(QueryMetrics::Timeouts);
+        finish(request, QByteArray());
+    }
+}
+
+void QueryEnginePrivate::setRunning(bool _running)
+{
+    if (running != _running) {
+        running = _running;
+        Q_Q(QueryEngine);
+        Q_EMIT q->runningChanged(running);
+    }
+}
+
+#include "moc_queryengine.cpp"
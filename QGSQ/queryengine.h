@@ -0,0 +1,125 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_QUERYENGINE_H
+#define QGSQ_QUERYENGINE_H
+
+#include "qgsq_global.h"
+#include <QObject>
+#include <QHostAddress>
+#include <functional>
+
+namespace QGSQ {
+
+class QueryMetrics;
+class DatagramTransportFactory;
+class QueryTracer;
+class PacketCapture;
+class PacketReplay;
+class QueryProtocol;
+class QueryEnginePrivate;
+
+/*
+ * Protocol independent query engine. Requests of any QueryProtocol run
+ * concurrently over a small pool of shared sockets, replies are matched to
+ * the requests by sender and protocol. All requests to one server use the
+ * same socket, so challenges that are bound to the client port stay valid.
+ * A single timer handles the timeouts of all requests. ServerQuery runs its
+ * asynchronous requests on an engine as well, several ServerQuery objects
+ * can share one with ServerQuery::setEngine().
+ */
+class QGSQ_LIBRARY QueryEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(int socketCount READ socketCount WRITE setSocketCount NOTIFY socketCountChanged)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+public:
+    typedef std::function<void(quint32, const QByteArray &)> Callback;
+
+    explicit QueryEngine(QObject *parent = nullptr);
+
+    ~QueryEngine();
+
+    int timeout() const;
+    void setTimeout(int timeout);
+
+    /*
+     * Number of sockets requests are distributed over, sockets are created
+     * on first use. Changing it only affects sockets that do not exist yet.
+     */
+    int socketCount() const;
+    void setSocketCount(int count);
+
+    QueryMetrics *metrics() const;
+    void setMetrics(QueryMetrics *metrics);
+
+    DatagramTransportFactory *transportFactory() const;
+    void setTransportFactory(DatagramTransportFactory *factory);
+
+    QueryTracer *tracer() const;
+    void setTracer(QueryTracer *tracer);
+
+    PacketCapture *capture() const;
+    void setCapture(PacketCapture *capture);
+
+    // requests started while a replay is set use it instead of the sockets
+    PacketReplay *replay() const;
+    void setReplay(PacketReplay *replay);
+
+    bool isRunning() const;
+    int pendingRequests() const;
+
+    /*
+     * Starts a request of the protocol specific type and returns its id.
+     * The protocol has to outlive the request.
+     */
+    quint32 query(const QueryProtocol *protocol, const QHostAddress &server, quint16 port, int type);
+
+    /*
+     * Same as above with its own timeout in milliseconds. done is called
+     * with the request id and the payload, or an empty byte array on
+     * failure, before gotReply() and requestFinished() are emitted. It is
+     * not called if the request can not be started or the engine is deleted
+     * before the request finished.
+     */
+    quint32 query(const QueryProtocol *protocol, const QHostAddress &server, quint16 port, int type, int timeout, const Callback &done);
+
+    // finishes a pending request as failed, requestFinished() is emitted
+    bool abort(quint32 requestId);
+
+Q_SIGNALS:
+    void gotChallenge(quint32 requestId, const QByteArray &challenge);
+    void gotReply(quint32 requestId, const QByteArray &payload);
+    void requestFinished(quint32 requestId, bool succeeded);
+    void timeoutChanged(int timeout);
+    void socketCountChanged(int socketCount);
+    void runningChanged(bool running);
+
+protected:
+    const QScopedPointer<QueryEnginePrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(QueryEngine)
+    Q_DECLARE_PRIVATE(QueryEngine)
+};
+
+}
+
+#endif // QGSQ_QUERYENGINE_H
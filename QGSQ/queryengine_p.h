@@ -0,0 +1,163 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_QUERYENGINE_P_H
+#define QGSQ_QUERYENGINE_P_H
+
+#include "queryengine.h"
+#include "queryprotocol.h"
+#include "querymetrics.h"
+#include "querytracer.h"
+#include "packetcapture.h"
+#include "packetreplay.h"
+#include "datagramtransport.h"
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace QGSQ {
+
+typedef QPair<QHostAddress,quint16> QueryEndpoint;
+
+class QueryEngineRequest
+{
+public:
+    QueryEngineRequest() {}
+
+    const QueryProtocol *protocol = nullptr;
+    QueryEngine::Callback done;
+    QElapsedTimer elapsed;
+    QueryEndpoint endpoint;
+    qint64 deadline = 0;
+    quint32 id = 0;
+    int type = 0;
+    int timeout = 0;
+    // -1 if the request is answered by the replay
+    int socket = 0;
+    int replayConversation = -1;
+    bool challenged = false;
+
+private:
+    Q_DISABLE_COPY(QueryEngineRequest)
+};
+
+struct QueryEngineSplit {
+    QueryReassembler *reassembler = nullptr;
+    // only taken with a tracer
+    qint64 firstFragment = 0;
+};
+
+/*
+ * Pending requests of a server and the replies being reassembled. Split
+ * replies are kept by split id, as they can only be attributed to a request
+ * when they are complete.
+ */
+class QueryEngineEndpoint
+{
+public:
+    QueryEngineEndpoint() {}
+
+    ~QueryEngineEndpoint()
+    {
+        for (const QueryEngineSplit &split : splits) {
+            delete split.reassembler;
+        }
+    }
+
+    // in start order
+    QList<QueryEngineRequest*> requests;
+    QHash<quint32,QueryEngineSplit> splits;
+
+private:
+    Q_DISABLE_COPY(QueryEngineEndpoint)
+};
+
+class QueryEnginePrivate
+{
+public:
+    QueryEnginePrivate() {}
+
+    virtual ~QueryEnginePrivate();
+
+    // IPv4 mapped senders are stored as IPv4, so they match the queried address
+    static QueryEndpoint endpoint(const QHostAddress &address, quint16 port);
+    int socketFor(const QueryEndpoint &endpoint);
+    void send(QueryEngineRequest *request, const QByteArray &data);
+    void sendReplay(QueryEngineRequest *request, const QByteArray &data);
+    void onReadyRead(int socket);
+    void processDatagram(const Datagram &datagram);
+    void addFragment(QueryEngineEndpoint *ep, const QueryProtocol *protocol, const QByteArray &datagram);
+    // firstFragment is -1 for replies that have not been split
+    void processReply(QueryEngineEndpoint *ep, const QueryProtocol *protocol, const QByteArray &payload, qint64 firstFragment);
+    void answerChallenge(QueryEngineRequest *request, const QByteArray &challenge);
+    void finish(QueryEngineRequest *request, const QByteArray &payload);
+    void removeRequest(QueryEngineRequest *request);
+    void scheduleTimeout();
+    void onTimeout();
+    void setRunning(bool _running);
+    inline void count(QueryMetrics::Counter counter, quint64 value = 1)
+    {
+        if (metrics) {
+            metrics->add(counter, value);
+        }
+    }
+    inline void trace(quint32 requestId, QueryTracer::Event event) const
+    {
+        if (Q_UNLIKELY(tracer)) {
+            tracer->traceEvent(requestId, event, QueryTracer::timestamp());
+        }
+    }
+    inline void traceReassembly(quint32 requestId, qint64 firstFragment) const
+    {
+        if (Q_UNLIKELY(tracer) && (firstFragment >= 0)) {
+            tracer->traceEvent(requestId, QueryTracer::FirstFragment, firstFragment);
+            tracer->traceEvent(requestId, QueryTracer::ReassemblyComplete, QueryTracer::timestamp());
+        }
+    }
+
+    Q_DECLARE_PUBLIC(QueryEngine)
+    QueryEngine *q_ptr = nullptr;
+    QVector<DatagramTransport*> sockets;
+    QHash<quint32,QueryEngineRequest*> requests;
+    QHash<QueryEndpoint,QueryEngineEndpoint*> endpoints;
+    QMultiMap<qint64,quint32> deadlines;
+    QTimer timer;
+    QElapsedTimer clock;
+    QueryMetrics *metrics = nullptr;
+    DatagramTransportFactory *transportFactory = nullptr;
+    QueryTracer *tracer = nullptr;
+    PacketCapture *capture = nullptr;
+    PacketReplay *replay = nullptr;
+    int timeout = 4000;
+    // socket whose readyRead() is handled, it can not be deleted directly
+    int receiving = -1;
+    int socketCount = 1;
+    quint32 lastRequestId = 0;
+    bool running = false;
+
+private:
+    Q_DISABLE_COPY(QueryEnginePrivate)
+};
+
+}
+
+#endif // QGSQ_QUERYENGINE_P_H
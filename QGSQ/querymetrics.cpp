@@ -0,0 +1,217 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "querymetrics_p.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+using namespace QGSQ;
+
+namespace {
+
+struct CounterDescription {
+    const char *name;
+    const char *help;
+};
+
+const CounterDescription counterDescriptions[QueryMetrics::CounterCount] = {
+    {"requests_started_total", "Number of started queries."},
+    {"requests_succeeded_total", "Number of queries that received a valid reply."},
+    {"requests_failed_total", "Number of queries that failed or timed out."},
+    {"packets_sent_total", "Number of sent datagrams."},
+    {"sent_bytes_total", "Number of sent bytes."},
+    {"packets_received_total", "Number of received datagrams."},
+    {"received_bytes_total", "Number of received bytes."},
+    {"split_packets_total", "Number of received split packets."},
+    {"challenges_total", "Number of received challenges."},
+    {"timeouts_total", "Number of queries that timed out."},
+    {"invalid_replies_total", "Number of dropped invalid or unexpected datagrams."},
+    {"filtered_replies_total", "Number of server info replies rejected by an info filter."}
+};
+
+const char *queryTypeNames[QueryMetrics::QueryTypeCount] = {"info", "rules", "players"};
+
+}
+
+QueryMetrics::QueryMetrics() : d_ptr(new QueryMetricsPrivate)
+{
+
+}
+
+QueryMetrics::~QueryMetrics()
+{
+
+}
+
+void QueryMetrics::add(Counter counter, quint64 value)
+{
+    Q_D(QueryMetrics);
+    Q_ASSERT(counter < CounterCount);
+    d->counters[counter].fetchAndAddRelaxed(value);
+}
+
+quint64 QueryMetrics::counter(Counter counter) const
+{
+    Q_D(const QueryMetrics);
+    Q_ASSERT(counter < CounterCount);
+    return d->counters[counter].load();
+}
+
+void QueryMetrics::recordLatency(QueryType type, qint64 usecs)
+{
+    Q_D(QueryMetrics);
+    Q_ASSERT(type < QueryTypeCount);
+    const quint64 value = (usecs > 0) ? static_cast<quint64>(usecs) : 0;
+    d->buckets[type][QueryMetricsPrivate::bucketIndex(value)].fetchAndAddRelaxed(1);
+    d->sums[type].fetchAndAddRelaxed(value);
+}
+
+quint64 QueryMetrics::latencyCount(QueryType type) const
+{
+    Q_D(const QueryMetrics);
+    Q_ASSERT(type < QueryTypeCount);
+    quint64 count = 0;
+    for (int i = 0; i < QueryMetricsPrivate::BucketCount; ++i) {
+        count += d->buckets[type][i].load();
+    }
+    return count;
+}
+
+quint64 QueryMetrics::latencySum(QueryType type) const
+{
+    Q_D(const QueryMetrics);
+    Q_ASSERT(type < QueryTypeCount);
+    return d->sums[type].load();
+}
+
+qint64 QueryMetrics::latencyPercentile(QueryType type, double percentile) const
+{
+    Q_D(const QueryMetrics);
+    Q_ASSERT(type < QueryTypeCount);
+
+    quint64 counts[QueryMetricsPrivate::BucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < QueryMetricsPrivate::BucketCount; ++i) {
+        counts[i] = d->buckets[type][i].load();
+        total += counts[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    const double p = qBound(0.0, percentile, 100.0);
+    const auto target = qMax<quint64>(1, static_cast<quint64>(std::ceil(p / 100.0 * static_cast<double>(total))));
+
+    quint64 cumulative = 0;
+    for (int i = 0; i < QueryMetricsPrivate::BucketCount; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= target) {
+            return static_cast<qint64>(QueryMetricsPrivate::bucketUpperBound(i));
+        }
+    }
+
+    return static_cast<qint64>(QueryMetricsPrivate::bucketUpperBound(QueryMetricsPrivate::BucketCount - 1));
+}
+
+QByteArray QueryMetrics::toPrometheus(const QByteArray &prefix) const
+{
+    Q_D(const QueryMetrics);
+
+    QByteArray out;
+    out.reserve(8192);
+
+    for (int i = 0; i < CounterCount; ++i) {
+        const QByteArray name = prefix + '_' + counterDescriptions[i].name;
+        out += "# HELP " + name + ' ' + counterDescriptions[i].help + '\n';
+        out += "# TYPE " + name + " counter\n";
+        out += name + ' ' + QByteArray::number(d->counters[i].load()) + '\n';
+    }
+
+    const QByteArray histogram = prefix + "_query_duration_seconds";
+    out += "# HELP " + histogram + " Duration of successful queries.\n";
+    out += "# TYPE " + histogram + " histogram\n";
+
+    for (int type = 0; type < QueryTypeCount; ++type) {
+        const QByteArray label = QByteArrayLiteral("type=\"") + queryTypeNames[type] + '"';
+        quint64 cumulative = 0;
+        int bucket = 0;
+        // export the bounds at powers of two from 16us up to about 67s, they match bucket bounds exactly
+        for (int exponent = 4; exponent <= 26; ++exponent) {
+            const quint64 bound = Q_UINT64_C(1) << exponent;
+            while ((bucket < QueryMetricsPrivate::BucketCount) && (QueryMetricsPrivate::bucketUpperBound(bucket) <= bound)) {
+                cumulative += d->buckets[type][bucket].load();
+                ++bucket;
+            }
+            out += histogram + "_bucket{" + label + ",le=\"" + QByteArray::number(static_cast<double>(bound) / 1000000.0, 'g', 8) + "\"} " + QByteArray::number(cumulative) + '\n';
+        }
+        while (bucket < QueryMetricsPrivate::BucketCount) {
+            cumulative += d->buckets[type][bucket].load();
+            ++bucket;
+        }
+        out += histogram + "_bucket{" + label + ",le=\"+Inf\"} " + QByteArray::number(cumulative) + '\n';
+        out += histogram + "_sum{" + label + "} " + QByteArray::number(static_cast<double>(d->sums[type].load()) / 1000000.0, 'g', 12) + '\n';
+        out += histogram + "_count{" + label + "} " + QByteArray::number(cumulative) + '\n';
+    }
+
+    return out;
+}
+
+void QueryMetrics::reset()
+{
+    Q_D(QueryMetrics);
+    for (int i = 0; i < CounterCount; ++i) {
+        d->counters[i].store(0);
+    }
+    for (int type = 0; type < QueryTypeCount; ++type) {
+        for (int i = 0; i < QueryMetricsPrivate::BucketCount; ++i) {
+            d->buckets[type][i].store(0);
+        }
+        d->sums[type].store(0);
+    }
+}
+
+int QueryMetricsPrivate::bucketIndex(quint64 usecs)
+{
+    // a value exactly on an upper bound belongs to the bucket below, like in the le buckets of Prometheus
+    const quint64 value = (usecs > 0) ? usecs - 1 : 0;
+    if (value < static_cast<quint64>(LinearBuckets)) {
+        return static_cast<int>(value);
+    }
+
+    const int exponent = 63 - static_cast<int>(qCountLeadingZeroBits(value));
+    if (Q_UNLIKELY(exponent > MaxExponent)) {
+        return BucketCount - 1;
+    }
+
+    const int sub = static_cast<int>((value >> (exponent - SubBucketBits)) & (SubBuckets - 1));
+    return LinearBuckets + (exponent - 4) * SubBuckets + sub;
+}
+
+quint64 QueryMetricsPrivate::bucketUpperBound(int index)
+{
+    if (index < LinearBuckets) {
+        return static_cast<quint64>(index + 1);
+    }
+
+    const int exponent = (index - LinearBuckets) / SubBuckets + 4;
+    const int sub = (index - LinearBuckets) % SubBuckets;
+    return static_cast<quint64>(SubBuckets + sub + 1) << (exponent - SubBucketBits);
+}
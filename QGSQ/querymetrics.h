@@ -0,0 +1,92 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQ_QUERYMETRICS_H
+#define QGSQ_QUERYMETRICS_H
+
+#include "qgsq_global.h"
+#include <QByteArray>
+#include <QScopedPointer>
+
+namespace QGSQ {
+
+class QueryMetricsPrivate;
+
+/*
+ * Counters and latency histograms of the query engine. A metrics object can
+ * be shared by any number of ServerQuery and QueryEngine objects, even in
+ * different threads.
+ * All values are updated and read with atomic operations, so they can be
+ * read from another thread without locking. Latencies are stored in
+ * microseconds in log-linear buckets with a relative error below 12.5%.
+ */
+class QGSQ_LIBRARY QueryMetrics
+{
+public:
+    enum Counter : quint8 {
+        RequestsStarted     = 0,
+        RequestsSucceeded   = 1,
+        RequestsFailed      = 2,
+        PacketsSent         = 3,
+        BytesSent           = 4,
+        PacketsReceived     = 5,
+        BytesReceived       = 6,
+        SplitPackets        = 7,
+        Challenges          = 8,
+        Timeouts            = 9,
+        InvalidReplies      = 10,
+        FilteredReplies     = 11,
+        CounterCount        = 12
+    };
+
+    enum QueryType : quint8 {
+        Info            = 0,
+        Rules           = 1,
+        Players         = 2,
+        QueryTypeCount  = 3
+    };
+
+    QueryMetrics();
+
+    ~QueryMetrics();
+
+    void add(Counter counter, quint64 value = 1);
+    quint64 counter(Counter counter) const;
+
+    void recordLatency(QueryType type, qint64 usecs);
+    quint64 latencyCount(QueryType type) const;
+    quint64 latencySum(QueryType type) const;
+    qint64 latencyPercentile(QueryType type, double percentile) const;
+
+    QByteArray toPrometheus(const QByteArray &prefix = QByteArrayLiteral("qgsq")) const;
+
+    void reset();
+
+protected:
+    const QScopedPointer<QueryMetricsPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(QueryMetrics)
+    Q_DECLARE_PRIVATE(QueryMetrics)
+};
+
+}
+
+#endif // QGSQ_QUERYMETRICS_H
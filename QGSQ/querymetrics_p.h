@@ -0,0 +1,50 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQ_QUERYMETRICS_P_H
+#define QGSQ_QUERYMETRICS_P_H
+
+#include "querymetrics.h"
+#include <QAtomicInteger>
+
+namespace QGSQ {
+
+class QueryMetricsPrivate
+{
+public:
+    // values up to 16us get their own bucket, above every power of two is split into 8 buckets,
+    // the upper bound of a bucket is inclusive
+    static const int LinearBuckets = 16;
+    static const int SubBuckets = 8;
+    static const int SubBucketBits = 3;
+    static const int MaxExponent = 35;
+    static const int BucketCount = LinearBuckets + (MaxExponent - 3) * SubBuckets;
+
+    static int bucketIndex(quint64 usecs);
+    static quint64 bucketUpperBound(int index);
+
+    QAtomicInteger<quint64> counters[QueryMetrics::CounterCount];
+    QAtomicInteger<quint64> buckets[QueryMetrics::QueryTypeCount][BucketCount];
+    QAtomicInteger<quint64> sums[QueryMetrics::QueryTypeCount];
+};
+
+}
+
+#endif // QGSQ_QUERYMETRICS_P_H
@@ -0,0 +1,55 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "queryprotocol.h"
+
+using namespace QGSQ;
+
+QueryReassembler::~QueryReassembler()
+{
+
+}
+
+QueryProtocol::~QueryProtocol()
+{
+
+}
+
+bool QueryProtocol::requestsChallenge(int type) const
+{
+    Q_UNUSED(type);
+    return false;
+}
+
+QueryReassembler *QueryProtocol::createReassembler() const
+{
+    return nullptr;
+}
+
+quint32 QueryProtocol::splitId(const QByteArray &datagram) const
+{
+    Q_UNUSED(datagram);
+    return 0;
+}
+
+int QueryProtocol::latencyType(int type) const
+{
+    Q_UNUSED(type);
+    return -1;
+}
@@ -0,0 +1,110 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_QUERYPROTOCOL_H
+#define QGSQ_QUERYPROTOCOL_H
+
+#include "qgsq_global.h"
+#include <QByteArray>
+#include <QString>
+#include <QJsonObject>
+
+namespace QGSQ {
+
+/*
+ * Reassembles a reply that is split over multiple datagrams. QueryEngine
+ * creates one reassembler per server and split id with
+ * QueryProtocol::createReassembler().
+ */
+class QGSQ_LIBRARY QueryReassembler
+{
+public:
+    enum Status : quint8 {
+        Incomplete  = 0,
+        Complete    = 1,
+        Failed      = 2
+    };
+
+    virtual ~QueryReassembler();
+
+    virtual Status add(const QByteArray &datagram) = 0;
+    virtual QByteArray result() const = 0;
+    virtual void clear() = 0;
+};
+
+/*
+ * Wire format of a game server query protocol, used by QueryEngine to run
+ * the requests of any game family over the same sockets. The request type
+ * is defined by the protocol. One protocol object serves all requests, so
+ * an implementation must not keep per request state outside of the
+ * reassembler.
+ *
+ * A request is sent as returned by buildRequest() without challenge. Every
+ * datagram of the queried server is unpacked into a payload or a fragment
+ * for the reassembler of its split id. Complete payloads are given to
+ * matchReply() for every pending request to the server, as the reply can
+ * not be attributed before. On a challenge the request is sent again with
+ * it, an expected reply finishes the request and can be turned into JSON
+ * with parse().
+ */
+class QGSQ_LIBRARY QueryProtocol
+{
+public:
+    enum Packet : quint8 {
+        InvalidPacket   = 0,
+        SinglePacket    = 1,
+        SplitPacket     = 2
+    };
+
+    enum Reply : quint8 {
+        UnexpectedReply = 0,
+        ExpectedReply   = 1,
+        ChallengeReply  = 2
+    };
+
+    virtual ~QueryProtocol();
+
+    virtual QString name() const = 0;
+    virtual quint16 defaultPort() const = 0;
+
+    virtual QByteArray buildRequest(int type, const QByteArray &challenge) const = 0;
+
+    // true if the request without challenge only asks for one
+    virtual bool requestsChallenge(int type) const;
+
+    // the payload of a single packet reply is stored without the packet header
+    virtual Packet unpack(const QByteArray &datagram, QByteArray *payload) const = 0;
+
+    // returns nullptr if the protocol does not split replies
+    virtual QueryReassembler *createReassembler() const;
+
+    // fragments with the same id belong to the same reply
+    virtual quint32 splitId(const QByteArray &datagram) const;
+
+    virtual Reply matchReply(int type, const QByteArray &payload, QByteArray *challenge) const = 0;
+
+    virtual QJsonObject parse(int type, const QByteArray &payload) const = 0;
+
+    // latency histogram of QueryMetrics used for the request type, -1 for none
+    virtual int latencyType(int type) const;
+};
+
+}
+
+#endif // QGSQ_QUERYPROTOCOL_H
@@ -0,0 +1,58 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "querytracer.h"
+#include <chrono>
+
+using namespace QGSQ;
+
+QueryTracer::~QueryTracer()
+{
+
+}
+
+qint64 QueryTracer::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *QueryTracer::eventName(Event event)
+{
+    switch (event) {
+    case Enqueued:
+        return "enqueued";
+    case ChallengeSent:
+        return "challengeSent";
+    case ChallengeReceived:
+        return "challengeReceived";
+    case RequestSent:
+        return "requestSent";
+    case FirstFragment:
+        return "firstFragment";
+    case ReassemblyComplete:
+        return "reassemblyComplete";
+    case ParseDone:
+        return "parseDone";
+    case Delivered:
+        return "delivered";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,63 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQ_QUERYTRACER_H
+#define QGSQ_QUERYTRACER_H
+
+#include "qgsq_global.h"
+
+namespace QGSQ {
+
+/*
+ * Interface for tracing the phases of asynchronous queries. Install an
+ * implementation with QueryEngine::setTracer() or ServerQuery::setTracer(),
+ * it has to outlive the engine. traceEvent() is called in the thread of the
+ * engine with the request id and a monotonic timestamp in nanoseconds.
+ * FirstFragment and ReassemblyComplete are only traced for replies split
+ * over multiple datagrams, when the complete reply has been attributed to
+ * its request. ParseDone is traced by ServerQuery only. Without tracer the
+ * engine only checks a null pointer.
+ */
+class QGSQ_LIBRARY QueryTracer
+{
+public:
+    enum Event : quint8 {
+        Enqueued            = 0,
+        ChallengeSent       = 1,
+        ChallengeReceived   = 2,
+        RequestSent         = 3,
+        FirstFragment       = 4,
+        ReassemblyComplete  = 5,
+        ParseDone           = 6,
+        Delivered           = 7
+    };
+
+    virtual ~QueryTracer();
+
+    virtual void traceEvent(quint32 requestId, Event event, qint64 timestamp) = 0;
+
+    static qint64 timestamp();
+
+    static const char *eventName(Event event);
+};
+
+}
+
+#endif // QGSQ_QUERYTRACER_H
@@ -0,0 +1,519 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QThread>
+#include <QVector>
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QScopedPointer>
+
+#include <cstdio>
+#include <functional>
+
+#include <QGSQ/Valve/Source/serverquery.h>
+#include <QGSQ/Valve/Source/a2sprotocol.h>
+#include <QGSQ/Valve/Source/serverinfo.h>
+#include <QGSQ/Valve/Source/player.h>
+#include <QGSQ/queryengine.h>
+#include <QGSQ/querymetrics.h>
+#include <QGSQ/Valve/Source/stringpool.h>
+#include <QGSQ/Valve/Source/infofilter.h>
+#include <QGSQ/Valve/Source/playertracker.h>
+#include <QGSQ/datagramtransport.h>
+#include <QGSQ/loopbacktransport.h>
+#include <QGSQ/packetreplay.h>
+#ifdef Q_OS_LINUX
+#include <QGSQ/epolltransport.h>
+#endif
+// internal API of the static qgsq_internal library
+#include <QGSQ/Valve/Source/serverquery_p.h>
+#include <QGSQ/Valve/Source/splitpacket_p.h>
+#include <QGSQ/Valve/Source/response.h>
+
+#include "fakeserver.h"
+
+using namespace QGSQ::Valve::Source;
+
+namespace {
+
+// keeps the compiler from optimizing away benchmarked results
+volatile qint64 sink = 0;
+
+void runMicro(const char *name, int iterations, qint64 bytesPerIteration, const std::function<void()> &func)
+{
+    // warm up
+    for (int i = 0; i < qMin(iterations / 10 + 1, 1000); ++i) {
+        func();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    const qint64 nsecs = timer.nsecsElapsed();
+
+    const double nsPerOp = static_cast<double>(nsecs) / iterations;
+    const double mbPerSec = (bytesPerIteration > 0) ? (static_cast<double>(bytesPerIteration) * iterations / (static_cast<double>(nsecs) / 1e9) / (1024.0 * 1024.0)) : 0.0;
+    std::printf("%-40s %10d iterations %12.1f ns/op %10.1f MiB/s\n", name, iterations, nsPerOp, mbPerSec);
+}
+
+// payloads of all recorded replies of one query type, challenges are answered in the same conversation
+QList<QByteArray> loadReplies(QGSQ::PacketReplay &replay, A2SProtocol::Type type)
+{
+    QList<QByteArray> replies;
+    const A2SProtocol *protocol = A2SProtocol::instance();
+
+    for (;;) {
+        int conversation = -1;
+        QList<QGSQ::PacketReplay::Packet> packets = replay.replay(QHostAddress(QHostAddress::LocalHost), 0, protocol->buildRequest(type, QByteArray()), conversation);
+        if (conversation < 0) {
+            break;
+        }
+        while ((packets.size() == 1) && packets.constFirst().data.startsWith(QByteArrayLiteral("\xff\xff\xff\xff" "A"))) {
+            packets = replay.replay(QHostAddress(QHostAddress::LocalHost), 0, protocol->buildRequest(type, packets.constFirst().data.mid(5, 4)), conversation);
+        }
+
+        SplitPacketAssembler assembler;
+        for (const QGSQ::PacketReplay::Packet &packet : packets) {
+            if (packet.data.startsWith(QByteArrayLiteral("\xff\xff\xff\xff"))) {
+                replies.append(packet.data.mid(4));
+                break;
+            }
+            if (packet.data.startsWith(QByteArrayLiteral("\xfe\xff\xff\xff")) && (assembler.add(packet.data) == QGSQ::QueryReassembler::Complete)) {
+                replies.append(assembler.result());
+                break;
+            }
+        }
+    }
+
+    return replies;
+}
+
+qint64 totalSize(const QList<QByteArray> &files)
+{
+    qint64 size = 0;
+    for (const QByteArray &f : files) {
+        size += f.size();
+    }
+    return size;
+}
+
+void runMicroBenchmarks(const QString &capturePath, int iterations)
+{
+    QGSQ::PacketReplay replay;
+    if (!replay.load(capturePath)) {
+        std::fprintf(stderr, "Failed to load %s: %s\n\n", qUtf8Printable(capturePath), qUtf8Printable(replay.errorString()));
+        return;
+    }
+
+    // the replies are parsed independent of the recorded server addresses
+    replay.setServerFallback(true);
+
+    const QList<QByteArray> infos = loadReplies(replay, A2SProtocol::Info);
+    const QList<QByteArray> rules = loadReplies(replay, A2SProtocol::Rules);
+    const QList<QByteArray> players = loadReplies(replay, A2SProtocol::Players);
+
+    std::printf("Parsing microbenchmarks (%s: %i info, %i rules and %i players replies)\n", qUtf8Printable(capturePath), infos.size(), rules.size(), players.size());
+
+    // every iteration parses all recorded replies of a type
+    runMicro("ServerInfo::setRawData()", iterations, totalSize(infos), [&infos](){
+        for (const QByteArray &data : infos) {
+            ServerInfo si(QStringLiteral("127.0.0.1"), 27015);
+            sink = sink + si.setRawData(data);
+        }
+    });
+
+    StringPool pool;
+    runMicro("ServerInfo::setRawData() interned", iterations, totalSize(infos), [&infos, &pool](){
+        for (const QByteArray &data : infos) {
+            ServerInfo si(QStringLiteral("127.0.0.1"), 27015);
+            sink = sink + si.setRawData(data, &pool);
+        }
+    });
+
+    runMicro("ServerInfo::setRawData() lazy", iterations, totalSize(infos), [&infos](){
+        for (const QByteArray &data : infos) {
+            ServerInfo si(QStringLiteral("127.0.0.1"), 27015);
+            si.setLazyDecoding(true);
+            sink = sink + si.setRawData(data) + si.players();
+        }
+    });
+
+    const InfoFilter filter(QStringLiteral("appId == 730 && players > 0 && !private"));
+    runMicro("InfoFilter::matches()", iterations, totalSize(infos), [&infos, &filter](){
+        for (const QByteArray &data : infos) {
+            sink = sink + (filter.matches(data) ? 1 : 0);
+        }
+    });
+
+    ServerQueryPrivate sqp;
+
+    runMicro("ServerQueryPrivate::extractRules()", iterations, totalSize(rules), [&sqp, &rules](){
+        for (const QByteArray &data : rules) {
+            sink = sink + sqp.extractRules(data).size();
+        }
+    });
+
+    runMicro("ServerQueryPrivate::extractPlayers()", iterations, totalSize(players), [&sqp, &players](){
+        for (const QByteArray &data : players) {
+            const QList<Player*> lst = sqp.extractPlayers(data);
+            sink = sink + lst.size();
+            qDeleteAll(lst);
+        }
+    });
+
+    // all players are already known, so this measures the steady state matching
+    QVector<PlayerTracker*> trackers;
+    for (const QByteArray &data : players) {
+        auto tracker = new PlayerTracker;
+        tracker->update(data);
+        trackers.append(tracker);
+    }
+    runMicro("PlayerTracker::update()", iterations, totalSize(players), [&trackers, &players](){
+        for (int i = 0; i < trackers.size(); ++i) {
+            trackers.at(i)->update(players.at(i));
+            sink = sink + trackers.at(i)->players();
+        }
+    });
+    qDeleteAll(trackers);
+
+    runMicro("Response::getString() rules", iterations, totalSize(rules), [&rules](){
+        for (const QByteArray &rulesData : rules) {
+            QByteArray data = rulesData;
+            Response res(&data);
+            res.getCharacter();
+            res.get<quint16>();
+            while (!res.atEnd() && !res.hasError()) {
+                sink = sink + res.getString().size();
+            }
+        }
+    });
+
+    std::printf("\n");
+}
+
+QList<QByteArray> loadCorpus(const QString &dirPath)
+{
+    QList<QByteArray> files;
+    const QDir dir(dirPath);
+    const QStringList names = dir.entryList(QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        QFile f(dir.absoluteFilePath(name));
+        if (f.open(QIODevice::ReadOnly)) {
+            files.append(f.readAll());
+        }
+    }
+    return files;
+}
+
+void runCorpusBenchmarks(const QString &corpusPath, int iterations)
+{
+    std::printf("Corpus benchmarks (%s)\n", qUtf8Printable(corpusPath));
+
+    // the fuzzing corpus contains real and malformed replies, every iteration parses all files
+    const QList<QByteArray> infos = loadCorpus(corpusPath + QLatin1String("/serverinfo"));
+    const QList<QByteArray> rules = loadCorpus(corpusPath + QLatin1String("/rules"));
+    const QList<QByteArray> players = loadCorpus(corpusPath + QLatin1String("/players"));
+
+    const int corpusIterations = qMax(1, iterations / 10);
+
+    if (!infos.isEmpty()) {
+        runMicro("corpus serverinfo", corpusIterations, totalSize(infos), [&infos](){
+            for (const QByteArray &data : infos) {
+                ServerInfo si;
+                sink = sink + si.setRawData(data);
+            }
+        });
+    }
+
+    ServerQueryPrivate sqp;
+
+    if (!rules.isEmpty()) {
+        runMicro("corpus rules", corpusIterations, totalSize(rules), [&sqp, &rules](){
+            for (const QByteArray &data : rules) {
+                sink = sink + sqp.extractRules(data).size();
+            }
+        });
+    }
+
+    if (!players.isEmpty()) {
+        runMicro("corpus players", corpusIterations, totalSize(players), [&sqp, &players](){
+            for (const QByteArray &data : players) {
+                const QList<Player*> lst = sqp.extractPlayers(data);
+                sink = sink + lst.size();
+                qDeleteAll(lst);
+            }
+        });
+    }
+
+    std::printf("\n");
+}
+
+// answers like the fake server, but without any network involved
+void bindLoopbackServers(QGSQ::LoopbackTransportFactory *loopback, const QVector<quint16> &ports, int rules, int players)
+{
+    for (int i = 0; i < ports.size(); ++i) {
+        const QByteArray header = QByteArrayLiteral("\xff\xff\xff\xff");
+        const QByteArray info = header + FakeServer::infoPayload(i, ports.at(i), players);
+        const QByteArray rulesReply = header + FakeServer::rulesPayload(i, rules);
+        const QByteArray playersReply = header + FakeServer::playersPayload(i, players);
+        const QByteArray challengeReply = header + QByteArrayLiteral("A\x01\x02\x03\x04");
+        loopback->bind(QHostAddress(QHostAddress::LocalHost), ports.at(i), [=](const QByteArray &request, const QHostAddress &, quint16) {
+            QList<QByteArray> replies;
+            if (request.size() < 9) {
+                return replies;
+            }
+            const bool challengeRequest = request.endsWith(header);
+            switch (request.at(4)) {
+            case 'T':
+                replies.append(info);
+                break;
+            case 'V':
+                replies.append(challengeRequest ? challengeReply : rulesReply);
+                break;
+            case 'U':
+                replies.append(challengeRequest ? challengeReply : playersReply);
+                break;
+            default:
+                break;
+            }
+            return replies;
+        });
+    }
+}
+
+void runEndToEnd(const QVector<quint16> &ports, QGSQ::DatagramTransportFactory *factory, const QString &type, int concurrency, int queries, int timeout)
+{
+    QGSQ::QueryMetrics metrics;
+    // all servers are queried over the sockets of one engine, like in the scanner
+    QGSQ::QueryEngine engine;
+    engine.setMetrics(&metrics);
+    engine.setTransportFactory(factory);
+    QObject owner;
+    QVector<ServerQuery*> sqs;
+    sqs.reserve(ports.size());
+    for (quint16 port : ports) {
+        auto sq = new ServerQuery(QHostAddress(QHostAddress::LocalHost), port, &owner);
+        sq->setEngine(&engine);
+        sq->setTimeout(timeout);
+        sqs.append(sq);
+    }
+
+    int started = 0;
+    int finished = 0;
+    QEventLoop loop;
+
+    std::function<void(ServerQuery*)> query;
+    if (type == QLatin1String("rules")) {
+        query = [](ServerQuery *sq){sq->getRawRulesAsync();};
+    } else if (type == QLatin1String("players")) {
+        query = [](ServerQuery *sq){sq->getRawPlayersAsync();};
+    } else {
+        query = [](ServerQuery *sq){sq->getRawInfoAsync();};
+    }
+
+    auto startNext = [&](){
+        ServerQuery *sq = sqs.at(started % sqs.size());
+        ++started;
+        query(sq);
+    };
+
+    for (ServerQuery *sq : sqs) {
+        QObject::connect(sq, &ServerQuery::requestFinished, &loop, [&](){
+            ++finished;
+            if (started < queries) {
+                startNext();
+            } else if (finished == queries) {
+                loop.quit();
+            }
+        });
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int initial = qMin(concurrency, queries);
+    for (int i = 0; i < initial; ++i) {
+        startNext();
+    }
+    if (finished < queries) {
+        loop.exec();
+    }
+    const qint64 nsecs = timer.nsecsElapsed();
+
+    const auto metricsType = (type == QLatin1String("rules")) ? QGSQ::QueryMetrics::Rules : ((type == QLatin1String("players")) ? QGSQ::QueryMetrics::Players : QGSQ::QueryMetrics::Info);
+    std::printf("%-12i %12.0f %12lli %12lli %12lli %10llu\n",
+                concurrency,
+                static_cast<double>(queries) / (static_cast<double>(nsecs) / 1e9),
+                static_cast<long long>(metrics.latencyPercentile(metricsType, 50.0)),
+                static_cast<long long>(metrics.latencyPercentile(metricsType, 99.0)),
+                static_cast<long long>(metrics.latencyPercentile(metricsType, 100.0)),
+                static_cast<unsigned long long>(metrics.counter(QGSQ::QueryMetrics::RequestsFailed)));
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(QStringLiteral("Huessenbergnetz"));
+    QCoreApplication::setOrganizationDomain(QStringLiteral("huessenbergnetz.de"));
+    QCoreApplication::setApplicationName(QStringLiteral("qgsqbench"));
+    QCoreApplication::setApplicationVersion(QStringLiteral(VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks for libqgsq parsing and query throughput."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption iterations(QStringLiteral("iterations"), QStringLiteral("Iterations per microbenchmark. (Default: 100000)"), QStringLiteral("count"), QStringLiteral("100000"));
+    parser.addOption(iterations);
+
+    QCommandLineOption queries(QStringLiteral("queries"), QStringLiteral("Queries per concurrency level. (Default: 20000)"), QStringLiteral("count"), QStringLiteral("20000"));
+    parser.addOption(queries);
+
+    QCommandLineOption concurrency(QStringLiteral("concurrency"), QStringLiteral("Comma separated list of concurrency levels. (Default: 1,8,64,256)"), QStringLiteral("levels"), QStringLiteral("1,8,64,256"));
+    parser.addOption(concurrency);
+
+    QCommandLineOption type(QStringLiteral("type"), QStringLiteral("Query type for end to end benchmarks: info, rules or players. (Default: info)"), QStringLiteral("type"), QStringLiteral("info"));
+    parser.addOption(type);
+
+    QCommandLineOption endpoints(QStringLiteral("endpoints"), QStringLiteral("Number of simulated servers. (Default: 16)"), QStringLiteral("count"), QStringLiteral("16"));
+    parser.addOption(endpoints);
+
+    QCommandLineOption port(QStringLiteral("port"), QStringLiteral("First port of the simulated servers. (Default: 37015)"), QStringLiteral("port"), QStringLiteral("37015"));
+    parser.addOption(port);
+
+    QCommandLineOption rules(QStringLiteral("rules"), QStringLiteral("Number of rules per server. (Default: 40)"), QStringLiteral("count"), QStringLiteral("40"));
+    parser.addOption(rules);
+
+    QCommandLineOption players(QStringLiteral("players"), QStringLiteral("Number of players per server. (Default: 32)"), QStringLiteral("count"), QStringLiteral("32"));
+    parser.addOption(players);
+
+    QCommandLineOption timeout(QStringLiteral("timeout"), QStringLiteral("Query timeout in milliseconds. (Default: 2000)"), QStringLiteral("ms"), QStringLiteral("2000"));
+    parser.addOption(timeout);
+
+    QCommandLineOption transport(QStringLiteral("transport"), QStringLiteral("Transport of the end to end benchmarks: qt, epoll, recvmmsg or loopback. (Default: qt)"), QStringLiteral("transport"), QStringLiteral("qt"));
+    parser.addOption(transport);
+
+    QCommandLineOption capture(QStringLiteral("capture"), QStringLiteral("Capture file with the replies for the parsing microbenchmarks. (Default: %1)").arg(QStringLiteral(QGSQ_CAPTURE_FILE)), QStringLiteral("file"), QStringLiteral(QGSQ_CAPTURE_FILE));
+    parser.addOption(capture);
+
+    QCommandLineOption corpus(QStringLiteral("corpus"), QStringLiteral("Directory with the fuzzing corpus to parse. (Default: %1)").arg(QStringLiteral(QGSQ_CORPUS_DIR)), QStringLiteral("dir"), QStringLiteral(QGSQ_CORPUS_DIR));
+    parser.addOption(corpus);
+
+    QCommandLineOption microOnly(QStringLiteral("micro-only"), QStringLiteral("Only run the parsing microbenchmarks."));
+    parser.addOption(microOnly);
+
+    QCommandLineOption endToEndOnly(QStringLiteral("e2e-only"), QStringLiteral("Only run the end to end benchmarks."));
+    parser.addOption(endToEndOnly);
+
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules(QStringLiteral("qgsq.*.debug=false\nqgsq.*.info=false\nqgsq.*.warning=false"));
+
+    const int rulesCount = parser.value(rules).toInt();
+    const int playersCount = parser.value(players).toInt();
+
+    if (!parser.isSet(endToEndOnly)) {
+        runMicroBenchmarks(parser.value(capture), qMax(1, parser.value(iterations).toInt()));
+        runCorpusBenchmarks(parser.value(corpus), qMax(1, parser.value(iterations).toInt()));
+    }
+
+    if (parser.isSet(microOnly)) {
+        return 0;
+    }
+
+    FakeServer::Config config;
+    config.basePort = parser.value(port).toUShort();
+    config.endpoints = qMax(1, parser.value(endpoints).toInt());
+    config.rules = rulesCount;
+    config.players = playersCount;
+    config.seed = 1;
+
+    QVector<quint16> ports;
+    ports.reserve(config.endpoints);
+    for (int i = 0; i < config.endpoints; ++i) {
+        ports.append(static_cast<quint16>(config.basePort + i));
+    }
+
+    const QString transportName = parser.value(transport);
+    QScopedPointer<QGSQ::DatagramTransportFactory> factory;
+    if (transportName == QLatin1String("loopback")) {
+        auto loopback = new QGSQ::LoopbackTransportFactory;
+        bindLoopbackServers(loopback, ports, rulesCount, playersCount);
+        factory.reset(loopback);
+#ifdef Q_OS_LINUX
+    } else if (transportName == QLatin1String("epoll")) {
+        factory.reset(new QGSQ::EpollTransportFactory);
+    } else if (transportName == QLatin1String("recvmmsg")) {
+        factory.reset(new QGSQ::RecvMmsgTransportFactory);
+#endif
+    } else if (transportName != QLatin1String("qt")) {
+        std::fprintf(stderr, "Unsupported transport: %s\n", qUtf8Printable(transportName));
+        return 1;
+    }
+
+    // the responder gets its own thread, so that it does not compete with the client's event loop
+    QThread serverThread;
+    FakeServer *server = nullptr;
+    if (transportName != QLatin1String("loopback")) {
+        server = new FakeServer(config);
+        server->moveToThread(&serverThread);
+        QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+        serverThread.start();
+
+        bool started = false;
+        QMetaObject::invokeMethod(server, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, started));
+        if (!started) {
+            serverThread.quit();
+            serverThread.wait();
+            return 2;
+        }
+    }
+
+    const QString queryType = parser.value(type);
+    const int queriesCount = qMax(1, parser.value(queries).toInt());
+    std::printf("End to end %s queries against %i local servers over %s transport, %i queries per level\n", qUtf8Printable(queryType), config.endpoints, qUtf8Printable(transportName), queriesCount);
+    std::printf("%-12s %12s %12s %12s %12s %10s\n", "concurrency", "queries/s", "p50 us", "p99 us", "max us", "failed");
+
+    const QStringList levels = parser.value(concurrency).split(QLatin1Char(','), QString::SkipEmptyParts);
+    for (const QString &level : levels) {
+        const int c = level.toInt();
+        if (c > 0) {
+            runEndToEnd(ports, factory.data(), queryType, c, queriesCount, parser.value(timeout).toInt());
+        }
+    }
+
+    if (server) {
+        QMetaObject::invokeMethod(server, "stop", Qt::BlockingQueuedConnection);
+        serverThread.quit();
+        serverThread.wait();
+    }
+
+    return 0;
+}
@@ -0,0 +1,368 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "fakeserver.h"
+#include <QUdpSocket>
+#include <QNetworkDatagram>
+#include <QTimer>
+#include <QtEndian>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cstring>
+#ifdef QGSQ_WITH_BZIP2
+#include <bzlib.h>
+#endif
+
+Q_LOGGING_CATEGORY(QGSQFS, "qgsq.fakeserver")
+
+namespace {
+
+template<typename T> void appendLE(QByteArray &ba, T value)
+{
+    uchar buf[sizeof(T)];
+    qToLittleEndian<T>(value, buf);
+    ba.append(reinterpret_cast<const char*>(buf), sizeof(T));
+}
+
+void appendFloat(QByteArray &ba, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLE<quint32>(ba, bits);
+}
+
+void appendString(QByteArray &ba, const QByteArray &str)
+{
+    ba.append(str);
+    ba.append('\0');
+}
+
+#ifdef QGSQ_WITH_BZIP2
+quint32 crc32(const QByteArray &data)
+{
+    quint32 crc = 0xffffffffU;
+    for (const char c : data) {
+        crc ^= static_cast<uchar>(c);
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0xedb88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+// decompressed size and checksum followed by the bzip2 stream, empty on failure
+QByteArray compress(const QByteArray &data)
+{
+    // bzip2 output is at most 1% plus 600 bytes larger than the input
+    unsigned int size = static_cast<unsigned int>(data.size() + data.size() / 100 + 600);
+    QByteArray compressed(8 + static_cast<int>(size), Qt::Uninitialized);
+    // the source is not modified, the API only lacks the const
+    if (BZ2_bzBuffToBuffCompress(compressed.data() + 8, &size, const_cast<char*>(data.constData()), static_cast<unsigned int>(data.size()), 9, 0, 0) != BZ_OK) {
+        return QByteArray();
+    }
+    compressed.resize(8 + static_cast<int>(size));
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), reinterpret_cast<uchar*>(compressed.data()));
+    qToLittleEndian<quint32>(crc32(data), reinterpret_cast<uchar*>(compressed.data() + 4));
+    return compressed;
+}
+#endif
+
+}
+
+FakeServer::FakeServer(const Config &config, QObject *parent) :
+    QObject(parent), m_config(config)
+{
+    if (m_config.seed == 0) {
+        std::random_device rd;
+        m_random.seed(rd());
+    } else {
+        m_random.seed(m_config.seed);
+    }
+    m_secret = static_cast<quint32>(m_random());
+}
+
+FakeServer::~FakeServer()
+{
+    stop();
+}
+
+bool FakeServer::start()
+{
+    if (!m_sockets.isEmpty()) {
+        return true;
+    }
+
+    if (m_config.endpoints < 1 || (static_cast<int>(m_config.basePort) + m_config.endpoints - 1) > 65535) {
+        qCCritical(QGSQFS, "Invalid port range starting at %u with %i endpoints.", m_config.basePort, m_config.endpoints);
+        return false;
+    }
+
+    if (m_config.maxPacketSize < 64) {
+        qCCritical(QGSQFS, "Maximum packet size of %i bytes is too small.", m_config.maxPacketSize);
+        return false;
+    }
+
+    m_sockets.reserve(m_config.endpoints);
+    for (int i = 0; i < m_config.endpoints; ++i) {
+        auto socket = new QUdpSocket(this);
+        const quint16 p = static_cast<quint16>(m_config.basePort + i);
+        if (!socket->bind(m_config.address, p)) {
+            qCCritical(QGSQFS, "Failed to bind to %s:%u: %s", qUtf8Printable(m_config.address.toString()), p, qUtf8Printable(socket->errorString()));
+            delete socket;
+            stop();
+            return false;
+        }
+        connect(socket, &QUdpSocket::readyRead, this, [this, i](){onReadyRead(i);});
+        m_sockets.append(socket);
+    }
+
+    qCInfo(QGSQFS, "Listening on %s:%u-%u.", qUtf8Printable(m_config.address.toString()), m_config.basePort, static_cast<quint16>(m_config.basePort + m_config.endpoints - 1));
+
+    return true;
+}
+
+void FakeServer::stop()
+{
+    qDeleteAll(m_sockets);
+    m_sockets.clear();
+}
+
+int FakeServer::endpoints() const
+{
+    return m_sockets.size();
+}
+
+quint16 FakeServer::port(int endpoint) const
+{
+    return static_cast<quint16>(m_config.basePort + endpoint);
+}
+
+quint64 FakeServer::requestsHandled() const
+{
+    return m_requests;
+}
+
+QByteArray FakeServer::infoPayload(int endpoint, quint16 gamePort, int players)
+{
+    QByteArray ba;
+    ba.reserve(256);
+    ba.append('I');
+    ba.append(static_cast<char>(17));
+    appendString(ba, "QGSQ Fake Server #" + QByteArray::number(endpoint));
+    appendString(ba, QByteArrayLiteral("de_dust2"));
+    appendString(ba, QByteArrayLiteral("csgo"));
+    appendString(ba, QByteArrayLiteral("Counter-Strike: Global Offensive"));
+    appendLE<quint16>(ba, 730);
+    ba.append(static_cast<char>(qBound(0, players, 255)));
+    ba.append(static_cast<char>(qBound(64, players, 255)));
+    ba.append(static_cast<char>(0)); // bots
+    ba.append('d');
+    ba.append('l');
+    ba.append(static_cast<char>(0)); // visibility
+    ba.append(static_cast<char>(1)); // vac
+    appendString(ba, QByteArrayLiteral("1.38.7.9"));
+    ba.append(static_cast<char>(0xB1)); // extra data flag: port, steam id, keywords, game id
+    appendLE<quint16>(ba, gamePort);
+    appendLE<quint64>(ba, Q_UINT64_C(90000000000000000) + static_cast<quint64>(endpoint));
+    appendString(ba, QByteArrayLiteral("empty,secure,fake"));
+    appendLE<quint64>(ba, 730);
+    return ba;
+}
+
+QByteArray FakeServer::rulesPayload(int endpoint, int rules)
+{
+    const int count = qBound(0, rules, 65535);
+    QByteArray ba;
+    ba.reserve(5 + count * 32);
+    ba.append('E');
+    appendLE<quint16>(ba, static_cast<quint16>(count));
+    for (int i = 0; i < count; ++i) {
+        appendString(ba, "qgsq_fake_rule_" + QByteArray::number(i));
+        appendString(ba, QByteArray::number(endpoint * 1000 + i));
+    }
+    return ba;
+}
+
+QByteArray FakeServer::playersPayload(int endpoint, int players)
+{
+    const int count = qBound(0, players, 255);
+    QByteArray ba;
+    ba.reserve(2 + count * 32);
+    ba.append('D');
+    ba.append(static_cast<char>(count));
+    for (int i = 0; i < count; ++i) {
+        ba.append(static_cast<char>(0));
+        appendString(ba, "Player " + QByteArray::number(i) + " on #" + QByteArray::number(endpoint));
+        appendLE<qint32>(ba, (i * 7) % 50);
+        appendFloat(ba, 60.5f * static_cast<float>(i + 1));
+    }
+    return ba;
+}
+
+void FakeServer::onReadyRead(int endpoint)
+{
+    QUdpSocket *socket = m_sockets.at(endpoint);
+    while (socket->hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = socket->receiveDatagram();
+        handleRequest(endpoint, datagram.data(), datagram.senderAddress(), static_cast<quint16>(datagram.senderPort()));
+    }
+}
+
+void FakeServer::handleRequest(int endpoint, const QByteArray &request, const QHostAddress &sender, quint16 senderPort)
+{
+    if (request.size() < 5 || !request.startsWith(QByteArrayLiteral("\xff\xff\xff\xff"))) {
+        qCDebug(QGSQFS, "Ignoring invalid request from %s:%u.", qUtf8Printable(sender.toString()), senderPort);
+        return;
+    }
+
+    ++m_requests;
+
+    const quint32 expected = challenge(sender, senderPort);
+    QByteArray challengeReply(1, 'A');
+    appendLE<quint32>(challengeReply, expected);
+
+    const char header = request.at(4);
+    switch (header) {
+    case 'T':
+    {
+        static const QByteArray query = QByteArrayLiteral("TSource Engine Query\0");
+        if (request.mid(4, query.size()) != query) {
+            return;
+        }
+        if (m_config.infoChallenge) {
+            const int offset = 4 + query.size();
+            if ((request.size() < offset + 4) || (qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(request.constData() + offset)) != expected)) {
+                reply(endpoint, challengeReply, sender, senderPort);
+                return;
+            }
+        }
+        reply(endpoint, infoPayload(endpoint, port(endpoint), m_config.players), sender, senderPort);
+        break;
+    }
+    case 'V':
+    case 'U':
+    {
+        if ((request.size() < 9) || (qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(request.constData() + 5)) != expected)) {
+            reply(endpoint, challengeReply, sender, senderPort);
+            return;
+        }
+        if (header == 'V') {
+            reply(endpoint, rulesPayload(endpoint, m_config.rules), sender, senderPort);
+        } else {
+            reply(endpoint, playersPayload(endpoint, m_config.players), sender, senderPort);
+        }
+        break;
+    }
+    case 'W':
+        reply(endpoint, challengeReply, sender, senderPort);
+        break;
+    default:
+        qCDebug(QGSQFS, "Ignoring unknown request type '%c'.", header);
+        break;
+    }
+}
+
+void FakeServer::reply(int endpoint, const QByteArray &payload, const QHostAddress &receiver, quint16 receiverPort)
+{
+    QByteArray response = QByteArrayLiteral("\xff\xff\xff\xff");
+    response.append(payload);
+
+    if (response.size() <= m_config.maxPacketSize) {
+        send(endpoint, response, receiver, receiverPort);
+        return;
+    }
+
+    // Source engine split packets: header, id, total, number, maximum packet size
+    const int headerSize = 12;
+    const int chunkSize = m_config.maxPacketSize - headerSize;
+
+    quint32 id = (++m_splitId) & 0x7fffffffU;
+#ifdef QGSQ_WITH_BZIP2
+    if (m_config.compressSplit) {
+        // the size and checksum are part of the first packet
+        response = compress(response);
+        if (response.isEmpty()) {
+            qCWarning(QGSQFS, "Failed to compress response of %i bytes.", payload.size() + 4);
+            return;
+        }
+        id |= 0x80000000U;
+    }
+#endif
+
+    const int total = (response.size() + chunkSize - 1) / chunkSize;
+    if (total > 255) {
+        qCWarning(QGSQFS, "Response of %i bytes needs more than 255 split packets.", response.size());
+        return;
+    }
+
+    QVector<QByteArray> packets;
+    packets.reserve(total);
+    for (int i = 0; i < total; ++i) {
+        QByteArray packet = QByteArrayLiteral("\xfe\xff\xff\xff");
+        appendLE<quint32>(packet, id);
+        packet.append(static_cast<char>(total));
+        packet.append(static_cast<char>(i));
+        appendLE<quint16>(packet, static_cast<quint16>(m_config.maxPacketSize));
+        packet.append(response.mid(i * chunkSize, chunkSize));
+        packets.append(packet);
+    }
+
+    if (m_config.reorder) {
+        std::shuffle(packets.begin(), packets.end(), m_random);
+    }
+
+    for (const QByteArray &packet : packets) {
+        send(endpoint, packet, receiver, receiverPort);
+    }
+}
+
+void FakeServer::send(int endpoint, const QByteArray &datagram, const QHostAddress &receiver, quint16 receiverPort)
+{
+    if (m_config.loss > 0.0) {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        if (dist(m_random) < m_config.loss) {
+            return;
+        }
+    }
+
+    int delay = m_config.delay;
+    if (m_config.jitter > 0) {
+        std::uniform_int_distribution<int> dist(0, m_config.jitter);
+        delay += dist(m_random);
+    }
+
+    QUdpSocket *socket = m_sockets.at(endpoint);
+    if (delay <= 0) {
+        socket->writeDatagram(datagram, receiver, receiverPort);
+    } else {
+        QTimer::singleShot(delay, socket, [socket, datagram, receiver, receiverPort](){
+            socket->writeDatagram(datagram, receiver, receiverPort);
+        });
+    }
+}
+
+quint32 FakeServer::challenge(const QHostAddress &sender, quint16 senderPort) const
+{
+    quint32 c = qHash(sender) ^ ((static_cast<quint32>(senderPort) << 16) | senderPort) ^ m_secret;
+    if (c == 0xffffffffU) {
+        c = 0;
+    }
+    return c;
+}
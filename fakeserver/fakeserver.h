@@ -0,0 +1,92 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQ_FAKESERVER_H
+#define QGSQ_FAKESERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QVector>
+#include <random>
+
+class QUdpSocket;
+
+/*
+ * Local A2S responder for testing and benchmarking without real game
+ * servers. It listens on a range of consecutive ports, one simulated
+ * server per port, and answers A2S_INFO, A2S_RULES and A2S_PLAYER requests
+ * including challenges. Responses larger than the maximum packet size are
+ * sent as Source engine split packets, bzip2 compressed if compressSplit is
+ * set and bzip2 support is built in. Packet loss, delay, jitter and
+ * reordering can be injected.
+ */
+class FakeServer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Config {
+        QHostAddress address = QHostAddress(QHostAddress::LocalHost);
+        quint16 basePort = 27015;
+        int endpoints = 1;
+        int rules = 20;
+        int players = 16;
+        int maxPacketSize = 1400;
+        int delay = 0;
+        int jitter = 0;
+        double loss = 0.0;
+        quint32 seed = 0;
+        bool infoChallenge = false;
+        bool compressSplit = false;
+        bool reorder = false;
+    };
+
+    explicit FakeServer(const Config &config, QObject *parent = nullptr);
+
+    ~FakeServer();
+
+    Q_INVOKABLE bool start();
+    Q_INVOKABLE void stop();
+
+    int endpoints() const;
+    quint16 port(int endpoint) const;
+    quint64 requestsHandled() const;
+
+    static QByteArray infoPayload(int endpoint, quint16 gamePort, int players);
+    static QByteArray rulesPayload(int endpoint, int rules);
+    static QByteArray playersPayload(int endpoint, int players);
+
+private:
+    void onReadyRead(int endpoint);
+    void handleRequest(int endpoint, const QByteArray &request, const QHostAddress &sender, quint16 senderPort);
+    void reply(int endpoint, const QByteArray &payload, const QHostAddress &receiver, quint16 receiverPort);
+    void send(int endpoint, const QByteArray &datagram, const QHostAddress &receiver, quint16 receiverPort);
+    quint32 challenge(const QHostAddress &sender, quint16 senderPort) const;
+
+    QVector<QUdpSocket*> m_sockets;
+    Config m_config;
+    std::mt19937 m_random;
+    quint64 m_requests = 0;
+    quint32 m_secret = 0;
+    quint32 m_splitId = 0;
+
+    Q_DISABLE_COPY(FakeServer)
+};
+
+#endif // QGSQ_FAKESERVER_H
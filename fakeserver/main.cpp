@@ -0,0 +1,122 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QLoggingCategory>
+
+#include <iostream>
+
+#include "fakeserver.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(QStringLiteral("Huessenbergnetz"));
+    QCoreApplication::setOrganizationDomain(QStringLiteral("huessenbergnetz.de"));
+    QCoreApplication::setApplicationName(QStringLiteral("qgsqfakeserver"));
+    QCoreApplication::setApplicationVersion(QStringLiteral(VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Local A2S server for testing and benchmarking."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption address(QStringList({QStringLiteral("a"), QStringLiteral("address")}), QStringLiteral("Address to listen on. (Default: 127.0.0.1)"), QStringLiteral("address"), QStringLiteral("127.0.0.1"));
+    parser.addOption(address);
+
+    QCommandLineOption port(QStringList({QStringLiteral("p"), QStringLiteral("port")}), QStringLiteral("First port to listen on. (Default: 27015)"), QStringLiteral("port"), QStringLiteral("27015"));
+    parser.addOption(port);
+
+    QCommandLineOption endpoints(QStringList({QStringLiteral("n"), QStringLiteral("endpoints")}), QStringLiteral("Number of simulated servers on consecutive ports. (Default: 1)"), QStringLiteral("count"), QStringLiteral("1"));
+    parser.addOption(endpoints);
+
+    QCommandLineOption rules(QStringLiteral("rules"), QStringLiteral("Number of rules per server. (Default: 20)"), QStringLiteral("count"), QStringLiteral("20"));
+    parser.addOption(rules);
+
+    QCommandLineOption players(QStringLiteral("players"), QStringLiteral("Number of players per server. (Default: 16)"), QStringLiteral("count"), QStringLiteral("16"));
+    parser.addOption(players);
+
+    QCommandLineOption maxPacketSize(QStringLiteral("max-packet-size"), QStringLiteral("Maximum datagram size, larger responses are split. (Default: 1400)"), QStringLiteral("bytes"), QStringLiteral("1400"));
+    parser.addOption(maxPacketSize);
+
+    QCommandLineOption infoChallenge(QStringLiteral("info-challenge"), QStringLiteral("Require a challenge for A2S_INFO requests."));
+    parser.addOption(infoChallenge);
+
+#ifdef QGSQ_WITH_BZIP2
+    QCommandLineOption compressSplit(QStringLiteral("compressed"), QStringLiteral("Compress split responses with bzip2."));
+    parser.addOption(compressSplit);
+#endif
+
+    QCommandLineOption loss(QStringLiteral("loss"), QStringLiteral("Probability between 0 and 1 to drop a datagram. (Default: 0)"), QStringLiteral("probability"), QStringLiteral("0"));
+    parser.addOption(loss);
+
+    QCommandLineOption delay(QStringLiteral("delay"), QStringLiteral("Delay of every datagram in milliseconds. (Default: 0)"), QStringLiteral("ms"), QStringLiteral("0"));
+    parser.addOption(delay);
+
+    QCommandLineOption jitter(QStringLiteral("jitter"), QStringLiteral("Maximum random additional delay in milliseconds. (Default: 0)"), QStringLiteral("ms"), QStringLiteral("0"));
+    parser.addOption(jitter);
+
+    QCommandLineOption reorder(QStringLiteral("reorder"), QStringLiteral("Send split packets in random order."));
+    parser.addOption(reorder);
+
+    QCommandLineOption seed(QStringLiteral("seed"), QStringLiteral("Seed for the random generator, 0 for a random seed. (Default: 0)"), QStringLiteral("seed"), QStringLiteral("0"));
+    parser.addOption(seed);
+
+    QCommandLineOption enableDebug(QStringLiteral("debug"), QStringLiteral("Enable debug output."));
+    parser.addOption(enableDebug);
+
+    parser.process(app);
+
+    if (parser.isSet(enableDebug)) {
+        QLoggingCategory::setFilterRules(QStringLiteral("qgsq.*.debug=true"));
+    } else {
+        QLoggingCategory::setFilterRules(QStringLiteral("qgsq.*.debug=false"));
+    }
+
+    FakeServer::Config config;
+    config.address = QHostAddress(parser.value(address));
+    if (config.address.isNull()) {
+        std::cerr << "Invalid address: " << qPrintable(parser.value(address)) << std::endl;
+        return 1;
+    }
+    config.basePort = parser.value(port).toUShort();
+    config.endpoints = parser.value(endpoints).toInt();
+    config.rules = parser.value(rules).toInt();
+    config.players = parser.value(players).toInt();
+    config.maxPacketSize = parser.value(maxPacketSize).toInt();
+    config.infoChallenge = parser.isSet(infoChallenge);
+#ifdef QGSQ_WITH_BZIP2
+    config.compressSplit = parser.isSet(compressSplit);
+#endif
+    config.loss = parser.value(loss).toDouble();
+    config.delay = parser.value(delay).toInt();
+    config.jitter = parser.value(jitter).toInt();
+    config.reorder = parser.isSet(reorder);
+    config.seed = parser.value(seed).toUInt();
+
+    FakeServer server(config);
+    if (!server.start()) {
+        return 2;
+    }
+
+    return app.exec();
+}
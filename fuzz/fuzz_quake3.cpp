@@ -0,0 +1,48 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "fuzzcommon.h"
+#include <QGSQ/Quake3/quake3protocol.h>
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    qgsqFuzzInit();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > QGSQ_FUZZ_MAX_INPUT) {
+        return 0;
+    }
+    const QGSQ::Quake3::Quake3Protocol *protocol = QGSQ::Quake3::Quake3Protocol::instance();
+    const QByteArray input = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size));
+    QByteArray payload;
+    if (protocol->unpack(input, &payload) == QGSQ::QueryProtocol::SinglePacket) {
+        QByteArray challenge;
+        for (int type : {QGSQ::Quake3::Quake3Protocol::GetStatus, QGSQ::Quake3::Quake3Protocol::GetInfo}) {
+            if (protocol->matchReply(type, payload, &challenge) == QGSQ::QueryProtocol::ExpectedReply) {
+                protocol->parse(type, payload);
+            }
+        }
+    }
+    return 0;
+}
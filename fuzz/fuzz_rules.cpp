@@ -0,0 +1,37 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "fuzzcommon.h"
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    qgsqFuzzInit();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > QGSQ_FUZZ_MAX_INPUT) {
+        return 0;
+    }
+    QGSQ::Valve::Source::ServerQueryPrivate::extractRules(QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size)));
+    return 0;
+}
@@ -0,0 +1,43 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QGSQ_FUZZCOMMON_H
+#define QGSQ_FUZZCOMMON_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+#include <cstdint>
+#include <cstddef>
+
+#include <QGSQ/Valve/Source/serverinfo.h>
+#include <QGSQ/Valve/Source/player.h>
+// internal API of the static qgsq_internal library
+#include <QGSQ/Valve/Source/serverquery_p.h>
+
+// a single datagram can not be bigger, reassembled responses rarely are
+#define QGSQ_FUZZ_MAX_INPUT 65536
+
+inline void qgsqFuzzInit()
+{
+    // logging every malformed input would slow down fuzzing considerably
+    qputenv("QT_LOGGING_RULES", QByteArrayLiteral("qgsq.*=false"));
+}
+
+#endif // QGSQ_FUZZCOMMON_H
@@ -23,12 +23,19 @@
 #include <QLoggingCategory>
 #include <QJsonDocument>
 #include <QEventLoop>
+#include <QFile>
 
 #include <iostream>
+#include <cstdio>
 
 #include <QGSQ/Valve/Source/serverquery.h>
 #include <QGSQ/Valve/Source/serverinfo.h>
 #include <QGSQ/Valve/Source/player.h>
+#include <QGSQ/packetcapture.h>
+#include <QGSQ/packetreplay.h>
+#include <QGSQ/Valve/Source/infofilter.h>
+
+#include "scanner.h"
 
 int main(int argc, char *argv[])
 {
@@ -66,6 +73,42 @@ int main(int argc, char *argv[])
     QCommandLineOption getPlayersAsync(QStringLiteral("get-players-async"), QStringLiteral("Get players currently on the server asnychronous."));
     parser.addOption(getPlayersAsync);
 
+    QCommandLineOption scan(QStringLiteral("scan"), QStringLiteral("Scan all endpoints listed in file, one per line, - reads from stdin."), QStringLiteral("file"));
+    parser.addOption(scan);
+
+    QCommandLineOption inFlight(QStringLiteral("in-flight"), QStringLiteral("Maximum number of servers queried at the same time while scanning. (Default: 256)"), QStringLiteral("count"), QStringLiteral("256"));
+    parser.addOption(inFlight);
+
+    QCommandLineOption rate(QStringLiteral("rate"), QStringLiteral("Maximum number of servers started per second while scanning, 0 for no limit. (Default: 0)"), QStringLiteral("servers"), QStringLiteral("0"));
+    parser.addOption(rate);
+
+    QCommandLineOption timeout(QStringLiteral("timeout"), QStringLiteral("Query timeout in milliseconds while scanning. (Default: 2000)"), QStringLiteral("ms"), QStringLiteral("2000"));
+    parser.addOption(timeout);
+
+    QCommandLineOption format(QStringLiteral("format"), QStringLiteral("Output format of the scan results: ndjson, cbor, msgpack or snapshot. (Default: ndjson)"), QStringLiteral("format"), QStringLiteral("ndjson"));
+    parser.addOption(format);
+
+    QCommandLineOption withRules(QStringLiteral("with-rules"), QStringLiteral("Also query the rules of every scanned server."));
+    parser.addOption(withRules);
+
+    QCommandLineOption withPlayers(QStringLiteral("with-players"), QStringLiteral("Also query the players of every scanned server."));
+    parser.addOption(withPlayers);
+
+    QCommandLineOption capture(QStringLiteral("capture"), QStringLiteral("Record all sent and received datagrams to a pcap file."), QStringLiteral("file"));
+    parser.addOption(capture);
+
+    QCommandLineOption replay(QStringLiteral("replay"), QStringLiteral("Answer queries with the traffic recorded in a pcap file instead of using the network."), QStringLiteral("file"));
+    parser.addOption(replay);
+
+    QCommandLineOption replaySpeed(QStringLiteral("replay-speed"), QStringLiteral("Speed factor for replayed traffic, 0 replays without delays. (Default: 1)"), QStringLiteral("factor"), QStringLiteral("1"));
+    parser.addOption(replaySpeed);
+
+    QCommandLineOption replayAnyServer(QStringLiteral("replay-any-server"), QStringLiteral("Answer queries to servers that are not part of the replayed capture with the traffic of other servers."));
+    parser.addOption(replayAnyServer);
+
+    QCommandLineOption filter(QStringLiteral("filter"), QStringLiteral("Only keep servers matching the filter, either an expression like \"appId == 730 && players > 0\" or a master server filter like \"\\appid\\730\\empty\\1\"."), QStringLiteral("filter"));
+    parser.addOption(filter);
+
     QCommandLineOption enableDebug(QStringLiteral("debug"), QStringLiteral("Enable debug output."));
     parser.addOption(enableDebug);
 
@@ -77,10 +120,117 @@ int main(int argc, char *argv[])
         QLoggingCategory::setFilterRules(QStringLiteral("qgsq.*.debug=false"));
     }
 
+    QGSQ::PacketCapture packetCapture;
+    if (parser.isSet(capture) && !packetCapture.open(parser.value(capture))) {
+        std::cerr << "Failed to open " << qPrintable(parser.value(capture)) << ": " << qPrintable(packetCapture.errorString()) << std::endl;
+        return 1;
+    }
+
+    QGSQ::PacketReplay packetReplay;
+    if (parser.isSet(replay)) {
+        if (!packetReplay.load(parser.value(replay))) {
+            std::cerr << "Failed to load " << qPrintable(parser.value(replay)) << ": " << qPrintable(packetReplay.errorString()) << std::endl;
+            return 1;
+        }
+        packetReplay.setSpeed(parser.value(replaySpeed).toDouble());
+        packetReplay.setServerFallback(parser.isSet(replayAnyServer));
+    }
+
+    QGSQ::Valve::Source::InfoFilter infoFilter;
+    if (parser.isSet(filter)) {
+        const QString filterString = parser.value(filter);
+        const bool ok = filterString.startsWith(QLatin1Char('\\')) ? infoFilter.setMasterFilter(filterString) : infoFilter.setExpression(filterString);
+        if (!ok) {
+            std::cerr << "Invalid filter: " << qPrintable(infoFilter.errorString()) << std::endl;
+            return 1;
+        }
+    }
+
+    auto setupQuery = [&](QGSQ::Valve::Source::ServerQuery &sq) {
+        if (packetCapture.isOpen()) {
+            sq.setCapture(&packetCapture);
+        }
+        if (parser.isSet(replay)) {
+            sq.setReplay(&packetReplay);
+        }
+        if (!infoFilter.isEmpty()) {
+            sq.setInfoFilter(&infoFilter);
+        }
+    };
+
+    if (parser.isSet(scan)) {
+        Scanner::Options options;
+        const QString formatName = parser.value(format);
+        if (formatName == QLatin1String("ndjson")) {
+            options.format = Scanner::NDJson;
+        } else if (formatName == QLatin1String("cbor")) {
+            options.format = Scanner::Cbor;
+        } else if (formatName == QLatin1String("msgpack")) {
+            options.format = Scanner::MsgPack;
+        } else if (formatName == QLatin1String("snapshot")) {
+            options.format = Scanner::Snapshot;
+        } else {
+            std::cerr << "Invalid output format: " << qPrintable(formatName) << std::endl;
+            return 1;
+        }
+        options.inFlight = parser.value(inFlight).toInt();
+        options.rate = parser.value(rate).toInt();
+        options.timeout = parser.value(timeout).toInt();
+        options.defaultPort = parser.value(port).toUShort();
+        options.rules = parser.isSet(withRules);
+        options.players = parser.isSet(withPlayers);
+        if (packetCapture.isOpen()) {
+            options.capture = &packetCapture;
+        }
+        if (parser.isSet(replay)) {
+            options.replay = &packetReplay;
+        }
+        if (!infoFilter.isEmpty()) {
+            options.filter = &infoFilter;
+        }
+
+        QFile input;
+        const QString inputName = parser.value(scan);
+        bool inputOpened = false;
+        if (inputName == QLatin1String("-")) {
+            inputOpened = input.open(stdin, QIODevice::ReadOnly|QIODevice::Text);
+        } else {
+            input.setFileName(inputName);
+            inputOpened = input.open(QIODevice::ReadOnly|QIODevice::Text);
+        }
+        if (!inputOpened) {
+            std::cerr << "Failed to open " << qPrintable(inputName) << ": " << qPrintable(input.errorString()) << std::endl;
+            return 1;
+        }
+
+        QFile output;
+        if (!output.open(stdout, QIODevice::WriteOnly)) {
+            std::cerr << "Failed to open stdout: " << qPrintable(output.errorString()) << std::endl;
+            return 1;
+        }
+
+        // keep log messages out of the result stream
+        if (!parser.isSet(enableDebug)) {
+            QLoggingCategory::setFilterRules(QStringLiteral("qgsq.*.debug=false\nqgsq.*.info=false\nqgsq.*.warning=false\nqgsq.*.critical=false"));
+        }
+
+        Scanner scanner(options, &input, &output);
+        QObject::connect(&scanner, &Scanner::finished, &app, &QCoreApplication::quit);
+        if (!scanner.start()) {
+            return 2;
+        }
+        app.exec();
+        output.flush();
+        scanner.printSummary();
+
+        return 0;
+    }
+
     if (parser.isSet(server)) {
 
         if (parser.isSet(getInfo)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
             QScopedPointer<QGSQ::Valve::Source::ServerInfo> si(sq.getInfo());
 
             std::cout << "ServerInfo:\n" << si.data();
@@ -88,35 +238,53 @@ int main(int argc, char *argv[])
 
         if (parser.isSet(getInfoAsync)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
             QEventLoop loop;
-            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotInfo, &loop, &QEventLoop::quit);
+            bool finished = false;
+            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::requestFinished, &loop, [&loop, &finished](){
+                finished = true;
+                loop.quit();
+            });
             QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotInfo, &sq, [](QGSQ::Valve::Source::ServerInfo *si) {
                 std::cout << "ServerInfo:\n" << si;
                 delete si;
             });
             sq.getInfoAsync();
-            loop.exec();
+            // the request might already have finished while it was started
+            if (!finished) {
+                loop.exec();
+            }
         }
 
         if (parser.isSet(getRules)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
 
             qDebug() << sq.getRules();
         }
 
         if (parser.isSet(getRulesAsync)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
             QEventLoop loop;
-            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotRules, &loop, &QEventLoop::quit);
+            bool finished = false;
+            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::requestFinished, &loop, [&loop, &finished](){
+                finished = true;
+                loop.quit();
+            });
             QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotRules, &sq, [](const QHash<QString,QString> &rules){
                 qDebug() << rules;
             });
             sq.getRulesAsync();
-            loop.exec();
+            // the request might already have finished while it was started
+            if (!finished) {
+                loop.exec();
+            }
         }
 
         if (parser.isSet(getPlayers)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
 
             QObject o;
             qDebug() << sq.getPlayers(&o);
@@ -124,8 +292,13 @@ int main(int argc, char *argv[])
 
         if (parser.isSet(getPlayersAsync)) {
             QGSQ::Valve::Source::ServerQuery sq(parser.value(server), parser.value(port).toUShort());
+            setupQuery(sq);
             QEventLoop loop;
-            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotPlayers, &loop, &QEventLoop::quit);
+            bool finished = false;
+            QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::requestFinished, &loop, [&loop, &finished](){
+                finished = true;
+                loop.quit();
+            });
             QObject::connect(&sq, &QGSQ::Valve::Source::ServerQuery::gotPlayers, &sq, [](const QList<QGSQ::Valve::Source::Player*> &players){
                 if (!players.empty()) {
                     for (QGSQ::Valve::Source::Player *p : players) {
@@ -135,7 +308,10 @@ int main(int argc, char *argv[])
                 }
             });
             sq.getPlayersAsync();
-            loop.exec();
+            // the request might already have finished while it was started
+            if (!finished) {
+                loop.exec();
+            }
         }
 
     } else {
@@ -0,0 +1,302 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "scanner.h"
+
+#include <QTimer>
+#include <QHostAddress>
+#include <QIODevice>
+
+#include <iostream>
+#include <cstdio>
+
+#include <QGSQ/queryengine.h>
+#include <QGSQ/Valve/Source/serverquery.h>
+#include <QGSQ/Valve/Source/serverinfo.h>
+#include <QGSQ/Valve/Source/player.h>
+#include <QGSQ/Valve/Source/jsonwriter.h>
+#include <QGSQ/Valve/Source/cborwriter.h>
+#include <QGSQ/Valve/Source/msgpackwriter.h>
+#include <QGSQ/Valve/Source/snapshotwriter.h>
+
+using namespace QGSQ::Valve::Source;
+
+Scanner::Scanner(const Options &options, QIODevice *input, QIODevice *output, QObject *parent) :
+    QObject(parent), m_options(options), m_input(input), m_output(output)
+{
+    if (m_options.inFlight < 1) {
+        m_options.inFlight = 1;
+    }
+
+    // all queries of the scan share the sockets and the timeout timer of one engine
+    m_engine = new QGSQ::QueryEngine(this);
+    m_engine->setTimeout(m_options.timeout);
+    m_engine->setMetrics(&m_metrics);
+    m_engine->setCapture(m_options.capture);
+    m_engine->setReplay(m_options.replay);
+}
+
+Scanner::~Scanner()
+{
+    // children are deleted after the members, but the queries and the engine use the metrics and the string pool
+    qDeleteAll(findChildren<ServerQuery*>(QString(), Qt::FindDirectChildrenOnly));
+    delete m_engine;
+}
+
+bool Scanner::start()
+{
+    switch (m_options.format) {
+    case NDJson:
+        m_json.reset(new JsonWriter(m_output, JsonWriter::NDJson));
+        break;
+    case Cbor:
+        m_cbor.reset(new CborWriter(m_output));
+        break;
+    case MsgPack:
+        m_msgPack.reset(new MsgPackWriter(m_output));
+        break;
+    case Snapshot:
+        m_snapshot.reset(new SnapshotWriter);
+        if (!m_snapshot->open(m_output)) {
+            std::cerr << "Failed to open snapshot: " << qPrintable(m_snapshot->errorString()) << std::endl;
+            return false;
+        }
+        break;
+    }
+
+    if (m_options.rate > 0) {
+        m_rateTimer = new QTimer(this);
+        m_rateTimer->setInterval(10);
+        connect(m_rateTimer, &QTimer::timeout, this, &Scanner::fillPipeline);
+        m_rateTimer->start();
+    }
+
+    m_clock.start();
+    // start from the event loop, so that finished() can be connected before it is emitted
+    QTimer::singleShot(0, this, &Scanner::fillPipeline);
+
+    return true;
+}
+
+void Scanner::fillPipeline()
+{
+    while (!m_inputDone && (m_active < m_options.inFlight)) {
+        if (m_options.rate > 0) {
+            const qint64 allowed = static_cast<qint64>(m_options.rate) * m_clock.elapsed() / 1000 + 1;
+            if (m_started >= allowed) {
+                break;
+            }
+        }
+
+        QString address;
+        quint16 port = 0;
+        if (!nextEndpoint(address, port)) {
+            m_inputDone = true;
+            break;
+        }
+
+        startJob(address, port);
+    }
+
+    if (m_inputDone && (m_active == 0)) {
+        finishScan();
+    }
+}
+
+bool Scanner::nextEndpoint(QString &address, quint16 &port)
+{
+    QString line;
+    while (m_input.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        port = m_options.defaultPort;
+        if (line.startsWith(QLatin1Char('['))) {
+            const int end = line.indexOf(QLatin1Char(']'));
+            if (end < 0) {
+                ++m_skipped;
+                continue;
+            }
+            address = line.mid(1, end - 1);
+            if (line.size() > end + 2 && line.at(end + 1) == QLatin1Char(':')) {
+                port = line.midRef(end + 2).toUShort();
+            }
+        } else if (line.count(QLatin1Char(':')) == 1) {
+            const int sep = line.indexOf(QLatin1Char(':'));
+            address = line.left(sep);
+            port = line.midRef(sep + 1).toUShort();
+        } else {
+            address = line;
+        }
+
+        if (port == 0 || QHostAddress(address).isNull()) {
+            std::cerr << "Skipping invalid endpoint: " << qPrintable(line) << std::endl;
+            ++m_skipped;
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void Scanner::startJob(const QString &address, quint16 port)
+{
+    auto job = new Job;
+    job->query = new ServerQuery(address, port, this);
+    job->query->setEngine(m_engine);
+    job->query->setTimeout(m_options.timeout);
+    // filtered replies are counted by the ServerQuery
+    job->query->setMetrics(&m_metrics);
+    job->query->setStringPool(&m_stringPool);
+    job->query->setInfoFilter(m_options.filter);
+
+    connect(job->query, &ServerQuery::gotInfo, this, [job](ServerInfo *si){
+        job->info = si;
+    });
+    connect(job->query, &ServerQuery::gotRules, this, [job](const QHash<QString,QString> &rules){
+        job->rules = rules;
+    });
+    connect(job->query, &ServerQuery::gotPlayers, this, [job](const QList<Player*> &players){
+        job->players = players;
+    });
+    connect(job->query, &ServerQuery::requestFinished, this, [this, job](){
+        if (--job->pending == 0) {
+            finishJob(job);
+        }
+    });
+
+    ++m_started;
+    ++m_active;
+
+    // the queries of one server run concurrently
+    job->pending = 1 + (m_options.rules ? 1 : 0) + (m_options.players ? 1 : 0);
+    job->query->getInfoAsync();
+    if (m_options.rules) {
+        job->query->getRulesAsync();
+    }
+    if (m_options.players) {
+        job->query->getPlayersAsync();
+    }
+}
+
+void Scanner::finishJob(Job *job)
+{
+    --m_active;
+
+    if (job->info) {
+        ++m_succeeded;
+        writeResult(job);
+    } else {
+        ++m_failed;
+    }
+
+    delete job->info;
+    qDeleteAll(job->players);
+    job->query->deleteLater();
+    delete job;
+
+    fillPipeline();
+}
+
+void Scanner::writeResult(const Job *job)
+{
+    const bool full = m_options.rules || m_options.players;
+
+    switch (m_options.format) {
+    case NDJson:
+        if (full) {
+            m_json->writeServer(job->info, job->rules, job->players);
+        } else {
+            m_json->writeServerInfo(job->info);
+        }
+        break;
+    case Cbor:
+        if (full) {
+            m_cbor->writeServer(job->info, job->rules, job->players);
+        } else {
+            m_cbor->writeServerInfo(job->info);
+        }
+        break;
+    case MsgPack:
+        if (full) {
+            m_msgPack->writeServer(job->info, job->rules, job->players);
+        } else {
+            m_msgPack->writeServerInfo(job->info);
+        }
+        break;
+    case Snapshot:
+        m_snapshot->addServer(job->info, job->rules, job->players);
+        break;
+    }
+}
+
+void Scanner::finishScan()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    if (m_rateTimer) {
+        m_rateTimer->stop();
+    }
+
+    if (m_json) {
+        m_json->flush();
+    } else if (m_cbor) {
+        m_cbor->flush();
+    } else if (m_msgPack) {
+        m_msgPack->flush();
+    } else if (m_snapshot) {
+        if (!m_snapshot->finish()) {
+            std::cerr << "Failed to finish snapshot: " << qPrintable(m_snapshot->errorString()) << std::endl;
+        }
+    }
+
+    Q_EMIT finished();
+}
+
+void Scanner::printSummary() const
+{
+    const double seconds = static_cast<double>(m_clock.nsecsElapsed()) / 1e9;
+    const double rate = (seconds > 0.0) ? static_cast<double>(m_started) / seconds : 0.0;
+    // servers dropped by the info filter answered, they are neither counted as failed nor lower the success rate
+    const auto filtered = static_cast<qint64>(m_metrics.counter(QGSQ::QueryMetrics::FilteredReplies));
+    const qint64 unfiltered = m_started - filtered;
+    const double successRate = (unfiltered > 0) ? 100.0 * static_cast<double>(m_succeeded) / static_cast<double>(unfiltered) : 0.0;
+
+    std::fprintf(stderr, "Scanned %lli servers in %.2fs (%.1f servers/s)\n", static_cast<long long>(m_started), seconds, rate);
+    std::fprintf(stderr, "Succeeded: %lli, failed: %lli, filtered: %lli, skipped: %lli, success rate: %.1f%%\n",
+                 static_cast<long long>(m_succeeded), static_cast<long long>(m_failed - filtered), static_cast<long long>(filtered), static_cast<long long>(m_skipped), successRate);
+    std::fprintf(stderr, "Info latency: p50 %.1fms, p90 %.1fms, p99 %.1fms, max %.1fms\n",
+                 static_cast<double>(m_metrics.latencyPercentile(QGSQ::QueryMetrics::Info, 50.0)) / 1000.0,
+                 static_cast<double>(m_metrics.latencyPercentile(QGSQ::QueryMetrics::Info, 90.0)) / 1000.0,
+                 static_cast<double>(m_metrics.latencyPercentile(QGSQ::QueryMetrics::Info, 99.0)) / 1000.0,
+                 static_cast<double>(m_metrics.latencyPercentile(QGSQ::QueryMetrics::Info, 100.0)) / 1000.0);
+    std::fprintf(stderr, "Packets sent: %llu, received: %llu, timeouts: %llu, invalid replies: %llu\n",
+                 static_cast<unsigned long long>(m_metrics.counter(QGSQ::QueryMetrics::PacketsSent)),
+                 static_cast<unsigned long long>(m_metrics.counter(QGSQ::QueryMetrics::PacketsReceived)),
+                 static_cast<unsigned long long>(m_metrics.counter(QGSQ::QueryMetrics::Timeouts)),
+                 static_cast<unsigned long long>(m_metrics.counter(QGSQ::QueryMetrics::InvalidReplies)));
+}
@@ -0,0 +1,134 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QGSQTESTAPP_SCANNER_H
+#define QGSQTESTAPP_SCANNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QScopedPointer>
+
+#include <QGSQ/querymetrics.h>
+#include <QGSQ/Valve/Source/stringpool.h>
+
+class QIODevice;
+class QTimer;
+
+namespace QGSQ {
+class QueryEngine;
+class PacketCapture;
+class PacketReplay;
+namespace Valve {
+namespace Source {
+class ServerQuery;
+class ServerInfo;
+class Player;
+class JsonWriter;
+class CborWriter;
+class MsgPackWriter;
+class SnapshotWriter;
+class InfoFilter;
+}
+}
+}
+
+/*
+ * Bulk scanner reading one endpoint per line (address, address:port or
+ * [ipv6]:port) and querying them concurrently. Results are streamed to the
+ * output device while the scan is running, a summary is printed to stderr
+ * at the end.
+ */
+class Scanner : public QObject
+{
+    Q_OBJECT
+public:
+    enum Format : quint8 {
+        NDJson      = 0,
+        Cbor        = 1,
+        MsgPack     = 2,
+        Snapshot    = 3
+    };
+
+    struct Options {
+        Format format = NDJson;
+        int inFlight = 256;
+        int rate = 0;
+        int timeout = 2000;
+        quint16 defaultPort = 27015;
+        bool rules = false;
+        bool players = false;
+        QGSQ::PacketCapture *capture = nullptr;
+        QGSQ::PacketReplay *replay = nullptr;
+        QGSQ::Valve::Source::InfoFilter *filter = nullptr;
+    };
+
+    Scanner(const Options &options, QIODevice *input, QIODevice *output, QObject *parent = nullptr);
+
+    ~Scanner();
+
+    bool start();
+
+    void printSummary() const;
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    struct Job {
+        QGSQ::Valve::Source::ServerQuery *query = nullptr;
+        QGSQ::Valve::Source::ServerInfo *info = nullptr;
+        QHash<QString,QString> rules;
+        QList<QGSQ::Valve::Source::Player*> players;
+        int pending = 0;
+    };
+
+    void fillPipeline();
+    bool nextEndpoint(QString &address, quint16 &port);
+    void startJob(const QString &address, quint16 port);
+    void finishJob(Job *job);
+    void writeResult(const Job *job);
+    void finishScan();
+
+    // used by the engine and the queries, which the destructor deletes before them
+    QGSQ::QueryMetrics m_metrics;
+    QGSQ::Valve::Source::StringPool m_stringPool;
+    Options m_options;
+    QTextStream m_input;
+    QIODevice *m_output = nullptr;
+    QTimer *m_rateTimer = nullptr;
+    QGSQ::QueryEngine *m_engine = nullptr;
+    QScopedPointer<QGSQ::Valve::Source::JsonWriter> m_json;
+    QScopedPointer<QGSQ::Valve::Source::CborWriter> m_cbor;
+    QScopedPointer<QGSQ::Valve::Source::MsgPackWriter> m_msgPack;
+    QScopedPointer<QGSQ::Valve::Source::SnapshotWriter> m_snapshot;
+    QElapsedTimer m_clock;
+    qint64 m_started = 0;
+    qint64 m_succeeded = 0;
+    qint64 m_failed = 0;
+    qint64 m_skipped = 0;
+    int m_active = 0;
+    bool m_inputDone = false;
+    bool m_finished = false;
+};
+
+#endif // QGSQTESTAPP_SCANNER_H
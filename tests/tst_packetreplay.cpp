@@ -0,0 +1,142 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+#include <QBuffer>
+#include <QHash>
+
+#include <QGSQ/queryengine.h>
+#include <QGSQ/packetcapture.h>
+#include <QGSQ/packetreplay.h>
+#include <QGSQ/Valve/Source/a2sprotocol.h>
+
+#include "fakeserver.h"
+
+using namespace QGSQ::Valve::Source;
+
+class TestPacketReplay : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void concurrentRequests();
+    void serverFallback();
+
+private:
+    // starts info, rules and players requests at once and waits for all of them, failed ones are empty
+    static QHash<int,QByteArray> queryAll(QGSQ::QueryEngine *engine, quint16 port);
+
+    QBuffer m_buffer;
+    QHash<int,QByteArray> m_recorded;
+    quint16 m_port = 0;
+};
+
+QHash<int,QByteArray> TestPacketReplay::queryAll(QGSQ::QueryEngine *engine, quint16 port)
+{
+    QHash<int,QByteArray> replies;
+    int finished = 0;
+    for (int type : {A2SProtocol::Info, A2SProtocol::Rules, A2SProtocol::Players}) {
+        engine->query(A2SProtocol::instance(), QHostAddress(QHostAddress::LocalHost), port, type, 500, [&replies, &finished, type](quint32, const QByteArray &payload) {
+            replies.insert(type, payload);
+            ++finished;
+        });
+    }
+    for (int i = 0; (i < 200) && (finished < 3); ++i) {
+        QTest::qWait(10);
+    }
+    return replies;
+}
+
+void TestPacketReplay::initTestCase()
+{
+    // rules are sent as split reply, the challenges are bound to the client port
+    FakeServer::Config config;
+    config.basePort = 27815;
+    config.rules = 40;
+    config.players = 3;
+    config.maxPacketSize = 400;
+    FakeServer server(config);
+    QVERIFY(server.start());
+    m_port = server.port(0);
+
+    QVERIFY(m_buffer.open(QIODevice::ReadWrite));
+    QGSQ::PacketCapture capture;
+    QVERIFY(capture.open(&m_buffer));
+
+    QGSQ::QueryEngine engine;
+    engine.setCapture(&capture);
+    m_recorded = queryAll(&engine, m_port);
+    capture.close();
+
+    QCOMPARE(m_recorded.size(), 3);
+    for (const QByteArray &payload : m_recorded) {
+        QVERIFY(!payload.isEmpty());
+    }
+}
+
+void TestPacketReplay::concurrentRequests()
+{
+    m_buffer.seek(0);
+    QGSQ::PacketReplay replay;
+    QVERIFY(replay.load(&m_buffer));
+    replay.setSpeed(0.0);
+    // all requests share the socket of the server
+    QCOMPARE(replay.conversationCount(), 1);
+
+    QGSQ::QueryEngine engine;
+    engine.setReplay(&replay);
+    const QHash<int,QByteArray> replayed = queryAll(&engine, m_port);
+    QCOMPARE(replayed, m_recorded);
+
+    // every recorded request is only answered once
+    const QHash<int,QByteArray> again = queryAll(&engine, m_port);
+    QCOMPARE(again.size(), 3);
+    for (const QByteArray &payload : again) {
+        QVERIFY(payload.isEmpty());
+    }
+
+    replay.rewind();
+    QCOMPARE(queryAll(&engine, m_port), m_recorded);
+}
+
+void TestPacketReplay::serverFallback()
+{
+    m_buffer.seek(0);
+    QGSQ::PacketReplay replay;
+    QVERIFY(replay.load(&m_buffer));
+    replay.setSpeed(0.0);
+
+    QGSQ::QueryEngine engine;
+    engine.setReplay(&replay);
+    const quint16 otherPort = m_port + 1;
+
+    QVERIFY(!replay.serverFallback());
+    const QHash<int,QByteArray> unanswered = queryAll(&engine, otherPort);
+    QCOMPARE(unanswered.size(), 3);
+    for (const QByteArray &payload : unanswered) {
+        QVERIFY(payload.isEmpty());
+    }
+
+    replay.setServerFallback(true);
+    QCOMPARE(queryAll(&engine, otherPort), m_recorded);
+}
+
+QTEST_GUILESS_MAIN(TestPacketReplay)
+
+#include "tst_packetreplay.moc"
@@ -0,0 +1,87 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+
+#include <QGSQ/querymetrics.h>
+
+using QGSQ::QueryMetrics;
+
+class TestQueryMetrics : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void bucketBounds_data();
+    void bucketBounds();
+
+private:
+    // value of the histogram bucket with the given le label, -1 if it is missing
+    static qint64 bucketValue(const QByteArray &exposition, const QByteArray &le);
+};
+
+void TestQueryMetrics::bucketBounds_data()
+{
+    QTest::addColumn<qint64>("usecs");
+    QTest::addColumn<QByteArray>("le");
+    QTest::addColumn<QByteArray>("below");
+
+    QTest::newRow("16us") << Q_INT64_C(16) << QByteArrayLiteral("1.6e-05") << QByteArray();
+    QTest::newRow("1024us") << Q_INT64_C(1024) << QByteArrayLiteral("0.001024") << QByteArrayLiteral("0.000512");
+    QTest::newRow("65536us") << Q_INT64_C(65536) << QByteArrayLiteral("0.065536") << QByteArrayLiteral("0.032768");
+}
+
+void TestQueryMetrics::bucketBounds()
+{
+    QFETCH(qint64, usecs);
+    QFETCH(QByteArray, le);
+    QFETCH(QByteArray, below);
+
+    QueryMetrics metrics;
+    metrics.recordLatency(QueryMetrics::Info, usecs);
+    // a value exactly on a bound is counted in its le bucket
+    QByteArray exposition = metrics.toPrometheus();
+    QCOMPARE(bucketValue(exposition, le), Q_INT64_C(1));
+    if (!below.isEmpty()) {
+        QCOMPARE(bucketValue(exposition, below), Q_INT64_C(0));
+    }
+    QCOMPARE(metrics.latencyPercentile(QueryMetrics::Info, 100.0), usecs);
+
+    // one more microsecond is not
+    metrics.reset();
+    metrics.recordLatency(QueryMetrics::Info, usecs + 1);
+    exposition = metrics.toPrometheus();
+    QCOMPARE(bucketValue(exposition, le), Q_INT64_C(0));
+    QCOMPARE(bucketValue(exposition, QByteArrayLiteral("+Inf")), Q_INT64_C(1));
+}
+
+qint64 TestQueryMetrics::bucketValue(const QByteArray &exposition, const QByteArray &le)
+{
+    const QByteArray prefix = QByteArrayLiteral("qgsq_query_duration_seconds_bucket{type=\"info\",le=\"") + le + QByteArrayLiteral("\"} ");
+    const QList<QByteArray> lines = exposition.split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith(prefix)) {
+            return line.mid(prefix.size()).toLongLong();
+        }
+    }
+    return -1;
+}
+
+QTEST_GUILESS_MAIN(TestQueryMetrics)
+
+#include "tst_querymetrics.moc"
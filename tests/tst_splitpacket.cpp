@@ -0,0 +1,97 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+
+#include <QGSQ/queryengine.h>
+#include <QGSQ/Valve/Source/a2sprotocol.h>
+// internal API of the static qgsq_internal library
+#include <QGSQ/Valve/Source/splitpacket_p.h>
+
+#include "fakeserver.h"
+
+using namespace QGSQ::Valve::Source;
+
+class TestSplitPacket : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void checksum();
+    void query_data();
+    void query();
+};
+
+void TestSplitPacket::checksum()
+{
+    QCOMPARE(SplitPacketAssembler::crc32(QByteArrayLiteral("123456789")), 0xcbf43926U);
+    QCOMPARE(SplitPacketAssembler::crc32(QByteArray()), 0U);
+}
+
+void TestSplitPacket::query_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<bool>("compressed");
+    QTest::addColumn<bool>("reorder");
+
+    QTest::newRow("rules") << static_cast<int>(A2SProtocol::Rules) << false << false;
+    QTest::newRow("rules reordered") << static_cast<int>(A2SProtocol::Rules) << false << true;
+    QTest::newRow("compressed rules") << static_cast<int>(A2SProtocol::Rules) << true << false;
+    QTest::newRow("compressed rules reordered") << static_cast<int>(A2SProtocol::Rules) << true << true;
+    QTest::newRow("compressed players") << static_cast<int>(A2SProtocol::Players) << true << false;
+}
+
+void TestSplitPacket::query()
+{
+    QFETCH(int, type);
+    QFETCH(bool, compressed);
+    QFETCH(bool, reorder);
+
+#ifndef QGSQ_WITH_BZIP2
+    if (compressed) {
+        QSKIP("Built without bzip2 support.");
+    }
+#endif
+
+    // even the compressed responses need more than one packet
+    FakeServer::Config config;
+    config.basePort = 27915;
+    config.rules = 400;
+    config.players = 60;
+    config.maxPacketSize = 200;
+    config.compressSplit = compressed;
+    config.reorder = reorder;
+    config.seed = 1;
+    FakeServer server(config);
+    QVERIFY(server.start());
+
+    QByteArray reply;
+    bool finished = false;
+    QGSQ::QueryEngine engine;
+    engine.query(A2SProtocol::instance(), QHostAddress(QHostAddress::LocalHost), server.port(0), type, 2000, [&reply, &finished](quint32, const QByteArray &payload) {
+        reply = payload;
+        finished = true;
+    });
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 5000);
+
+    QCOMPARE(reply, (type == A2SProtocol::Rules) ? FakeServer::rulesPayload(0, config.rules) : FakeServer::playersPayload(0, config.players));
+}
+
+QTEST_GUILESS_MAIN(TestSplitPacket)
+
+#include "tst_splitpacket.moc"
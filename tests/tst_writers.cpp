@@ -0,0 +1,146 @@
+/* libqgsq - Qt based library to query game servers
+ * Copyright (C) 2018 Huessenbergnetz / Matthias Fehring
+ * https://github.com/Huessenbergnetz/libqgsq
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtEndian>
+
+#include <QGSQ/Valve/Source/serverinfo.h>
+#include <QGSQ/Valve/Source/player.h>
+#include <QGSQ/Valve/Source/jsonwriter.h>
+#include <QGSQ/Valve/Source/cborwriter.h>
+#include <QGSQ/Valve/Source/msgpackwriter.h>
+// internal API of the static qgsq_internal library
+#include <QGSQ/Valve/Source/serverquery_p.h>
+
+#include "fakeserver.h"
+
+using namespace QGSQ::Valve::Source;
+
+class TestWriters : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void serverKeys();
+    void serverMapSizes();
+
+private:
+    // size of a map at the start of the data, -1 if there is none
+    static int cborMapSize(const QByteArray &data);
+    static int msgPackMapSize(const QByteArray &data);
+
+    ServerInfo *m_info = nullptr;
+    QHash<QString,QString> m_rules;
+    QList<Player*> m_players;
+};
+
+void TestWriters::initTestCase()
+{
+    m_info = ServerInfo::fromRawData(FakeServer::infoPayload(0, 27015, 3), QStringLiteral("127.0.0.1"), 27015);
+    QVERIFY(m_info);
+    m_rules = ServerQueryPrivate::extractRules(FakeServer::rulesPayload(0, 2));
+    QCOMPARE(m_rules.size(), 2);
+    m_players = ServerQueryPrivate::extractPlayers(FakeServer::playersPayload(0, 3));
+    QCOMPARE(m_players.size(), 3);
+}
+
+void TestWriters::cleanupTestCase()
+{
+    delete m_info;
+    qDeleteAll(m_players);
+}
+
+void TestWriters::serverKeys()
+{
+    QByteArray json;
+    {
+        JsonWriter writer(&json);
+        writer.writeServer(m_info, m_rules, m_players);
+        QVERIFY(writer.flush());
+    }
+
+    // decoders keep only one value of a duplicated key, so every key has to be unique
+    QCOMPARE(json.count("\"players\":"), 1);
+
+    QJsonParseError error;
+    const QJsonObject server = QJsonDocument::fromJson(json, &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(server.value(QStringLiteral("players")).toInt(), 3);
+    QCOMPARE(server.value(QStringLiteral("playerList")).toArray().size(), 3);
+    QCOMPARE(server.value(QStringLiteral("rules")).toObject().size(), 2);
+}
+
+void TestWriters::serverMapSizes()
+{
+    QByteArray json;
+    QByteArray cbor;
+    QByteArray msgPack;
+    {
+        JsonWriter jsonWriter(&json);
+        jsonWriter.writeServer(m_info, m_rules, m_players);
+        CborWriter cborWriter(&cbor);
+        cborWriter.writeServer(m_info, m_rules, m_players);
+        MsgPackWriter msgPackWriter(&msgPack);
+        msgPackWriter.writeServer(m_info, m_rules, m_players);
+    }
+
+    // the length prefixed formats announce every key of the JSON object
+    const int keys = QJsonDocument::fromJson(json).object().size();
+    QVERIFY(keys > 2);
+    QCOMPARE(cborMapSize(cbor), keys);
+    QCOMPARE(msgPackMapSize(msgPack), keys);
+}
+
+int TestWriters::cborMapSize(const QByteArray &data)
+{
+    if (data.isEmpty() || ((static_cast<quint8>(data.at(0)) & 0xe0) != 0xa0)) {
+        return -1;
+    }
+    const quint8 info = static_cast<quint8>(data.at(0)) & 0x1f;
+    if (info < 24) {
+        return info;
+    } else if ((info == 24) && (data.size() > 1)) {
+        return static_cast<quint8>(data.at(1));
+    } else if ((info == 25) && (data.size() > 2)) {
+        return qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(data.constData() + 1));
+    }
+    return -1;
+}
+
+int TestWriters::msgPackMapSize(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return -1;
+    }
+    const quint8 type = static_cast<quint8>(data.at(0));
+    if ((type & 0xf0) == 0x80) {
+        return type & 0x0f;
+    } else if ((type == 0xde) && (data.size() > 2)) {
+        return qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(data.constData() + 1));
+    }
+    return -1;
+}
+
+QTEST_GUILESS_MAIN(TestWriters)
+
+#include "tst_writers.moc"